@@ -0,0 +1,215 @@
+#include "ArcMeter.h"
+#include <algorithm>
+
+// sin() of 0 to 90 degrees in quarter degree steps, scaled by 16384
+static const int16_t arcSinTable[361] = {
+      0,    71,   143,   214,   286,   357,   429,   500,   572,   643,   715,   786,
+    857,   929,  1000,  1072,  1143,  1214,  1285,  1357,  1428,  1499,  1570,  1641,
+   1713,  1784,  1855,  1926,  1997,  2068,  2139,  2209,  2280,  2351,  2422,  2492,
+   2563,  2634,  2704,  2775,  2845,  2915,  2986,  3056,  3126,  3196,  3266,  3336,
+   3406,  3476,  3546,  3616,  3686,  3755,  3825,  3894,  3964,  4033,  4102,  4171,
+   4240,  4310,  4378,  4447,  4516,  4585,  4653,  4722,  4790,  4859,  4927,  4995,
+   5063,  5131,  5199,  5266,  5334,  5402,  5469,  5536,  5604,  5671,  5738,  5805,
+   5872,  5938,  6005,  6071,  6138,  6204,  6270,  6336,  6402,  6467,  6533,  6599,
+   6664,  6729,  6794,  6859,  6924,  6989,  7053,  7118,  7182,  7246,  7311,  7374,
+   7438,  7502,  7565,  7629,  7692,  7755,  7818,  7881,  7943,  8006,  8068,  8130,
+   8192,  8254,  8316,  8377,  8438,  8500,  8561,  8621,  8682,  8743,  8803,  8863,
+   8923,  8983,  9043,  9102,  9162,  9221,  9280,  9339,  9397,  9456,  9514,  9572,
+   9630,  9688,  9746,  9803,  9860,  9917,  9974, 10031, 10087, 10143, 10199, 10255,
+  10311, 10366, 10422, 10477, 10531, 10586, 10641, 10695, 10749, 10803, 10856, 10910,
+  10963, 11016, 11069, 11121, 11174, 11226, 11278, 11330, 11381, 11433, 11484, 11535,
+  11585, 11636, 11686, 11736, 11786, 11835, 11885, 11934, 11982, 12031, 12080, 12128,
+  12176, 12223, 12271, 12318, 12365, 12412, 12458, 12505, 12551, 12597, 12642, 12688,
+  12733, 12778, 12822, 12867, 12911, 12955, 12998, 13042, 13085, 13128, 13170, 13213,
+  13255, 13297, 13338, 13380, 13421, 13462, 13502, 13543, 13583, 13623, 13662, 13702,
+  13741, 13780, 13818, 13856, 13894, 13932, 13970, 14007, 14044, 14081, 14117, 14153,
+  14189, 14225, 14260, 14295, 14330, 14364, 14399, 14433, 14466, 14500, 14533, 14566,
+  14598, 14631, 14663, 14694, 14726, 14757, 14788, 14819, 14849, 14879, 14909, 14938,
+  14968, 14996, 15025, 15053, 15082, 15109, 15137, 15164, 15191, 15218, 15244, 15270,
+  15296, 15321, 15346, 15371, 15396, 15420, 15444, 15468, 15491, 15515, 15537, 15560,
+  15582, 15604, 15626, 15647, 15668, 15689, 15709, 15729, 15749, 15769, 15788, 15807,
+  15826, 15844, 15862, 15880, 15897, 15914, 15931, 15948, 15964, 15980, 15996, 16011,
+  16026, 16041, 16055, 16069, 16083, 16096, 16110, 16123, 16135, 16147, 16159, 16171,
+  16182, 16193, 16204, 16214, 16225, 16234, 16244, 16253, 16262, 16270, 16279, 16287,
+  16294, 16302, 16309, 16315, 16322, 16328, 16333, 16339, 16344, 16349, 16353, 16358,
+  16362, 16365, 16368, 16371, 16374, 16376, 16378, 16380, 16382, 16383, 16383, 16384,
+  16384,
+};
+
+// sin() of an angle in quarter degrees, scaled by 16384
+static int32_t arcSin(int32_t a) {
+  a %= 1440;
+  if (a < 0) a += 1440;
+  if (a <= 360)  return  arcSinTable[a];
+  if (a <= 720)  return  arcSinTable[720 - a];
+  if (a <= 1080) return -arcSinTable[a - 720];
+  return -arcSinTable[1440 - a];
+}
+
+// Integer square root, rounded down
+static uint32_t arcSqrt(uint32_t v) {
+  uint32_t r = 0, bit = 1ul << 30;
+  while (bit > v) bit >>= 2;
+  while (bit) {
+    if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+    else r >>= 1;
+    bit >>= 2;
+  }
+  return r;
+}
+
+// Division rounded towards minus infinity
+static int32_t arcFloorDiv(int32_t a, int32_t b) {
+  int32_t q = a / b;
+  if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+  return q;
+}
+
+TFT_eArcMeter::TFT_eArcMeter(TFT_eSPI *tft) {
+  _tft    = tft;
+  _x      = 0;
+  _y      = 0;
+  _r      = 0;
+  _ir     = 0;
+  _start  = 0;
+  _end    = 0;
+  _fg     = TFT_WHITE;
+  _bg     = TFT_BLACK;
+  _min    = 0;
+  _max    = 100;
+  _angle  = 0;
+  _drawn  = false;
+  _pixels = 0;
+}
+
+// Set the geometry and build the span tables
+bool TFT_eArcMeter::begin(int32_t x, int32_t y, uint16_t r, uint16_t ir, uint16_t startAngle, uint16_t endAngle,
+                          uint16_t fgColor, uint16_t bgColor) {
+  if ((r > TFT_ARC_MAX_RADIUS) || (ir > r)) return false;
+
+  _x  = x;
+  _y  = y;
+  _r  = r;
+  _ir = ir;
+  _fg = fgColor;
+  _bg = bgColor;
+
+  // Arcs run clockwise from start to end, an end at or before the start wraps past 6 o'clock
+  _start = (startAngle % 360) * 4;
+  _end   = (endAngle % 360) * 4;
+  if (_end <= _start) _end += 1440;
+
+  // A pixel centre dx, dy from the centre is in the ring if ir^2 <= dx^2 + dy^2 <= r^2
+  for (int32_t dy = 0; dy <= r; dy++) {
+    _outer[dy] = arcSqrt(r * r - dy * dy);
+    int32_t hole = (int32_t)ir * ir - dy * dy;
+    _inner[dy] = (hole > 0) ? arcSqrt(hole - 1) : -1;
+  }
+
+  _angle = _start;
+  _drawn = false;
+  return true;
+}
+
+// Set the value range
+void TFT_eArcMeter::setRange(int32_t minValue, int32_t maxValue) {
+  if (maxValue == minValue) return;
+  _min = minValue;
+  _max = maxValue;
+}
+
+// Map a value to an angle in quarter degrees, clamped to the arc
+uint16_t TFT_eArcMeter::toAngle(int32_t value) {
+  if (_min < _max) value = std::min(std::max(value, _min), _max);
+  else             value = std::min(std::max(value, _max), _min);
+
+  return _start + (int64_t)(value - _min) * (_end - _start) / (_max - _min);
+}
+
+// Draw the whole arc
+void TFT_eArcMeter::draw(int32_t value) {
+  _pixels = 0;
+  _angle  = toAngle(value);
+  _drawn  = true;
+
+  _tft->startWrite();
+  fillSector(_start, _angle, _fg);
+  fillSector(_angle, _end, _bg);
+  _tft->endWrite();
+}
+
+// Draw only the change from the last value
+void TFT_eArcMeter::update(int32_t value) {
+  if (!_drawn) { draw(value); return; }
+
+  _pixels = 0;
+  uint16_t angle = toAngle(value);
+
+  _tft->startWrite();
+  if (angle > _angle) fillSector(_angle, angle, _fg);
+  else                fillSector(angle, _angle, _bg);
+  _tft->endWrite();
+
+  _angle = angle;
+}
+
+// Fill the ring between two angles, split into pieces of at most 90 degrees so each is convex
+void TFT_eArcMeter::fillSector(uint16_t a0, uint16_t a1, uint16_t color) {
+  while (a0 < a1) {
+    uint16_t a = std::min<uint16_t>(a1, a0 + 360);
+    fillPiece(a0, a, color);
+    a0 = a;
+  }
+}
+
+// Fill the ring from angle a0 up to but not including a1, no more than 90 degrees apart
+// The direction of angle a is (-sin a, cos a) on screen, a pixel p is in the piece if it is on or
+// clockwise of d0, cross(d0, p) >= 0, and anticlockwise of d1, cross(p, d1) > 0. Both are linear
+// in x for a row so each row of the piece is one interval, which is clipped to the ring's spans
+// The centre lies on both lines so fails the second test. Without a hole it goes with the piece that
+// starts the arc, so a full draw covers it once and it keeps the color of the start of the arc
+void TFT_eArcMeter::fillPiece(uint16_t a0, uint16_t a1, uint16_t color) {
+  int32_t d0x = -arcSin(a0), d0y = arcSin(a0 + 360);
+  int32_t d1x = -arcSin(a1), d1y = arcSin(a1 + 360);
+
+  for (int32_t dy = -(int32_t)_r; dy <= (int32_t)_r; dy++) {
+    int32_t lo = -(int32_t)_r, hi = _r;
+    bool centre = (dy == 0) && (_ir == 0) && (a0 == _start);
+
+    // cross(d0, p) = d0x * dy - d0y * x >= 0
+    if (d0y > 0)      hi = std::min(hi, arcFloorDiv(d0x * dy, d0y));
+    else if (d0y < 0) lo = std::max(lo, -arcFloorDiv(-d0x * dy, d0y));
+    else if (d0x * dy < 0) continue;
+
+    // cross(p, d1) = x * d1y - dy * d1x > 0
+    if (d1y > 0)      lo = std::max(lo, arcFloorDiv(dy * d1x, d1y) + 1);
+    else if (d1y < 0) hi = std::min(hi, -arcFloorDiv(-dy * d1x, d1y) - 1);
+    else if (dy * d1x >= 0) {
+      if (!centre) continue;
+      lo = 1;
+      hi = 0;
+    }
+
+    // The row's interval ends next to the centre, so adding it keeps one interval
+    if (centre) {
+      if (lo > hi) lo = hi = 0;
+      else { lo = std::min(lo, 0); hi = std::max(hi, 0); }
+    }
+
+    if (lo > hi) continue;
+
+    // Clip to the ring, left and right of the hole
+    uint32_t ady = (dy < 0) ? -dy : dy;
+    int32_t xo = _outer[ady], xi = _inner[ady];
+    int32_t seg[2][2] = { { -xo, -xi - 1 }, { xi + 1, xo } };
+    if (xi < 0) { seg[0][1] = xo; seg[1][0] = 1; seg[1][1] = 0; }
+
+    for (uint8_t s = 0; s < 2; s++) {
+      int32_t x0 = std::max(lo, seg[s][0]);
+      int32_t x1 = std::min(hi, seg[s][1]);
+      if (x1 < x0) continue;
+      _tft->drawFastHLine(_x + x0, _y + dy, x1 - x0 + 1, color);
+      _pixels += x1 - x0 + 1;
+    }
+  }
+}
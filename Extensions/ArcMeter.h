@@ -0,0 +1,57 @@
+#ifndef _TFT_eSPI_ARC_METER_H_
+#define _TFT_eSPI_ARC_METER_H_
+
+#include <stdint.h>
+#include "TFT_eSPI.h"
+
+// Largest outer radius, sets the size of the cached span tables
+#ifndef TFT_ARC_MAX_RADIUS
+#define TFT_ARC_MAX_RADIUS 255
+#endif
+
+// Ring meter that only redraws the part of the arc between the old and new value
+// The ring's row spans are computed once by begin(), angles use a fixed-point sine table
+// Angles are in degrees clockwise from 6 o'clock, as drawArc() in the original library
+class TFT_eArcMeter
+{
+ public:
+  TFT_eArcMeter(TFT_eSPI *tft);
+
+  // Set the centre, outer and inner radius, the arc's start and end angle and the colors
+  // Returns false if the radius is larger than TFT_ARC_MAX_RADIUS
+  bool begin(int32_t x, int32_t y, uint16_t r, uint16_t ir, uint16_t startAngle, uint16_t endAngle,
+             uint16_t fgColor, uint16_t bgColor);
+
+  // Set the values shown at the start and end of the arc
+  void setRange(int32_t minValue, int32_t maxValue);
+
+  // Draw the whole arc for a value
+  void draw(int32_t value);
+
+  // Show a new value, only the arc between the old and new value is drawn
+  void update(int32_t value);
+
+  // Pixels sent by the last draw() or update()
+  uint32_t lastPixels(void) { return _pixels; }
+
+ private:
+  uint16_t toAngle(int32_t value);
+  void fillSector(uint16_t a0, uint16_t a1, uint16_t color);
+  void fillPiece(uint16_t a0, uint16_t a1, uint16_t color);
+
+  TFT_eSPI *_tft;
+  int32_t  _x, _y;
+  uint16_t _r, _ir;
+  uint16_t _start, _end;  // Quarter degrees, _end > _start
+  uint16_t _fg, _bg;
+  int32_t  _min, _max;
+  uint16_t _angle;        // Quarter degrees of the value shown
+  bool     _drawn;
+  uint32_t _pixels;
+
+  // Half width of the ring's outer edge on each row from the centre, and of the hole (-1 if none)
+  uint8_t  _outer[TFT_ARC_MAX_RADIUS + 1];
+  int16_t  _inner[TFT_ARC_MAX_RADIUS + 1];
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "Bus.h"
+#include <string.h>
+
+TFT_eSPI_Bus::TFT_eSPI_Bus(void) {
+  memset(_display, 0, sizeof(_display));
+  _count = 0;
+  _next  = 0;
+}
+
+// Register a display, displays sharing a bus must use the same SPI port and distinct CS pins
+int8_t TFT_eSPI_Bus::addDisplay(TFT_eSPI *tft) {
+  if (_count >= TFT_BUS_MAX_DISPLAYS) return -1;
+
+  _display[_count].tft = tft;
+  return _count++;
+}
+
+// Add a segment to the end of a display's queue
+bool TFT_eSPI_Bus::push(uint8_t id, const segment &s) {
+  if (id >= _count) return false;
+
+  display &d = _display[id];
+  if (d.count == TFT_BUS_QUEUE_DEPTH) {
+    d.stats.dropped++;
+    return false;
+  }
+
+  segment &e = d.ring[(d.head + d.count) % TFT_BUS_QUEUE_DEPTH];
+  e = s;
+  e.queued = time_us_64();
+  d.count++;
+  return true;
+}
+
+// Queue a segment drawn by a function
+bool TFT_eSPI_Bus::queue(uint8_t id, segment_fn fn, void *arg, uint32_t bytes) {
+  segment s = {};
+  s.fn    = fn;
+  s.arg   = arg;
+  s.bytes = bytes;
+  return push(id, s);
+}
+
+// Queue an image push
+bool TFT_eSPI_Bus::queuePushImage(uint8_t id, int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+  if ((w < 1) || (h < 1)) return true;
+
+  segment s = {};
+  s.data  = data;
+  s.x     = x;
+  s.y     = y;
+  s.w     = w;
+  s.h     = h;
+  s.row   = 0;
+  s.bytes = (uint32_t)w * h * 2;
+  return push(id, s);
+}
+
+// Run the head segment of a display, or the next slice of it for an image push
+void TFT_eSPI_Bus::runSlice(display &d) {
+  segment &s = d.ring[d.head];
+  uint64_t start = time_us_64();
+  bool done = true;
+
+  d.tft->startWrite();  // CS is held for the whole slice
+
+  if (s.fn) {
+    s.fn(*d.tft, s.arg);
+  }
+  else {
+    int32_t rows = TFT_BUS_SLICE_PIXELS / s.w;
+    if (rows < 1) rows = 1;
+    if (rows > s.h - s.row) rows = s.h - s.row;
+
+    d.tft->setWindow(s.x, s.y + s.row, s.x + s.w - 1, s.y + s.row + rows - 1);
+    d.tft->pushColors((uint16_t *)s.data + (uint32_t)s.row * s.w, (uint32_t)rows * s.w);
+
+    s.row += rows;
+    done = (s.row == s.h);
+  }
+
+  d.tft->endWrite();
+  d.tft->dmaWait();  // Leave the bus free for the next display
+
+  uint64_t end = time_us_64();
+  d.stats.slices++;
+  d.stats.busy_us += end - start;
+
+  if (done) {
+    uint32_t latency = end - s.queued;
+    d.stats.segments++;
+    d.stats.bytes += s.bytes;
+    d.stats.latency_us += latency;
+    if (latency > d.stats.latency_max_us) d.stats.latency_max_us = latency;
+
+    d.head = (d.head + 1) % TFT_BUS_QUEUE_DEPTH;
+    d.count--;
+  }
+}
+
+// Offer the bus to each display in turn, starting after the one served last
+bool TFT_eSPI_Bus::run(void) {
+  for (uint8_t i = 0; i < _count; i++) {
+    uint8_t id = (_next + i) % _count;
+    if (_display[id].count) {
+      runSlice(_display[id]);
+      _next = (id + 1) % _count;
+      break;
+    }
+  }
+
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_display[i].count) return true;
+  }
+  return false;
+}
+
+// Run until all queues are empty
+void TFT_eSPI_Bus::runAll(void) {
+  while (run()) {};
+}
+
+// Number of segments waiting for a display
+uint8_t TFT_eSPI_Bus::pending(uint8_t id) {
+  return (id < _count) ? _display[id].count : 0;
+}
+
+// Counters for a display
+const tft_bus_stats &TFT_eSPI_Bus::stats(uint8_t id) {
+  return _display[id < _count ? id : 0].stats;
+}
+
+// Bytes per second sent while the display held the bus
+uint32_t TFT_eSPI_Bus::throughput(uint8_t id) {
+  const tft_bus_stats &st = stats(id);
+  if (st.busy_us == 0) return 0;
+  return st.bytes * 1000000 / st.busy_us;
+}
+
+// Mean time from queueing to completion of a segment in microseconds
+uint32_t TFT_eSPI_Bus::latencyAvg(uint8_t id) {
+  const tft_bus_stats &st = stats(id);
+  if (st.segments == 0) return 0;
+  return st.latency_us / st.segments;
+}
+
+// Clear the counters for a display
+void TFT_eSPI_Bus::resetStats(uint8_t id) {
+  if (id < _count) memset(&_display[id].stats, 0, sizeof(tft_bus_stats));
+}
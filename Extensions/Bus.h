@@ -0,0 +1,91 @@
+#ifndef _TFT_eSPI_BUS_H_
+#define _TFT_eSPI_BUS_H_
+
+#include <stdint.h>
+#include "TFT_eSPI.h"
+
+// Number of displays that can share one bus
+#ifndef TFT_BUS_MAX_DISPLAYS
+#define TFT_BUS_MAX_DISPLAYS 4
+#endif
+
+// Number of segments each display can have waiting
+#ifndef TFT_BUS_QUEUE_DEPTH
+#define TFT_BUS_QUEUE_DEPTH 8
+#endif
+
+// Pixels an image push sends before the bus is offered to the next display
+#ifndef TFT_BUS_SLICE_PIXELS
+#define TFT_BUS_SLICE_PIXELS 4096
+#endif
+
+// Counters kept for each display on the bus
+struct tft_bus_stats {
+  uint32_t segments;       // Segments completed
+  uint32_t slices;         // Turns on the bus, an image push takes one per slice
+  uint64_t bytes;          // Bytes sent, as reported when the segment was queued
+  uint64_t busy_us;        // Time spent holding the bus
+  uint64_t latency_us;     // Total time from queueing to completion of each segment
+  uint32_t latency_max_us; // Longest time from queueing to completion
+  uint32_t dropped;        // Segments refused because the queue was full
+};
+
+class TFT_eSPI_Bus
+{
+ public:
+  // A frame segment, run with CS held and the display's write transaction open
+  typedef void (*segment_fn)(TFT_eSPI &tft, void *arg);
+
+  TFT_eSPI_Bus(void);
+
+  // Register a display, returns its id on this bus or -1 if all slots are in use
+  int8_t addDisplay(TFT_eSPI *tft);
+
+  // Queue a segment for a display, bytes is only used for the throughput counters
+  bool queue(uint8_t id, segment_fn fn, void *arg, uint32_t bytes = 0);
+
+  // Queue an image push, it is sent in slices of rows so other displays get the bus in between
+  // The data must stay valid until the segment completes
+  bool queuePushImage(uint8_t id, int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+
+  // Give the bus to the next display with queued work, returns true if work remains
+  bool run(void);
+
+  // Run until all queues are empty
+  void runAll(void);
+
+  // Number of segments waiting for a display, including one in progress
+  uint8_t pending(uint8_t id);
+
+  // Counters for a display, and derived throughput in bytes per second and mean latency
+  const tft_bus_stats &stats(uint8_t id);
+  uint32_t throughput(uint8_t id);
+  uint32_t latencyAvg(uint8_t id);
+  void resetStats(uint8_t id);
+
+ private:
+  struct segment {
+    segment_fn fn;          // nullptr for an image push
+    void *arg;
+    const uint16_t *data;   // Image push source and area, row is the next row to send
+    int16_t x, y, w, h, row;
+    uint32_t bytes;
+    uint64_t queued;
+  };
+
+  struct display {
+    TFT_eSPI *tft;
+    segment   ring[TFT_BUS_QUEUE_DEPTH];
+    uint8_t   head, count;
+    tft_bus_stats stats;
+  };
+
+  bool push(uint8_t id, const segment &s);
+  void runSlice(display &d);
+
+  display _display[TFT_BUS_MAX_DISPLAYS];
+  uint8_t _count;
+  uint8_t _next;  // Display offered the bus first on the next run()
+};
+
+#endif
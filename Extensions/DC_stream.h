@@ -0,0 +1,91 @@
+#ifndef _TFT_eSPI_DC_STREAM_H_
+#define _TFT_eSPI_DC_STREAM_H_
+
+// FIFO word format of the tft_dc_io PIO program (Processors/pio_SPI_dc.pio.h)
+// Only standard C++ is used here so streams can be built and checked on a host
+//
+// A stream is a sequence of segments, each a header word followed by its data words:
+//   header: bit 31 is the DC level for the segment, bits 30..0 are the number of bits to send - 1
+//   data:   two bytes per word in bits 31..24 and 23..16, the low half is ignored
+// A 16-bit DMA write to the FIFO is replicated into both halves of the word, so a buffer of
+// 565 pixels can follow its header directly, one pixel per word
+
+#include <stdint.h>
+
+// DC levels
+#define TFT_DC_COMMAND 0
+#define TFT_DC_DATA    1
+
+// Number of words tft_dc_window() writes
+#define TFT_DC_WINDOW_WORDS 13
+
+// Header for a segment of len bytes
+inline uint32_t tft_dc_header(uint8_t dc, uint32_t len) {
+  return (uint32_t)dc << 31 | ((len * 8 - 1) & 0x7FFFFFFF);
+}
+
+// Data word holding two bytes
+inline uint32_t tft_dc_data(uint8_t b0, uint8_t b1) {
+  return (uint32_t)b0 << 24 | (uint32_t)b1 << 16;
+}
+
+// Encode a command and its arguments, returns the number of words written (at most 3 + (n + 1) / 2)
+inline uint32_t tft_dc_command(uint32_t *out, uint8_t cmd, const uint8_t *args, uint32_t n) {
+  uint32_t *p = out;
+
+  *p++ = tft_dc_header(TFT_DC_COMMAND, 1);
+  *p++ = tft_dc_data(cmd, 0);
+
+  if (n) {
+    *p++ = tft_dc_header(TFT_DC_DATA, n);
+    for (uint32_t i = 0; i < n; i += 2) *p++ = tft_dc_data(args[i], (i + 1 < n) ? args[i + 1] : 0);
+  }
+  return p - out;
+}
+
+// Encode CASET, RASET and RAMWR for a window, then the header for len pixels which must follow
+// Writes TFT_DC_WINDOW_WORDS words
+inline uint32_t tft_dc_window(uint32_t *out, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint32_t len) {
+  uint8_t col[4] = { (uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)(x1 >> 8), (uint8_t)x1 };
+  uint8_t row[4] = { (uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)(y1 >> 8), (uint8_t)y1 };
+  uint32_t *p = out;
+
+  p += tft_dc_command(p, 0x2A, col, 4);  // Column addr set
+  p += tft_dc_command(p, 0x2B, row, 4);  // Row addr set
+  p += tft_dc_command(p, 0x2C, nullptr, 0);  // Write to RAM
+  *p++ = tft_dc_header(TFT_DC_DATA, len * 2);
+  return p - out;
+}
+
+// Word the FIFO receives for a pixel pushed by a 16-bit DMA write
+inline uint32_t tft_dc_pixel(uint16_t color) {
+  return (uint32_t)color << 16 | color;
+}
+
+// Decode a stream as the state machine would, calling emit(dc, byte) for each byte sent
+// Returns false if the stream ends part way through a segment
+template <class F> bool tft_dc_decode(const uint32_t *words, uint32_t n, F emit) {
+  const uint32_t *end = words + n;
+
+  while (words < end) {
+    uint32_t header = *words++;
+    uint8_t  dc     = header >> 31;
+    uint32_t bits   = (header & 0x7FFFFFFF) + 1;
+
+    uint8_t  byte = 0, nbits = 0;
+    while (bits) {
+      if (words == end) return false;
+      uint32_t w = *words++;
+      for (uint8_t i = 0; (i < 16) && bits; i++, bits--) {
+        byte = byte << 1 | (w >> (31 - i) & 1);
+        if (++nbits == 8) {
+          emit(dc, byte);
+          nbits = 0;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+#endif
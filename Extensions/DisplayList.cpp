@@ -0,0 +1,184 @@
+#include "DisplayList.h"
+#include <math.h>
+#include <algorithm>
+
+// Bytes of arguments after each opcode
+#define TFT_DL_RECT_BYTES  10
+#define TFT_DL_LINE_BYTES  8
+#define TFT_DL_WEDGE_BYTES 30
+#define TFT_DL_IMAGE_BYTES (12 + sizeof(uint16_t *))
+
+// Append an argument, copied as the bytecode is unaligned
+template <typename V> static void dlistPut(uint8_t *&p, V v) {
+  memcpy(p, &v, sizeof(V));
+  p += sizeof(V);
+}
+
+// Clamp a box edge to the range region rectangles hold
+static int16_t dlistClamp(int32_t v) {
+  return (int16_t)std::min<int32_t>(std::max<int32_t>(v, INT16_MIN), INT16_MAX);
+}
+
+// FNV-1a hash of an image, so a frame that redraws a changed buffer from the same address is seen to change
+static uint32_t dlistChecksum(const uint16_t *data, uint32_t len) {
+  uint32_t h = 2166136261u;
+  while (len--) {
+    h = (h ^ (*data & 0xFF)) * 16777619u;
+    h = (h ^ (*data++ >> 8)) * 16777619u;
+  }
+  return h;
+}
+
+// Add a rectangle to the damage, if the region would need too many rectangles it becomes their bounding box
+static void dlistDamage(TFT_eRegion &d, const tft_region_rect &b) {
+  if (d.unite(b.x0, b.y0, b.x1 - b.x0, b.y1 - b.y0)) return;
+
+  const tft_region_rect *r = d.rects();
+  int32_t x0 = b.x0, y0 = std::min(b.y0, r[0].y0), x1 = b.x1, y1 = std::max(b.y1, r[d.count() - 1].y1);
+  for (uint16_t i = 0; i < d.count(); i++) {
+    x0 = std::min<int32_t>(x0, r[i].x0);
+    x1 = std::max<int32_t>(x1, r[i].x1);
+  }
+  d.set(x0, y0, x1 - x0, y1 - y0);
+}
+
+TFT_eDisplayList::TFT_eDisplayList(void) {
+  _cur  = 0;
+  _bg   = 0;
+  _full = true;
+  _frame[0].bytes = _frame[0].count = 0;
+  _frame[1].bytes = _frame[1].count = 0;
+  _frame[0].overflow = _frame[1].overflow = false;
+}
+
+// Start recording a frame over the oldest one
+void TFT_eDisplayList::begin(void) {
+  tft_dlist_frame &f = _frame[_cur];
+  f.bytes    = 0;
+  f.count    = 0;
+  f.overflow = false;
+}
+
+// Reserve space for a call with len bytes of arguments and a box of x0, y0 to x1, y1 (exclusive)
+// Returns where the arguments go, or nullptr if the frame is full
+uint8_t *TFT_eDisplayList::put(uint8_t op, uint32_t len, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  tft_dlist_frame &f = _frame[_cur];
+  if ((f.count == TFT_DLIST_ITEMS) || (f.bytes + 1 + len > TFT_DLIST_BYTES)) {
+    f.overflow = true;
+    return nullptr;
+  }
+
+  tft_dlist_item &item = f.items[f.count++];
+  item.offset = f.bytes;
+  item.len    = 1 + len;
+  item.box    = { dlistClamp(x0), dlistClamp(y0), dlistClamp(x1), dlistClamp(y1) };
+
+  uint8_t *p = f.code + f.bytes;
+  f.bytes += 1 + len;
+  *p = op;
+  return p + 1;
+}
+
+// Record a single pixel
+void TFT_eDisplayList::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  uint8_t *p = put(TFT_DL_PIXEL, 6, x, y, x + 1, y + 1);
+  if (!p) return;
+  dlistPut<int16_t>(p, x); dlistPut<int16_t>(p, y); dlistPut<uint16_t>(p, color);
+}
+
+// Record a filled rectangle
+void TFT_eDisplayList::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  uint8_t *p = put(TFT_DL_FILL_RECT, TFT_DL_RECT_BYTES, x, y, x + w, y + h);
+  if (!p) return;
+  dlistPut<int16_t>(p, x); dlistPut<int16_t>(p, y); dlistPut<int16_t>(p, w); dlistPut<int16_t>(p, h);
+  dlistPut<uint16_t>(p, color);
+}
+
+// Record a fill of the whole screen, large sizes are clipped by fillRect() when replayed
+void TFT_eDisplayList::fillScreen(uint32_t color) {
+  fillRect(0, 0, INT16_MAX, INT16_MAX, color);
+}
+
+// Record a horizontal line
+void TFT_eDisplayList::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  uint8_t *p = put(TFT_DL_HLINE, TFT_DL_LINE_BYTES, x, y, x + w, y + 1);
+  if (!p) return;
+  dlistPut<int16_t>(p, x); dlistPut<int16_t>(p, y); dlistPut<int16_t>(p, w); dlistPut<uint16_t>(p, color);
+}
+
+// Record a vertical line
+void TFT_eDisplayList::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  uint8_t *p = put(TFT_DL_VLINE, TFT_DL_LINE_BYTES, x, y, x + 1, y + h);
+  if (!p) return;
+  dlistPut<int16_t>(p, x); dlistPut<int16_t>(p, y); dlistPut<int16_t>(p, h); dlistPut<uint16_t>(p, color);
+}
+
+// Record a circle outline
+void TFT_eDisplayList::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  uint8_t *p = put(TFT_DL_CIRCLE, TFT_DL_LINE_BYTES, x0 - r, y0 - r, x0 + r + 1, y0 + r + 1);
+  if (!p) return;
+  dlistPut<int16_t>(p, x0); dlistPut<int16_t>(p, y0); dlistPut<int16_t>(p, r); dlistPut<uint16_t>(p, color);
+}
+
+// Record a filled circle
+void TFT_eDisplayList::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  uint8_t *p = put(TFT_DL_FILL_CIRCLE, TFT_DL_LINE_BYTES, x0 - r, y0 - r, x0 + r + 1, y0 + r + 1);
+  if (!p) return;
+  dlistPut<int16_t>(p, x0); dlistPut<int16_t>(p, y0); dlistPut<int16_t>(p, r); dlistPut<uint16_t>(p, color);
+}
+
+// Record an anti-aliased line with round ends
+void TFT_eDisplayList::drawWideLine(float ax, float ay, float bx, float by, float wd, uint32_t fg_color, uint32_t bg_color) {
+  drawWedgeLine(ax, ay, bx, by, wd / 2.0f, wd / 2.0f, fg_color, bg_color);
+}
+
+// Record an anti-aliased wedge, pixels up to half a pixel beyond the radius are blended
+// Wedges drawWedgeLine() would reject are dropped, which also keeps the box within range
+void TFT_eDisplayList::drawWedgeLine(float ax, float ay, float bx, float by, float ar, float br, uint32_t fg_color, uint32_t bg_color) {
+  const float lim = 8191.0f;
+  if (!((ar >= 0.0f) && (ar <= lim) && (br >= 0.0f) && (br <= lim))) return;
+  if (!((ax >= -lim) && (ax <= lim) && (ay >= -lim) && (ay <= lim))) return;
+  if (!((bx >= -lim) && (bx <= lim) && (by >= -lim) && (by <= lim))) return;
+
+  int32_t x0 = floorf(std::min(ax - ar, bx - br)) - 1, x1 = ceilf(std::max(ax + ar, bx + br)) + 2;
+  int32_t y0 = floorf(std::min(ay - ar, by - br)) - 1, y1 = ceilf(std::max(ay + ar, by + br)) + 2;
+
+  uint8_t *p = put(TFT_DL_WEDGE, TFT_DL_WEDGE_BYTES, x0, y0, x1, y1);
+  if (!p) return;
+  dlistPut(p, ax); dlistPut(p, ay); dlistPut(p, bx); dlistPut(p, by); dlistPut(p, ar); dlistPut(p, br);
+  dlistPut<uint16_t>(p, fg_color); dlistPut<uint32_t>(p, bg_color);
+}
+
+// Record an image, the checksum is only compared so is not read back by tft_dlist_run()
+void TFT_eDisplayList::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+  if ((w < 1) || (h < 1)) return;
+
+  uint8_t *p = put(TFT_DL_IMAGE, TFT_DL_IMAGE_BYTES, x, y, x + w, y + h);
+  if (!p) return;
+  dlistPut<int16_t>(p, x); dlistPut<int16_t>(p, y); dlistPut<int16_t>(p, w); dlistPut<int16_t>(p, h);
+  dlistPut(p, (uint16_t *)data);
+  dlistPut(p, dlistChecksum(data, (uint32_t)w * h));
+}
+
+// Build the damage from the calls that differ between the frames, matched by position
+// A changed call damages both its old and new boxes, so what it covered is redrawn from the calls below
+void TFT_eDisplayList::diff(void) {
+  const tft_dlist_frame &a = _frame[_cur ^ 1];
+  const tft_dlist_frame &b = _frame[_cur];
+
+  _damage.clear();
+  if (_full) {
+    _damage.set(0, 0, INT16_MAX, INT16_MAX);
+    return;
+  }
+
+  uint16_t n = std::max(a.count, b.count);
+  for (uint16_t i = 0; i < n; i++) {
+    const tft_dlist_item *p = (i < a.count) ? &a.items[i] : nullptr;
+    const tft_dlist_item *q = (i < b.count) ? &b.items[i] : nullptr;
+    if (p && q && (p->len == q->len) && !memcmp(a.code + p->offset, b.code + q->offset, p->len)) continue;
+
+    if (p) dlistDamage(_damage, p->box);
+    if (q) dlistDamage(_damage, q->box);
+  }
+}
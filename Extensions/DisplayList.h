@@ -0,0 +1,250 @@
+#ifndef _TFT_eSPI_DISPLAYLIST_H_
+#define _TFT_eSPI_DISPLAYLIST_H_
+
+// Retained display list, a frame of draw calls is recorded as bytecode and compared with the last frame
+// so only the area that changed is redrawn
+// Only standard C++ is used here and in Region.h so lists can be replayed on a host into an in-memory display
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include "Region.h"
+
+// Bytes of bytecode and number of draw calls a frame holds, overflow() is set if more are recorded
+#ifndef TFT_DLIST_BYTES
+#define TFT_DLIST_BYTES 2048
+#endif
+#ifndef TFT_DLIST_ITEMS
+#define TFT_DLIST_ITEMS 128
+#endif
+
+// Size of the square RAM tiles endTiled() composites in, and the most tiles across the screen
+#ifndef TFT_DLIST_TILE
+#define TFT_DLIST_TILE 32
+#endif
+#define TFT_DLIST_COLS (512 / TFT_DLIST_TILE)
+
+// Draw call opcodes, each is followed by its arguments in the order of the function's parameters
+enum tft_dlist_op : uint8_t {
+  TFT_DL_PIXEL,
+  TFT_DL_FILL_RECT,
+  TFT_DL_HLINE,
+  TFT_DL_VLINE,
+  TFT_DL_CIRCLE,
+  TFT_DL_FILL_CIRCLE,
+  TFT_DL_WEDGE,
+  TFT_DL_IMAGE
+};
+
+// Recorded draw call, where its bytecode starts and how long it is, and the rectangle of pixels it can change
+struct tft_dlist_item {
+  uint16_t offset, len;
+  tft_region_rect box;
+};
+
+// Calls of one frame
+struct tft_dlist_frame {
+  uint8_t  code[TFT_DLIST_BYTES];
+  tft_dlist_item items[TFT_DLIST_ITEMS];
+  uint16_t bytes, count;
+  bool     overflow;
+};
+
+// Reads the arguments of a call in the order they were recorded, they are copied as they may be unaligned
+struct tft_dlist_reader {
+  const uint8_t *p;
+  template <typename V> V get(void) { V v; memcpy(&v, p, sizeof(V)); p += sizeof(V); return v; }
+};
+
+// Decode a call into calls on a display, T is TFT_eSPI on the target or an in-memory display on a host
+template <class T> void tft_dlist_run(T &tft, const uint8_t *code) {
+  tft_dlist_reader r = { code + 1 };
+
+  switch (code[0]) {
+    case TFT_DL_PIXEL: {
+      int16_t x = r.get<int16_t>(), y = r.get<int16_t>();
+      tft.drawPixel(x, y, r.get<uint16_t>());
+      break;
+    }
+    case TFT_DL_FILL_RECT: {
+      int16_t x = r.get<int16_t>(), y = r.get<int16_t>(), w = r.get<int16_t>(), h = r.get<int16_t>();
+      tft.fillRect(x, y, w, h, r.get<uint16_t>());
+      break;
+    }
+    case TFT_DL_HLINE: {
+      int16_t x = r.get<int16_t>(), y = r.get<int16_t>(), w = r.get<int16_t>();
+      tft.drawFastHLine(x, y, w, r.get<uint16_t>());
+      break;
+    }
+    case TFT_DL_VLINE: {
+      int16_t x = r.get<int16_t>(), y = r.get<int16_t>(), h = r.get<int16_t>();
+      tft.drawFastVLine(x, y, h, r.get<uint16_t>());
+      break;
+    }
+    case TFT_DL_CIRCLE:
+    case TFT_DL_FILL_CIRCLE: {
+      int16_t x = r.get<int16_t>(), y = r.get<int16_t>(), rad = r.get<int16_t>();
+      uint16_t color = r.get<uint16_t>();
+      if (code[0] == TFT_DL_CIRCLE) tft.drawCircle(x, y, rad, color);
+      else tft.fillCircle(x, y, rad, color);
+      break;
+    }
+    case TFT_DL_WEDGE: {
+      float ax = r.get<float>(), ay = r.get<float>(), bx = r.get<float>(), by = r.get<float>();
+      float ar = r.get<float>(), br = r.get<float>();
+      uint16_t fg = r.get<uint16_t>();
+      tft.drawWedgeLine(ax, ay, bx, by, ar, br, fg, r.get<uint32_t>());
+      break;
+    }
+    case TFT_DL_IMAGE: {
+      int16_t x = r.get<int16_t>(), y = r.get<int16_t>(), w = r.get<int16_t>(), h = r.get<int16_t>();
+      uint16_t *data = r.get<uint16_t *>();
+      tft.setWindow(x, y, x + w - 1, y + h - 1);
+      tft.pushColors(data, (uint32_t)w * h);
+      break;
+    }
+  }
+}
+
+// Display list recording a frame of draw calls, end() compares it with the last frame and redraws only
+// the calls whose bytecode changed, plus any call overlapping the area they cover now or covered before
+// Calls are matched by their position in the frame, so a screen built by the same code each frame only
+// redraws what moved or changed color
+class TFT_eDisplayList
+{
+ public:
+  TFT_eDisplayList(void);
+
+  // Start recording a frame, the last frame drawn is kept to compare against
+  void begin(void);
+
+  // Record draw calls, the arguments are those of the TFT_eSPI functions
+  void drawPixel(int32_t x, int32_t y, uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void fillScreen(uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void drawWideLine(float ax, float ay, float bx, float by, float wd, uint32_t fg_color, uint32_t bg_color = 0x00FFFFFF);
+  void drawWedgeLine(float ax, float ay, float bx, float by, float ar, float br, uint32_t fg_color, uint32_t bg_color = 0x00FFFFFF);
+
+  // Record a w x h image, data is read by end() and compared with the last frame by a checksum of its pixels
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+
+  // Color of pixels that no call draws, the changed area is cleared to it before calls are replayed
+  void setBackground(uint16_t color) { _bg = color; }
+
+  // Redraw the whole screen on the next end(), for when the display has been drawn by other means
+  void invalidate(void) { _full = true; }
+
+  // Compare the frame with the last one and redraw the changed area, returns the number of calls replayed
+  // The area is the union of the boxes of calls added, removed or changed, it is cleared to the background
+  // and every call reaching it is replayed in order through a clip region, so the pixels match drawing the
+  // whole frame. The display's clip region is removed afterwards
+  template <class T> uint32_t end(T &tft);
+
+  // As end(), but every tile of TFT_DLIST_TILE pixels the changed area reaches is redrawn whole in RAM and
+  // pushed as one window. Calls are binned by tile and replayed in order into the tile, so anti-aliased edges
+  // blend with what is drawn under them without reading the display. Returns the calls replayed, once per tile
+  // T must also have width(), height(), tileBegin() and tileEnd()
+  template <class T> uint32_t endTiled(T &tft);
+
+  // Area redrawn by the last end()
+  const TFT_eRegion &damage(void) { return _damage; }
+
+  // Bytes and calls recorded in the frame, and whether any were dropped for lack of space
+  uint32_t size(void) { return _frame[_cur].bytes; }
+  uint32_t count(void) { return _frame[_cur].count; }
+  bool overflow(void) { return _frame[_cur].overflow; }
+
+ private:
+  uint8_t *put(uint8_t op, uint32_t len, int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+  void diff(void);
+
+  // Frame being recorded and the last frame drawn, _cur indexes the first
+  tft_dlist_frame _frame[2];
+  uint8_t  _cur;
+
+  uint16_t _bg;
+  bool     _full;
+  TFT_eRegion _damage;
+
+  // Tile endTiled() composites in
+  uint16_t _tile[TFT_DLIST_TILE * TFT_DLIST_TILE];
+};
+
+// Redraw the damage, the clear is done before clipping as the rectangles of the region are already disjoint
+template <class T> uint32_t TFT_eDisplayList::end(T &tft) {
+  const tft_dlist_frame &f = _frame[_cur];
+  uint32_t n = 0;
+
+  diff();
+
+  if (!_damage.empty()) {
+    const tft_region_rect *r = _damage.rects();
+    for (uint16_t i = 0; i < _damage.count(); i++) tft.fillRect(r[i].x0, r[i].y0, r[i].x1 - r[i].x0, r[i].y1 - r[i].y0, _bg);
+
+    tft.setClipRegion(&_damage);
+    for (uint16_t i = 0; i < f.count; i++) {
+      const tft_region_rect &b = f.items[i].box;
+      if (!_damage.intersects(b.x0, b.y0, b.x1 - b.x0, b.y1 - b.y0)) continue;
+      tft_dlist_run(tft, f.code + f.items[i].offset);
+      n++;
+    }
+    tft.setClipRegion(nullptr);
+  }
+
+  // Calls dropped from this frame were never drawn, so the next frame cannot be compared with it
+  _full = f.overflow;
+  _cur ^= 1;
+  return n;
+}
+
+// Redraw the damage a tile at a time, the calls are binned for one row of tiles at a time with a bit per call
+// so each tile replays its calls in recorded order
+template <class T> uint32_t TFT_eDisplayList::endTiled(T &tft) {
+  const tft_dlist_frame &f = _frame[_cur];
+  const int32_t s = TFT_DLIST_TILE;
+  int32_t cols = std::min<int32_t>((tft.width() + s - 1) / s, TFT_DLIST_COLS);
+  int32_t rows = (tft.height() + s - 1) / s;
+  uint32_t n = 0;
+
+  diff();
+
+  for (int32_t ty = 0; (ty < rows) && !_damage.empty(); ty++) {
+    int32_t y = ty * s;
+    if (!_damage.intersects(0, y, cols * s, s)) continue;
+
+    uint32_t bins[TFT_DLIST_COLS][(TFT_DLIST_ITEMS + 31) / 32];
+    memset(bins, 0, sizeof(bins));
+    for (uint16_t i = 0; i < f.count; i++) {
+      const tft_region_rect &b = f.items[i].box;
+      if ((b.y1 <= y) || (b.y0 >= y + s) || (b.x1 <= 0) || (b.x0 >= b.x1) || (b.y0 >= b.y1)) continue;
+
+      int32_t c0 = std::max<int32_t>(b.x0, 0) / s, c1 = std::min<int32_t>((b.x1 - 1) / s, cols - 1);
+      for (int32_t c = c0; c <= c1; c++) bins[c][i >> 5] |= 1ul << (i & 31);
+    }
+
+    for (int32_t tx = 0; tx < cols; tx++) {
+      int32_t x = tx * s;
+      if (!_damage.intersects(x, y, s, s)) continue;
+
+      tft.tileBegin(_tile, x, y, s, s);
+      tft.fillRect(x, y, s, s, _bg);
+      for (uint16_t k = 0; k < (f.count + 31) / 32; k++) {
+        for (uint32_t bits = bins[tx][k]; bits; bits &= bits - 1) {
+          tft_dlist_run(tft, f.code + f.items[k * 32 + __builtin_ctz(bits)].offset);
+          n++;
+        }
+      }
+      tft.tileEnd();
+    }
+  }
+
+  _full = f.overflow;
+  _cur ^= 1;
+  return n;
+}
+
+#endif
@@ -0,0 +1,226 @@
+#include "Gradient.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+// Line index of a fixed point position in 1/65536ths, clamped to the ends of the line
+static inline uint8_t gradientClamp(int32_t t) {
+  return (uint8_t)std::min<int32_t>(std::max<int32_t>(t >> 16, 0), TFT_GRADIENT_LINE - 1);
+}
+
+// Angle of x, y in radians from -pi to pi, within 1e-5 of atan2f() at a fraction of its cost
+static float gradientAtan2(float y, float x) {
+  float ax = fabsf(x), ay = fabsf(y);
+  float mx = std::max(ax, ay), mn = std::min(ax, ay);
+  if (mx == 0.0f) return 0.0f;
+
+  float r = mn / mx, s = r * r;
+  float a = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * r + r;
+  if (ay > ax) a = 1.57079637f - a;
+  if (x < 0.0f) a = 3.14159274f - a;
+  return (y < 0.0f) ? -a : a;
+}
+
+TFT_eGradient::TFT_eGradient(void) {
+  _count  = 0;
+  _dirty  = true;
+  _dither = TFT_DITHER_BLUE_NOISE;
+  linear(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+// Remove all stops
+void TFT_eGradient::clearStops(void) {
+  _count = 0;
+  _dirty = true;
+}
+
+// Insert a stop after any at the same position, so stops added in order at one position keep that order
+bool TFT_eGradient::addStop(float pos, uint32_t color) {
+  if (_count == TFT_GRADIENT_STOPS) return false;
+
+  pos = std::min(std::max(pos, 0.0f), 1.0f);
+  uint8_t i = _count++;
+  for (; (i > 0) && (_stops[i - 1].pos > pos); i--) _stops[i] = _stops[i - 1];
+  _stops[i] = { pos, color & 0xFFFFFF };
+
+  _dirty = true;
+  return true;
+}
+
+// Position along the line is the projection onto it, scaled so the two points fall on the ends of the line
+void TFT_eGradient::linear(float x0, float y0, float x1, float y1) {
+  float dx = x1 - x0, dy = y1 - y0, len2 = dx * dx + dy * dy;
+  float k = (len2 > 0.0f) ? (TFT_GRADIENT_LINE - 1) / len2 : 0.0f;
+
+  _mode = TFT_GRADIENT_LINEAR;
+  _x = x0;
+  _y = y0;
+  _a = dx * k;
+  _b = dy * k;
+}
+
+// Distance from the centre scaled so the radius falls on the end of the line
+void TFT_eGradient::radial(float x, float y, float r) {
+  _mode = TFT_GRADIENT_RADIAL;
+  _x = x;
+  _y = y;
+  _a = (r > 0.0f) ? (TFT_GRADIENT_LINE - 1) / r : 0.0f;
+}
+
+// Angle around the centre in 1/256ths of a turn, the line wraps so the last stop meets the first
+void TFT_eGradient::conic(float x, float y, float angle) {
+  _mode = TFT_GRADIENT_CONIC;
+  _x = x;
+  _y = y;
+  _b = angle * (TFT_GRADIENT_LINE / 360.0f);
+}
+
+// Interpolate the stops into the color line, the position of entry i is i / (TFT_GRADIENT_LINE - 1)
+// Entries before the first stop or after the last take its color
+void TFT_eGradient::build(TFT_eSPI *tft) {
+  uint8_t k = 0;
+  for (uint32_t i = 0; i < TFT_GRADIENT_LINE; i++) {
+    float p = (float)i / (TFT_GRADIENT_LINE - 1);
+    while ((k < _count) && (_stops[k].pos <= p)) k++;
+
+    uint32_t c;
+    if (_count == 0) c = 0;
+    else if (k == 0) c = _stops[0].color;
+    else if (k == _count) c = _stops[_count - 1].color;
+    else {
+      const tft_gradient_stop &s0 = _stops[k - 1], &s1 = _stops[k];
+      int32_t f = (int32_t)((p - s0.pos) / (s1.pos - s0.pos) * 256.0f + 0.5f);
+      c = 0;
+      for (uint8_t sh = 0; sh < 24; sh += 8) {
+        int32_t a = (s0.color >> sh) & 0xFF, b = (s1.color >> sh) & 0xFF;
+        c |= (uint32_t)(a + (((b - a) * f + 128) >> 8)) << sh;
+      }
+    }
+
+    _rgb[3 * i]     = c >> 16;
+    _rgb[3 * i + 1] = c >> 8;
+    _rgb[3 * i + 2] = c;
+  }
+
+  tft->color24to16Row(_rgb, _color, TFT_GRADIENT_LINE, 0, 0, TFT_DITHER_NONE);
+  _dirty = false;
+}
+
+// Line index of n pixels from x, y to the right
+// Linear positions step in fixed point, the start is clamped and the step kept below 128 entries per pixel
+// so a run of TFT_GRADIENT_SPAN cannot overflow, clamped values stay clamped as they are far off the line
+void TFT_eGradient::index(uint8_t *idx, int32_t x, int32_t y, uint32_t n) {
+  float dx = x - _x, dy = y - _y;
+
+  if (_mode == TFT_GRADIENT_LINEAR) {
+    const float lim = 16384.0f * 65536.0f;
+    float t0 = (dx * _a + dy * _b) * 65536.0f + 32768.0f;
+    int32_t t = (int32_t)std::min(std::max(t0, -lim), lim);
+    int32_t step = (int32_t)std::min(std::max(_a * 65536.0f, -8323072.0f), 8323072.0f);
+    for (uint32_t i = 0; i < n; i++, t += step) idx[i] = gradientClamp(t);
+  }
+  else if (_mode == TFT_GRADIENT_RADIAL) {
+    float dy2 = dy * dy;
+    for (uint32_t i = 0; i < n; i++, dx += 1.0f) {
+      idx[i] = (uint8_t)std::min(sqrtf(dx * dx + dy2) * _a + 0.5f, TFT_GRADIENT_LINE - 1.0f);
+    }
+  }
+  else {
+    // Clockwise on screen from 6 o'clock is from +y towards -x
+    const float k = TFT_GRADIENT_LINE / 6.28318531f;
+    for (uint32_t i = 0; i < n; i++, dx += 1.0f) {
+      idx[i] = (uint8_t)((int32_t)floorf(gradientAtan2(-dx, dy) * k - _b + 0.5f) & (TFT_GRADIENT_LINE - 1));
+    }
+  }
+}
+
+// Look the indexes up, or dither the 8-bit colors by the pixels' screen position
+void TFT_eGradient::colors(TFT_eSPI *tft, uint16_t *out, const uint8_t *idx, int32_t x, int32_t y, uint32_t n) {
+  if (_dither == TFT_DITHER_NONE) {
+    for (uint32_t i = 0; i < n; i++) out[i] = _color[idx[i]];
+    return;
+  }
+
+  uint8_t rgb[TFT_GRADIENT_SPAN * 3];
+  for (uint32_t i = 0; i < n; i++) memcpy(rgb + 3 * i, _rgb + 3 * idx[i], 3);
+  tft->color24to16Row(rgb, out, n, x, y, _dither);
+}
+
+// Compute a row a run at a time
+void TFT_eGradient::row(TFT_eSPI *tft, uint16_t *out, int32_t x, int32_t y, uint32_t n) {
+  if (_dirty) build(tft);
+
+  uint8_t idx[TFT_GRADIENT_SPAN];
+  while (n) {
+    uint32_t m = std::min<uint32_t>(n, TFT_GRADIENT_SPAN);
+    index(idx, x, y, m);
+    colors(tft, out, idx, x, y, m);
+    out += m;
+    x += m;
+    n -= m;
+  }
+}
+
+// Fill in one of three orders: a gradient along x is sent a column of runs at a time with the indexes found
+// once per column, one along y without dithering is a solid color per row, any other a row at a time
+// The buffers are colors rather than bytes in the order of the sketch, so byte swapping is off while they are sent
+void TFT_eGradient::fill(TFT_eSPI *tft, int32_t x, int32_t y, int32_t w, int32_t h) {
+  int32_t x0 = std::max<int32_t>(x, 0), x1 = std::min<int32_t>(x + w, tft->width());
+  int32_t y0 = std::max<int32_t>(y, 0), y1 = std::min<int32_t>(y + h, tft->height());
+  if ((x0 >= x1) || (y0 >= y1)) return;
+
+  if (_dirty) build(tft);
+
+  uint16_t line[2][TFT_GRADIENT_SPAN];
+  uint8_t  idx[TFT_GRADIENT_SPAN];
+  uint8_t  b = 0;
+
+  bool swap = tft->getSwapBytes();
+  tft->setSwapBytes(false);
+  tft->startWrite();
+
+  if ((_mode == TFT_GRADIENT_LINEAR) && (_b == 0.0f)) {
+    for (int32_t i = x0; i < x1; i += TFT_GRADIENT_SPAN) {
+      int32_t m = std::min<int32_t>(x1 - i, TFT_GRADIENT_SPAN);
+      tft->setWindow(i, y0, i + m - 1, y1 - 1);
+      index(idx, i, y0, m);
+
+      if (_dither == TFT_DITHER_NONE) {
+        // The line does not change, so it is sent again without waiting to refill it
+        colors(tft, line[b], idx, i, y0, m);
+        for (int32_t j = y0; j < y1; j++) tft->pushColorsAsync(line[b], m);
+        b ^= 1;
+        continue;
+      }
+
+      uint8_t rgb[TFT_GRADIENT_SPAN * 3];
+      for (int32_t k = 0; k < m; k++) memcpy(rgb + 3 * k, _rgb + 3 * idx[k], 3);
+      for (int32_t j = y0; j < y1; j++, b ^= 1) {
+        tft->color24to16Row(rgb, line[b], m, i, j, _dither);
+        tft->pushColorsAsync(line[b], m);
+      }
+    }
+  }
+  else if ((_mode == TFT_GRADIENT_LINEAR) && (_a == 0.0f) && (_dither == TFT_DITHER_NONE)) {
+    tft->setWindow(x0, y0, x1 - 1, y1 - 1);
+    for (int32_t j = y0; j < y1; j++) {
+      index(idx, x0, j, 1);
+      tft->pushBlock(_color[idx[0]], x1 - x0);
+    }
+  }
+  else {
+    tft->setWindow(x0, y0, x1 - 1, y1 - 1);
+    for (int32_t j = y0; j < y1; j++) {
+      for (int32_t i = x0; i < x1; i += TFT_GRADIENT_SPAN, b ^= 1) {
+        int32_t m = std::min<int32_t>(x1 - i, TFT_GRADIENT_SPAN);
+        index(idx, i, j, m);
+        colors(tft, line[b], idx, i, j, m);
+        tft->pushColorsAsync(line[b], m);
+      }
+    }
+  }
+
+  tft->endWrite();
+  tft->dmaWait();  // The line buffers are on the stack
+  tft->setSwapBytes(swap);
+}
@@ -0,0 +1,83 @@
+#ifndef _TFT_eSPI_GRADIENT_H_
+#define _TFT_eSPI_GRADIENT_H_
+
+#include <stdint.h>
+#include "TFT_eSPI.h"
+
+// Most color stops a gradient holds, addStop() fails once it is full
+#ifndef TFT_GRADIENT_STOPS
+#define TFT_GRADIENT_STOPS 8
+#endif
+
+// Colors in the color line, each pixel's position along the gradient is rounded to one of them
+#define TFT_GRADIENT_LINE 256
+
+// Pixels computed per line buffer
+#define TFT_GRADIENT_SPAN 64
+
+// Gradient shapes, along a line, by distance from a centre, or by angle around a centre
+#define TFT_GRADIENT_LINEAR 0
+#define TFT_GRADIENT_RADIAL 1
+#define TFT_GRADIENT_CONIC  2
+
+// Color stop, a 24-bit 0xRRGGBB color at a position from 0 to 1 along the gradient
+struct tft_gradient_stop {
+  float    pos;
+  uint32_t color;
+};
+
+// Gradient of any number of color stops drawn on a TFT_eSPI, or on any class derived from it
+// The stops are interpolated once into a line of TFT_GRADIENT_LINE colors, so drawing a pixel is finding its
+// position and looking its color up. Colors are kept at 8 bits per channel and dithered to 565 by the
+// display's color24to16Row() as they are drawn, so shallow gradients do not band
+class TFT_eGradient
+{
+ public:
+  TFT_eGradient(void);
+
+  // Remove all stops, a gradient without stops is black
+  void clearStops(void);
+
+  // Add a stop, stops may be added in any order and two at the same position give a hard edge
+  // Returns false if TFT_GRADIENT_STOPS are already held
+  bool addStop(float pos, uint32_t color);
+
+  // Shape the gradient: along the line from x0, y0 to x1, y1, with ends beyond it extending the end colors
+  // Out from a centre to radius r, or clockwise around a centre from angle degrees clockwise from 6 o'clock
+  void linear(float x0, float y0, float x1, float y1);
+  void radial(float x, float y, float r);
+  void conic(float x, float y, float angle);
+
+  // Dither pattern, one of the TFT_DITHER_ values, TFT_DITHER_NONE draws the line's nearest 565 colors
+  void setDither(uint8_t dither) { _dither = dither; }
+
+  // Fill a rectangle, clipped to the screen. Each run of pixels is computed into one of two line buffers
+  // while the other is sent by DMA, if the display has it enabled. A gradient along x computes its colors
+  // once per column of runs and sends the same line for every row
+  void fill(TFT_eSPI *tft, int32_t x, int32_t y, int32_t w, int32_t h);
+  void fillScreen(TFT_eSPI *tft) { fill(tft, 0, 0, tft->width(), tft->height()); }
+
+  // Compute n 565 colors of the row at x, y into out, for drawing into a RAM buffer or sprite
+  void row(TFT_eSPI *tft, uint16_t *out, int32_t x, int32_t y, uint32_t n);
+
+ private:
+  void build(TFT_eSPI *tft);
+  void index(uint8_t *idx, int32_t x, int32_t y, uint32_t n);
+  void colors(TFT_eSPI *tft, uint16_t *out, const uint8_t *idx, int32_t x, int32_t y, uint32_t n);
+
+  tft_gradient_stop _stops[TFT_GRADIENT_STOPS];
+  uint8_t  _count;
+  bool     _dirty;  // Stops changed since the color line was built
+
+  uint8_t  _mode, _dither;
+
+  // Linear: start point and line index per pixel in x and y. Radial: centre and index per pixel of distance
+  // Conic: centre and the start angle in 1/256ths of a turn
+  float    _x, _y, _a, _b;
+
+  // Color line at 8 bits per channel, and rounded to 565 for TFT_DITHER_NONE
+  uint8_t  _rgb[TFT_GRADIENT_LINE * 3];
+  uint16_t _color[TFT_GRADIENT_LINE];
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "PIO_SPI.h"
+#include "hardware/clocks.h"
+#include "Processors/pio_SPI_dc.pio.h"
+
+TFT_eSPI_PIO::TFT_eSPI_PIO(void) {
+  _pio       = pio0;
+  _sm        = -1;
+  _offset    = 0;
+  _stallMask = 0;
+  _dmaWords  = -1;
+  _dmaPixels = -1;
+  _active    = false;
+  _swapBytes = false;
+  _color     = 0;
+}
+
+// Load the program and attach the state machine to the pins
+bool TFT_eSPI_PIO::begin(const tft_bus_config &config, uint32_t freq) {
+  // Try both PIOs to find space for the program
+  _pio = pio0;
+  if (!pio_can_add_program(_pio, &tft_dc_io_program)) {
+    _pio = pio1;
+    if (!pio_can_add_program(_pio, &tft_dc_io_program)) return false;
+  }
+
+  _sm = pio_claim_unused_sm(_pio, false);
+  if (_sm < 0) return false;
+
+  _dmaWords  = dma_claim_unused_channel(false);
+  _dmaPixels = dma_claim_unused_channel(false);
+  if ((_dmaWords < 0) || (_dmaPixels < 0)) {
+    if (_dmaWords >= 0)  dma_channel_unclaim(_dmaWords);
+    if (_dmaPixels >= 0) dma_channel_unclaim(_dmaPixels);
+    pio_sm_unclaim(_pio, _sm);
+    _sm = -1;
+    return false;
+  }
+
+  _offset = pio_add_program(_pio, &tft_dc_io_program);
+
+  _cs   = config.cs;
+  _dc   = config.dc;
+  _mosi = config.mosi;
+  _sclk = config.sclk;
+  _csMask = 1ul << _cs;
+
+  // CS stays under CPU control
+  gpio_init(_cs);
+  gpio_set_dir(_cs, GPIO_OUT);
+  gpio_put(_cs, 1);
+
+  pio_gpio_init(_pio, _dc);
+  pio_gpio_init(_pio, _sclk);
+  pio_gpio_init(_pio, _mosi);
+  pio_sm_set_consecutive_pindirs(_pio, _sm, _dc, 1, true);
+  pio_sm_set_consecutive_pindirs(_pio, _sm, _sclk, 1, true);
+  pio_sm_set_consecutive_pindirs(_pio, _sm, _mosi, 1, true);
+
+  pio_sm_config c = tft_dc_io_program_get_default_config(_offset);
+  sm_config_set_out_pins(&c, _mosi, 1);
+  sm_config_set_set_pins(&c, _dc, 1);
+  sm_config_set_sideset_pins(&c, _sclk);
+
+  // Shift left with autopull after the 16 bits in the top half of each data word
+  sm_config_set_out_shift(&c, false, true, 16);
+  sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+
+  // Each bit takes two state machine cycles
+  sm_config_set_clkdiv(&c, (float)clock_get_hz(clk_sys) / (2.0f * freq));
+
+  pio_sm_init(_pio, _sm, _offset, &c);
+  pio_sm_set_enabled(_pio, _sm, true);
+
+  _stallMask = 1u << (PIO_FDEBUG_TXSTALL_LSB + _sm);
+  return true;
+}
+
+// Return the pins to the SPI block and the CPU
+void TFT_eSPI_PIO::end(void) {
+  if (_sm < 0) return;
+  wait();
+
+  pio_sm_set_enabled(_pio, _sm, false);
+  pio_remove_program(_pio, &tft_dc_io_program, _offset);
+  pio_sm_unclaim(_pio, _sm);
+  dma_channel_unclaim(_dmaWords);
+  dma_channel_unclaim(_dmaPixels);
+  _sm = -1;
+
+  gpio_set_function(_mosi, GPIO_FUNC_SPI);
+  gpio_set_function(_sclk, GPIO_FUNC_SPI);
+  gpio_init(_dc);
+  gpio_set_dir(_dc, GPIO_OUT);
+  gpio_put(_dc, 1);
+}
+
+// Start n encoded words, chained to len pixels if len is not 0
+void TFT_eSPI_PIO::start(const uint32_t *words, uint32_t n, const uint16_t *pixels, uint32_t len, bool increment) {
+  volatile void *txf = &_pio->txf[_sm];
+
+  if (len) {
+    dma_channel_config cp = dma_channel_get_default_config(_dmaPixels);
+    channel_config_set_transfer_data_size(&cp, DMA_SIZE_16);
+    channel_config_set_read_increment(&cp, increment);
+    channel_config_set_write_increment(&cp, false);
+    channel_config_set_bswap(&cp, increment && _swapBytes);
+    channel_config_set_dreq(&cp, pio_get_dreq(_pio, _sm, true));
+    dma_channel_configure(_dmaPixels, &cp, txf, pixels, len, false);
+  }
+
+  // The word channel starts the pixel channel when it completes
+  dma_channel_config cw = dma_channel_get_default_config(_dmaWords);
+  channel_config_set_transfer_data_size(&cw, DMA_SIZE_32);
+  channel_config_set_read_increment(&cw, true);
+  channel_config_set_write_increment(&cw, false);
+  channel_config_set_dreq(&cw, pio_get_dreq(_pio, _sm, true));
+  channel_config_set_chain_to(&cw, len ? _dmaPixels : _dmaWords);
+
+  sio_hw->gpio_clr = _csMask;  // Assert CS
+  _active = true;
+  dma_channel_configure(_dmaWords, &cw, txf, words, n, true);
+}
+
+// Send a window and its pixels
+void TFT_eSPI_PIO::pushWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, const uint16_t *data) {
+  uint32_t len = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+
+  wait();
+  tft_dc_window(_head, x0, y0, x1, y1, len);
+  start(_head, TFT_DC_WINDOW_WORDS, data, len, true);
+}
+
+// Fill a window with one color, the pixel channel re-reads the same halfword
+void TFT_eSPI_PIO::fillWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color) {
+  uint32_t len = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+
+  wait();
+  _color = color;
+  tft_dc_window(_head, x0, y0, x1, y1, len);
+  start(_head, TFT_DC_WINDOW_WORDS, &_color, len, false);
+}
+
+// Send a pre-encoded stream
+void TFT_eSPI_PIO::pushStream(const uint32_t *words, uint32_t n) {
+  if (!n) return;
+
+  wait();
+  start(words, n, nullptr, 0, false);
+}
+
+// Check for completion, the state machine stalls on the header pull once the last bit has been sent
+bool TFT_eSPI_PIO::busy(void) {
+  if (!_active) return false;
+  if (dma_channel_is_busy(_dmaWords) || dma_channel_is_busy(_dmaPixels)) return true;
+  if (!pio_sm_is_tx_fifo_empty(_pio, _sm)) return true;
+
+  _pio->fdebug = _stallMask;  // Clear the flag, it is set again at once if the state machine is waiting
+  if (!(_pio->fdebug & _stallMask)) return true;
+
+  sio_hw->gpio_set = _csMask;  // Release CS
+  _active = false;
+  return false;
+}
+
+// Wait for completion
+void TFT_eSPI_PIO::wait(void) {
+  while (busy()) {};
+}
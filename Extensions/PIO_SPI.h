@@ -0,0 +1,57 @@
+#ifndef _TFT_eSPI_PIO_SPI_H_
+#define _TFT_eSPI_PIO_SPI_H_
+
+#include <stdint.h>
+#include "TFT_eSPI.h"
+#include "hardware/pio.h"
+#include "DC_stream.h"
+
+// SPI transmitter run by a PIO state machine, the DC level travels in the FIFO stream (see DC_stream.h)
+// so a window command sequence and its pixels are sent by one chained DMA transfer with no CPU work
+// While begun the state machine owns the MOSI, SCLK and DC pins, call end() before using a TFT_eSPI
+// instance on the same pins again. Coordinates are controller RAM coordinates as sent by CASET/RASET
+class TFT_eSPI_PIO
+{
+ public:
+  TFT_eSPI_PIO(void);
+
+  // Claim a state machine and two DMA channels and take over the pins, returns false if none are free
+  bool begin(const tft_bus_config &config, uint32_t freq);
+
+  // Wait for the transfer in progress, release the state machine and channels and return the pins
+  void end(void);
+
+  // Send a window and its pixels, data must not change until busy() returns false
+  void pushWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, const uint16_t *data);
+
+  // Fill a window with one color
+  void fillWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color);
+
+  // Send a stream built with the DC_stream.h encoders, words must not change until busy() returns false
+  void pushStream(const uint32_t *words, uint32_t n);
+
+  // Set whether pixel buffers hold colors with the bytes swapped
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+
+  // Check if a transfer is in progress, or wait for it to complete, CS is released once it has
+  bool busy(void);
+  void wait(void);
+
+ private:
+  void start(const uint32_t *words, uint32_t n, const uint16_t *pixels, uint32_t len, bool increment);
+
+  PIO      _pio;
+  int8_t   _sm;
+  uint32_t _offset;
+  uint32_t _stallMask;
+  int32_t  _dmaWords, _dmaPixels;
+  int8_t   _cs, _dc, _mosi, _sclk;
+  uint32_t _csMask;
+  bool     _active, _swapBytes;
+  uint16_t _color;
+
+  // Encoded window commands sent ahead of the pixels
+  uint32_t _head[TFT_DC_WINDOW_WORDS];
+};
+
+#endif
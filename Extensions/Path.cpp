@@ -0,0 +1,519 @@
+#include "Path.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+// Point flags, the first point of a subpath and the last point of a closed one
+#define TFT_PATH_MOVE  1
+#define TFT_PATH_CLOSE 2
+
+// Coordinates are clamped to this many pixels either side of the origin so products stay within 64 bits
+#define TFT_PATH_LIMIT 8191
+
+// Integer square root
+static uint32_t pathSqrt(uint64_t v) {
+  uint64_t r = 0, bit = (uint64_t)1 << 62;
+  while (bit > v) bit >>= 2;
+  while (bit) {
+    if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+    else r >>= 1;
+    bit >>= 2;
+  }
+  return r;
+}
+
+// Division rounded to the nearest integer
+static int64_t pathDiv(int64_t a, int64_t b) {
+  if (b < 0) { a = -a; b = -b; }
+  return (a >= 0) ? (a + b / 2) / b : -((-a + b / 2) / b);
+}
+
+// Division rounded towards minus infinity
+static int32_t pathFloorDiv(int32_t a, int32_t b) {
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// Convert a coordinate to 1/256ths of a pixel
+static int32_t pathFixed(float v) {
+  const float lim = TFT_PATH_LIMIT;
+  if (!(v >= -lim)) v = -lim;  // Also catches NaN
+  if (v > lim) v = lim;
+  return (int32_t)(v * 256.0f + ((v < 0.0f) ? -0.5f : 0.5f));
+}
+
+// Number of lines for a curve whose second derivative is at most k * d, n uniform chords are within k * d / 8n^2
+static uint32_t pathSteps(uint32_t d, uint32_t k) {
+  uint64_t q = ((uint64_t)k * d + 8 * TFT_PATH_TOLERANCE - 1) / (8 * TFT_PATH_TOLERANCE);
+  uint32_t n = pathSqrt(q);
+  if ((uint64_t)n * n < q) n++;
+  return std::min<uint32_t>(std::max<uint32_t>(n, 1), TFT_PATH_MAX_STEPS);
+}
+
+// Offset of length hw at right angles to the direction dx, dy, round joins turn from it towards the direction
+static void pathNormal(int32_t dx, int32_t dy, int32_t hw, int32_t &nx, int32_t &ny) {
+  int64_t len = pathSqrt((int64_t)dx * dx + (int64_t)dy * dy);
+  nx = pathDiv((int64_t)dy * hw, len);
+  ny = pathDiv(-(int64_t)dx * hw, len);
+}
+
+TFT_ePath::TFT_ePath(void) {
+  _count     = 0;
+  _overflow  = false;
+  _cx = _cy  = 0;
+  _sx = _sy  = 0;
+  _open      = false;
+  _edges     = nullptr;
+  _edgeCount = 0;
+  _edgeCap   = 0;
+  _contour   = false;
+  _hw        = 0;
+  _join      = TFT_JOIN_ROUND;
+  _arcCos    = 65536;
+  _arcSin    = 0;
+}
+
+TFT_ePath::~TFT_ePath(void) {
+  free(_edges);
+}
+
+// Remove all subpaths
+void TFT_ePath::clear(void) {
+  _count    = 0;
+  _overflow = false;
+  _cx = _cy = 0;
+  _open     = false;
+}
+
+// Add a point, repeats of the last point are dropped
+void TFT_ePath::addPoint(int32_t x, int32_t y, uint8_t flags) {
+  if (!(flags & TFT_PATH_MOVE) && _count && (_points[_count - 1].x == x) && (_points[_count - 1].y == y)) return;
+  if (_count == TFT_PATH_POINTS) { _overflow = true; return; }
+
+  _points[_count].x     = x;
+  _points[_count].y     = y;
+  _points[_count].flags = flags;
+  _count++;
+}
+
+// Start a subpath
+void TFT_ePath::moveTo(float x, float y) {
+  _cx = _sx = pathFixed(x);
+  _cy = _sy = pathFixed(y);
+  addPoint(_cx, _cy, TFT_PATH_MOVE);
+  _open = true;
+}
+
+// Add a line in fixed point, starting a subpath at the current point if none is open
+void TFT_ePath::lineToFixed(int32_t x, int32_t y) {
+  if (!_open) {
+    _sx = _cx;
+    _sy = _cy;
+    addPoint(_cx, _cy, TFT_PATH_MOVE);
+    _open = true;
+  }
+  addPoint(x, y, 0);
+  _cx = x;
+  _cy = y;
+}
+
+// Add a line
+void TFT_ePath::lineTo(float x, float y) {
+  lineToFixed(pathFixed(x), pathFixed(y));
+}
+
+// Add a quadratic curve, each point is worked out exactly from the Bernstein form so no error builds up
+void TFT_ePath::quadTo(float cx, float cy, float x, float y) {
+  int64_t x0 = _cx, y0 = _cy;
+  int64_t x1 = pathFixed(cx), y1 = pathFixed(cy);
+  int64_t x2 = pathFixed(x),  y2 = pathFixed(y);
+
+  int64_t ddx = x0 - 2 * x1 + x2, ddy = y0 - 2 * y1 + y2;
+  uint32_t n = pathSteps(pathSqrt(ddx * ddx + ddy * ddy), 2);
+
+  int64_t nn = (int64_t)n * n;
+  for (uint32_t i = 1; i <= n; i++) {
+    int64_t a = n - i, b = i;
+    lineToFixed(pathDiv(a * a * x0 + 2 * a * b * x1 + b * b * x2, nn),
+                pathDiv(a * a * y0 + 2 * a * b * y1 + b * b * y2, nn));
+  }
+}
+
+// Add a cubic curve
+void TFT_ePath::cubicTo(float c1x, float c1y, float c2x, float c2y, float x, float y) {
+  int64_t x0 = _cx, y0 = _cy;
+  int64_t x1 = pathFixed(c1x), y1 = pathFixed(c1y);
+  int64_t x2 = pathFixed(c2x), y2 = pathFixed(c2y);
+  int64_t x3 = pathFixed(x),   y3 = pathFixed(y);
+
+  int64_t ax = x0 - 2 * x1 + x2, ay = y0 - 2 * y1 + y2;
+  int64_t bx = x1 - 2 * x2 + x3, by = y1 - 2 * y2 + y3;
+  uint32_t d = std::max(pathSqrt(ax * ax + ay * ay), pathSqrt(bx * bx + by * by));
+  uint32_t n = pathSteps(d, 6);
+
+  int64_t nnn = (int64_t)n * n * n;
+  for (uint32_t i = 1; i <= n; i++) {
+    int64_t a = n - i, b = i;
+    int64_t k0 = a * a * a, k1 = 3 * a * a * b, k2 = 3 * a * b * b, k3 = b * b * b;
+    lineToFixed(pathDiv(k0 * x0 + k1 * x1 + k2 * x2 + k3 * x3, nnn),
+                pathDiv(k0 * y0 + k1 * y1 + k2 * y2 + k3 * y3, nnn));
+  }
+}
+
+// Close the subpath
+void TFT_ePath::close(void) {
+  if (_open && _count) _points[_count - 1].flags |= TFT_PATH_CLOSE;
+  _open = false;
+  _cx = _sx;
+  _cy = _sy;
+}
+
+// Add an outline point, the first point of a contour is only remembered
+// Edges are stored shifted by half a pixel so pixel x covers cells x * 256 to x * 256 + 255
+void TFT_ePath::edgeTo(int32_t x, int32_t y) {
+  x += 128;
+  y += 128;
+
+  if (!_contour) {
+    _fx = _px = x;
+    _fy = _py = y;
+    _contour = true;
+    return;
+  }
+  if ((x == _px) && (y == _py)) return;
+
+  // Horizontal edges add no coverage
+  if (y != _py) {
+    if (_edgeCount == _edgeCap) {
+      uint32_t cap = _edgeCap ? 2 * _edgeCap : 64;
+      tft_path_edge *edges = (tft_path_edge *)realloc(_edges, cap * sizeof(tft_path_edge));
+      if (edges == nullptr) { _overflow = true; return; }
+      _edges   = edges;
+      _edgeCap = cap;
+    }
+    tft_path_edge &e = _edges[_edgeCount++];
+    e.x0 = _px; e.y0 = _py;
+    e.x1 = x;   e.y1 = y;
+  }
+  _px = x;
+  _py = y;
+}
+
+// Close the contour with an edge back to its first point
+void TFT_ePath::edgeClose(void) {
+  if (_contour) edgeTo(_fx - 128, _fy - 128);
+  _contour = false;
+}
+
+// Add the points of a round join or end, turning from offset a to offset b around x, y
+void TFT_ePath::arc(int32_t x, int32_t y, int32_t ax, int32_t ay, int32_t bx, int32_t by) {
+  edgeTo(x + ax, y + ay);
+
+  // The offset is rotated in 1/65536ths of a pixel so rounding does not build up
+  int64_t vx = (int64_t)ax << 8, vy = (int64_t)ay << 8;
+  int64_t r2 = (int64_t)ax * ax + (int64_t)ay * ay;
+
+  for (uint32_t i = 0; i < 2 * TFT_PATH_MAX_STEPS; i++) {
+    // Stop once b is within one step
+    int64_t px = vx >> 8, py = vy >> 8;
+    if ((px * bx + py * by) * 65536 >= _arcCos * r2) break;
+
+    int64_t nx = (vx * _arcCos - vy * _arcSin) >> 16;
+    vy = (vx * _arcSin + vy * _arcCos) >> 16;
+    vx = nx;
+    edgeTo(x + (int32_t)pathDiv(vx, 256), y + (int32_t)pathDiv(vy, 256));
+  }
+
+  edgeTo(x + bx, y + by);
+}
+
+// Join the offsets a and b of the lines in directions da and db meeting at x, y
+void TFT_ePath::join(int32_t x, int32_t y, int32_t ax, int32_t ay, int32_t bx, int32_t by, int32_t dax, int32_t day, int32_t dbx, int32_t dby) {
+  int64_t cross = (int64_t)dax * dby - (int64_t)day * dbx;
+  int64_t dot   = (int64_t)dax * dbx + (int64_t)day * dby;
+
+  // Straight on, the offsets meet
+  if ((cross == 0) && (dot > 0)) { edgeTo(x + ax, y + ay); return; }
+
+  // On the inside of the turn the offsets cross at p + a + t * da = p + b + u * db. Where that is within the last
+  // half of the last line and the first half of the next the outline cuts the corner there, otherwise it goes
+  // through the corner, which keeps the winding the same but leaves a loop wound twice that the cells would count
+  // twice in the pixels around it
+  if ((int64_t)dbx * ax + (int64_t)dby * ay > 0) {
+    int64_t ex = bx - ax, ey = by - ay;
+    int64_t nt = ex * dby - ey * dbx, nu = ex * day - ey * dax, c = cross;
+    if (c < 0) { nt = -nt; nu = -nu; c = -c; }
+    if ((c > 0) && (2 * nt >= -c) && (nt <= 0) && (2 * nu <= c) && (nu >= 0)) {
+      edgeTo(x + ax + (int32_t)pathDiv(dax * nt, c), y + ay + (int32_t)pathDiv(day * nt, c));
+      return;
+    }
+    edgeTo(x + ax, y + ay);
+    edgeTo(x, y);
+    edgeTo(x + bx, y + by);
+    return;
+  }
+
+  if (_join == TFT_JOIN_ROUND) { arc(x, y, ax, ay, bx, by); return; }
+
+  // The miter tip is (a + b) * hw^2 / (hw^2 + a.b), its length is within the limit if (hw^2 + a.b) * limit^2 >= 2 * hw^2
+  int64_t hw2 = (int64_t)_hw * _hw;
+  int64_t k   = hw2 + (int64_t)ax * bx + (int64_t)ay * by;
+  if ((_join == TFT_JOIN_MITER) && (k * TFT_PATH_MITER_LIMIT * TFT_PATH_MITER_LIMIT >= 2 * hw2)) {
+    int64_t r = (hw2 << 16) / k;
+    edgeTo(x + (int32_t)pathDiv((ax + bx) * r, 65536), y + (int32_t)pathDiv((ay + by) * r, 65536));
+    return;
+  }
+
+  edgeTo(x + ax, y + ay);
+  edgeTo(x + bx, y + by);
+}
+
+// Add the outline of one side of a subpath of m points, walking it forwards or in reverse
+// An open subpath ends with the end at its last point, a closed one is a contour of its own
+void TFT_ePath::strokeSide(const tft_path_point *p, uint32_t m, bool reverse, bool closed) {
+  auto q = [&](uint32_t k) -> const tft_path_point & {
+    k %= m;
+    return p[reverse ? m - 1 - k : k];
+  };
+
+  int32_t nx, ny, dx, dy;
+  int32_t pnx = 0, pny = 0, pdx = 0, pdy = 0;
+
+  if (closed) {
+    pdx = q(0).x - q(m - 1).x;
+    pdy = q(0).y - q(m - 1).y;
+    pathNormal(pdx, pdy, _hw, pnx, pny);
+  }
+
+  uint32_t segs = closed ? m : m - 1;
+  for (uint32_t k = 0; k < segs; k++) {
+    const tft_path_point &a = q(k), &b = q(k + 1);
+    dx = b.x - a.x;
+    dy = b.y - a.y;
+    pathNormal(dx, dy, _hw, nx, ny);
+
+    if ((k == 0) && !closed) edgeTo(a.x + nx, a.y + ny);
+    else join(a.x, a.y, pnx, pny, nx, ny, pdx, pdy, dx, dy);
+
+    pnx = nx; pny = ny;
+    pdx = dx; pdy = dy;
+  }
+
+  if (closed) { edgeClose(); return; }
+
+  const tft_path_point &e = q(m - 1);
+  edgeTo(e.x + pnx, e.y + pny);
+  if (_join == TFT_JOIN_ROUND) arc(e.x, e.y, pnx, pny, -pnx, -pny);
+}
+
+// Draw the path as lines, each subpath is outlined by its two sides and the outline filled by the non-zero rule
+void TFT_ePath::stroke(TFT_eSPI *tft, float width, uint32_t color, uint8_t join, uint32_t bg_color) {
+  _hw = pathFixed(width / 2.0f);
+  if (_hw <= 0) return;
+  _join = join;
+
+  // Round joins step by the angle whose chord stays within the tolerance, hw * t^2 / 8
+  int64_t t = pathSqrt(((uint64_t)8 * TFT_PATH_TOLERANCE << 32) / _hw);
+  t = std::min<int64_t>(std::max<int64_t>(t, 205887 / TFT_PATH_MAX_STEPS), 51472);  // pi / steps to pi / 4
+  int64_t t2 = t * t >> 16;
+  _arcCos = 65536 - t2 / 2 + (t2 * t2 >> 16) / 24;
+  _arcSin = t - (t * t2 >> 16) / 6 + ((t * t2 >> 16) * t2 >> 16) / 120;
+
+  _edgeCount = 0;
+  _contour   = false;
+
+  for (uint32_t i = 0; i < _count; ) {
+    uint32_t j = i + 1;
+    while ((j < _count) && !(_points[j].flags & TFT_PATH_MOVE)) j++;
+
+    const tft_path_point *p = _points + i;
+    uint32_t m = j - i;
+    bool closed = _points[j - 1].flags & TFT_PATH_CLOSE;
+    if (closed && (m > 2) && (p[m - 1].x == p[0].x) && (p[m - 1].y == p[0].y)) m--;
+
+    if ((m >= 3) && closed) {
+      strokeSide(p, m, false, true);
+      strokeSide(p, m, true, true);
+    }
+    else if (m >= 2) {
+      strokeSide(p, m, false, false);
+      strokeSide(p, m, true, false);
+      edgeClose();
+    }
+    i = j;
+  }
+
+  raster(tft, TFT_FILL_NON_ZERO, color, bg_color);
+}
+
+// Fill the path
+void TFT_ePath::fill(TFT_eSPI *tft, uint32_t color, uint8_t rule, uint32_t bg_color) {
+  _edgeCount = 0;
+  _contour   = false;
+
+  for (uint32_t i = 0; i < _count; i++) {
+    if (_points[i].flags & TFT_PATH_MOVE) edgeClose();
+    edgeTo(_points[i].x, _points[i].y);
+  }
+  edgeClose();
+
+  raster(tft, rule, color, bg_color);
+}
+
+// Add the part of an edge within one pixel row to the cells, x is relative to the first pixel and y to the top
+// of the row, cell 0 holds the cover of everything left of the first pixel
+// Each cell gets the height the edge crosses it by and twice the area to the left of the edge times the height
+static void pathCells(int32_t *cover, int32_t *area, int32_t w, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+  if (y1 == y2) return;
+
+  // The part left of the first pixel only adds cover, the part right of the last pixel is not drawn
+  if ((x1 < 0) || (x2 < 0)) {
+    if ((x1 < 0) && (x2 < 0)) { cover[0] += y2 - y1; return; }
+    int32_t ym = y1 + pathDiv((int64_t)(0 - x1) * (y2 - y1), x2 - x1);
+    if (x1 < 0) { cover[0] += ym - y1; x1 = 0; y1 = ym; }
+    else        { cover[0] += y2 - ym; x2 = 0; y2 = ym; }
+  }
+  int32_t right = w << 8;
+  if ((x1 > right) || (x2 > right)) {
+    if ((x1 > right) && (x2 > right)) return;
+    int32_t ym = y1 + pathDiv((int64_t)(right - x1) * (y2 - y1), x2 - x1);
+    if (x1 > right) { x1 = right; y1 = ym; }
+    else            { x2 = right; y2 = ym; }
+  }
+
+  int32_t dx = x2 - x1, dy = y2 - y1;
+  int32_t x = x1, y = y1, ex = x1 >> 8;
+
+  // Walk the cells the edge crosses, splitting it where it crosses a pixel boundary
+  while (true) {
+    int32_t cx = ex << 8;
+    int32_t bx = (dx > 0) ? cx + 256 : cx;
+    if ((dx == 0) || ((dx > 0) ? (x2 <= bx) : (x2 >= bx))) {
+      cover[ex + 1] += y2 - y;
+      area[ex + 1]  += (y2 - y) * ((x - cx) + (x2 - cx));
+      return;
+    }
+
+    int32_t ny = y1 + pathDiv((int64_t)(bx - x1) * dy, dx);
+    cover[ex + 1] += ny - y;
+    area[ex + 1]  += (ny - y) * ((x - cx) + (bx - cx));
+    x = bx;
+    y = ny;
+    ex += (dx > 0) ? 1 : -1;
+  }
+}
+
+// Draw one row of coverage, fully covered runs as lines and partly covered runs blended
+static void pathRow(TFT_eSPI *tft, int32_t x0, int32_t y, const uint8_t *alpha, int32_t n, uint16_t color, uint32_t bg_color) {
+  uint16_t line[TFT_PATH_SPAN];
+  bool swap = tft->getSwapBytes();
+
+  for (int32_t i = 0; i < n; ) {
+    if (alpha[i] == 0) { i++; continue; }
+
+    int32_t j = i + 1;
+    if (alpha[i] == 255) {
+      while ((j < n) && (alpha[j] == 255)) j++;
+      tft->drawFastHLine(x0 + i, y, j - i, color);
+    }
+    else {
+      while ((j < n) && (j - i < TFT_PATH_SPAN) && (alpha[j] != 0) && (alpha[j] != 255)) j++;
+
+      // The background under the run is read in one transaction if no color was given
+      if (bg_color == 0x00FFFFFF) tft->readRect(x0 + i, y, j - i, 1, line);
+      else for (int32_t k = 0; k < j - i; k++) line[k] = bg_color;
+
+      tft->alphaBlendRow(alpha + i, color, line, line, j - i);
+      if (swap) for (int32_t k = 0; k < j - i; k++) line[k] = (uint16_t)(line[k] >> 8 | line[k] << 8);
+      tft->setWindow(x0 + i, y, x0 + j - 1, y);
+      tft->pushColors(line, j - i);
+    }
+    i = j;
+  }
+}
+
+// Rasterize the outline a row at a time, the edges crossing each row add their cover and area to a row of cells
+// and a sweep from the left turns the running cover into the coverage of each pixel
+void TFT_ePath::raster(TFT_eSPI *tft, uint8_t rule, uint16_t color, uint32_t bg_color) {
+  if (_edgeCount == 0) return;
+
+  int32_t minX = INT32_MAX, maxX = INT32_MIN, minY = INT32_MAX, maxY = INT32_MIN;
+  for (uint32_t i = 0; i < _edgeCount; i++) {
+    const tft_path_edge &e = _edges[i];
+    minX = std::min(minX, std::min(e.x0, e.x1));
+    maxX = std::max(maxX, std::max(e.x0, e.x1));
+    minY = std::min(minY, std::min(e.y0, e.y1));
+    maxY = std::max(maxY, std::max(e.y0, e.y1));
+  }
+
+  int32_t xl = std::max<int32_t>(pathFloorDiv(minX, 256), 0);
+  int32_t xr = std::min<int32_t>(pathFloorDiv(maxX, 256), tft->width() - 1);
+  int32_t yt = std::max<int32_t>(pathFloorDiv(minY, 256), 0);
+  int32_t yb = std::min<int32_t>(pathFloorDiv(maxY - 1, 256), tft->height() - 1);
+  if ((xl > xr) || (yt > yb)) return;
+
+  int32_t w = xr - xl + 1;
+  int32_t *cover = (int32_t *)malloc((w + 2) * 2 * sizeof(int32_t) + w);
+  if (cover == nullptr) { _overflow = true; return; }
+  int32_t *area  = cover + w + 2;
+  uint8_t *alpha = (uint8_t *)(area + w + 2);
+
+  // Active edges are kept at the start of the array, [0, na), the edges still to start follow
+  std::sort(_edges, _edges + _edgeCount, [](const tft_path_edge &a, const tft_path_edge &b) {
+    return std::min(a.y0, a.y1) < std::min(b.y0, b.y1);
+  });
+
+  tft->startWrite();
+
+  uint32_t na = 0, next = 0;
+  for (int32_t y = yt; y <= yb; y++) {
+    int32_t top = y << 8, bot = top + 256;
+
+    for (uint32_t i = 0; i < na; ) {
+      if (std::max(_edges[i].y0, _edges[i].y1) <= top) _edges[i] = _edges[--na];
+      else i++;
+    }
+    while ((next < _edgeCount) && (std::min(_edges[next].y0, _edges[next].y1) < bot)) {
+      tft_path_edge e = _edges[next++];
+      if (std::max(e.y0, e.y1) > top) _edges[na++] = e;
+    }
+
+    memset(cover, 0, (w + 2) * 2 * sizeof(int32_t));
+
+    for (uint32_t i = 0; i < na; i++) {
+      const tft_path_edge &e = _edges[i];
+      int32_t ya = std::max(top, std::min(e.y0, e.y1));
+      int32_t yz = std::min(bot, std::max(e.y0, e.y1));
+      if (ya >= yz) continue;
+
+      int64_t dx = e.x1 - e.x0, dy = e.y1 - e.y0;
+      int32_t xa = e.x0 + pathDiv((ya - e.y0) * dx, dy);
+      int32_t xz = e.x0 + pathDiv((yz - e.y0) * dx, dy);
+
+      // Keep the direction of the edge, downward edges add cover and upward ones take it away
+      int32_t ox = xl << 8;
+      if (e.y0 < e.y1) pathCells(cover, area, w, xa - ox, ya - top, xz - ox, yz - top);
+      else             pathCells(cover, area, w, xz - ox, yz - top, xa - ox, ya - top);
+    }
+
+    // A fully covered pixel sums to 2 * 256 * 256, the even-odd rule folds the winding back into range
+    int32_t acc = cover[0];
+    for (int32_t i = 0; i < w; i++) {
+      acc += cover[i + 1];
+      int32_t v = acc * 512 - area[i + 1];
+      if (v < 0) v = -v;
+      if (rule == TFT_FILL_NON_ZERO) v = std::min<int32_t>(v, 131072);
+      else {
+        v &= 262143;
+        if (v > 131072) v = 262144 - v;
+      }
+      int32_t c = v >> 9;
+      alpha[i] = (c <= TFT_AA_LOW) ? 0 : (c >= TFT_AA_HIGH) ? 255 : c;
+    }
+
+    pathRow(tft, xl, y, alpha, w, color, bg_color);
+  }
+
+  tft->endWrite();
+
+  free(cover);
+}
@@ -0,0 +1,109 @@
+#ifndef _TFT_eSPI_PATH_H_
+#define _TFT_eSPI_PATH_H_
+
+#include <stdint.h>
+#include "TFT_eSPI.h"
+
+// Most points a path holds once its curves are flattened, overflow() is set if more are added
+#ifndef TFT_PATH_POINTS
+#define TFT_PATH_POINTS 256
+#endif
+
+// Largest distance between a curve and the lines it is flattened to, in 1/256ths of a pixel
+#define TFT_PATH_TOLERANCE 16
+
+// Most lines a curve, or half a turn of a round join, is flattened to
+#define TFT_PATH_MAX_STEPS 64
+
+// Joins between the lines of a stroke, round also gives open subpaths round ends, the others give butt ends
+#define TFT_JOIN_MITER 0
+#define TFT_JOIN_ROUND 1
+#define TFT_JOIN_BEVEL 2
+
+// Miter joins reaching further than this many half widths from the corner are drawn as bevels
+#define TFT_PATH_MITER_LIMIT 4
+
+// Most partly covered pixels blended per background read
+#define TFT_PATH_SPAN 64
+
+// Path point in 1/256ths of a pixel, flags mark the first point of a subpath and the last point of a closed one
+struct tft_path_point {
+  int32_t x, y;
+  uint8_t flags;
+};
+
+// Outline edge in 1/256ths of a pixel, in the direction it was added
+struct tft_path_edge {
+  int32_t x0, y0, x1, y1;
+};
+
+// Path of lines and Bezier curves drawn anti-aliased on a TFT_eSPI, or on any class derived from it
+// Curves are flattened in fixed point as they are added, into as many lines as their curvature needs
+// stroke() and fill() build one outline for the whole path and rasterize it with exact area coverage per
+// pixel, so overlaps and joints are blended once, fully covered runs are drawn with drawFastHLine()
+class TFT_ePath
+{
+ public:
+  TFT_ePath(void);
+  ~TFT_ePath(void);
+
+  // Remove all subpaths
+  void clear(void);
+
+  // Start a subpath, pixel centres are on whole numbers and coordinates are limited to +/-8191
+  void moveTo(float x, float y);
+
+  // Add a line, a quadratic Bezier curve with control point c, or a cubic with control points c1 and c2
+  void lineTo(float x, float y);
+  void quadTo(float cx, float cy, float x, float y);
+  void cubicTo(float c1x, float c1y, float c2x, float c2y, float x, float y);
+
+  // Close the subpath with a line back to its start, a following lineTo() starts a new subpath there
+  void close(void);
+
+  // Draw the path as lines width pixels wide
+  // Edge pixels are blended with bg_color, or with the screen read back a run at a time if it is 0x00FFFFFF
+  void stroke(TFT_eSPI *tft, float width, uint32_t color, uint8_t join = TFT_JOIN_ROUND, uint32_t bg_color = 0x00FFFFFF);
+
+  // Fill the path by the even-odd or non-zero rule, open subpaths are closed
+  void fill(TFT_eSPI *tft, uint32_t color, uint8_t rule = TFT_FILL_NON_ZERO, uint32_t bg_color = 0x00FFFFFF);
+
+  // Number of points held, and whether points or outline edges were dropped for lack of memory
+  uint32_t size(void) { return _count; }
+  bool overflow(void) { return _overflow; }
+
+ private:
+  void addPoint(int32_t x, int32_t y, uint8_t flags);
+  void lineToFixed(int32_t x, int32_t y);
+
+  // Outline building, edgeTo() starts a contour if none is open
+  void edgeTo(int32_t x, int32_t y);
+  void edgeClose(void);
+  void strokeSide(const tft_path_point *p, uint32_t m, bool reverse, bool closed);
+  void join(int32_t x, int32_t y, int32_t ax, int32_t ay, int32_t bx, int32_t by, int32_t dax, int32_t day, int32_t dbx, int32_t dby);
+  void arc(int32_t x, int32_t y, int32_t ax, int32_t ay, int32_t bx, int32_t by);
+  void raster(TFT_eSPI *tft, uint8_t rule, uint16_t color, uint32_t bg_color);
+
+  tft_path_point _points[TFT_PATH_POINTS];
+  uint32_t _count;
+  bool     _overflow;
+
+  // Current point, start of the current subpath, and whether a subpath is open
+  int32_t  _cx, _cy, _sx, _sy;
+  bool     _open;
+
+  // Outline edges, kept allocated between calls
+  tft_path_edge *_edges;
+  uint32_t _edgeCount, _edgeCap;
+
+  // Contour being built, its first and last points
+  bool     _contour;
+  int32_t  _fx, _fy, _px, _py;
+
+  // Stroke settings, the half width and the step of round joins as a rotation in 1/65536ths
+  int32_t  _hw;
+  uint8_t  _join;
+  int32_t  _arcCos, _arcSin;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "Pipeline.h"
+#include "pico/multicore.h"
+
+// Pipeline run by core 1, multicore_launch_core1() takes no argument
+static TFT_eSPI_Pipeline *core1Pipeline = nullptr;
+
+TFT_eSPI_Pipeline::TFT_eSPI_Pipeline(void) : _fenceDone(0) {
+  _tft       = nullptr;
+  _fenceSeq  = 0;
+  _overflows = 0;
+  _highWater = 0;
+}
+
+// Start core 1
+void TFT_eSPI_Pipeline::begin(TFT_eSPI *tft) {
+  _tft = tft;
+  core1Pipeline = this;
+  multicore_launch_core1(core1Entry);
+}
+
+// Core 1 main loop
+void TFT_eSPI_Pipeline::core1Entry(void) {
+  while (true) {
+    core1Pipeline->poll();
+    tight_loop_contents();
+  }
+}
+
+// Run the queued commands, the display transaction is held while the ring has work
+void TFT_eSPI_Pipeline::poll(void) {
+  tft_cmd c;
+  if (!_ring.pop(c)) return;
+
+  _tft->startWrite();
+  do {
+    uint32_t seq = tft_cmd_run(*_tft, c);
+    if (seq) {
+      _tft->endWrite();  // Everything before the fence has left the staging buffer
+      _tft->dmaWait();
+      _fenceDone.store(seq, std::memory_order_release);
+      _tft->startWrite();
+    }
+  } while (_ring.pop(c));
+  _tft->endWrite();
+}
+
+// Queue a command, waiting for core 1 to make space if the ring is full
+void TFT_eSPI_Pipeline::put(const tft_cmd &c) {
+  if (!_ring.push(c)) {
+    _overflows++;
+    while (!_ring.push(c)) tight_loop_contents();
+  }
+
+  uint32_t n = _ring.size();
+  if (n > _highWater) _highWater = n;
+}
+
+// Queue a single pixel
+void TFT_eSPI_Pipeline::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  put(tft_cmd_pixel(x, y, color));
+}
+
+// Queue a filled rectangle
+void TFT_eSPI_Pipeline::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  put(tft_cmd_fill_rect(x, y, w, h, color));
+}
+
+// Queue a fill of the whole screen, large coordinates are clipped by fillRect() on core 1
+void TFT_eSPI_Pipeline::fillScreen(uint32_t color) {
+  put(tft_cmd_fill_rect(0, 0, INT16_MAX, INT16_MAX, color));
+}
+
+// Queue a horizontal line
+void TFT_eSPI_Pipeline::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  put(tft_cmd_hline(x, y, w, color));
+}
+
+// Queue a vertical line
+void TFT_eSPI_Pipeline::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  put(tft_cmd_vline(x, y, h, color));
+}
+
+// Queue a rotation change
+void TFT_eSPI_Pipeline::setRotation(uint8_t r) {
+  put(tft_cmd_rotation(r));
+}
+
+// Queue an image push
+void TFT_eSPI_Pipeline::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+  if ((w < 1) || (h < 1)) return;
+  put(tft_cmd_push_image(x, y, w, h, data));
+}
+
+// Queue a fence, sequence numbers start at 1 so 0 never matches
+uint32_t TFT_eSPI_Pipeline::fence(void) {
+  if (++_fenceSeq == 0) _fenceSeq = 1;
+  put(tft_cmd_fence(_fenceSeq));
+  return _fenceSeq;
+}
+
+// Check if core 1 has reached a fence, wrap around safe for fences less than 2^31 apart
+bool TFT_eSPI_Pipeline::fenceDone(uint32_t seq) {
+  return (int32_t)(_fenceDone.load(std::memory_order_acquire) - seq) >= 0;
+}
+
+// Wait until core 1 has sent everything queued so far
+void TFT_eSPI_Pipeline::flush(void) {
+  uint32_t seq = fence();
+  while (!fenceDone(seq)) tight_loop_contents();
+}
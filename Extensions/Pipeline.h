@@ -0,0 +1,56 @@
+#ifndef _TFT_eSPI_PIPELINE_H_
+#define _TFT_eSPI_PIPELINE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include "TFT_eSPI.h"
+#include "Ring.h"
+
+// Optional mode where core 0 queues draw calls and core 1 sends them to the display
+// Once begin() has been called the display must only be drawn through the pipeline
+class TFT_eSPI_Pipeline
+{
+ public:
+  TFT_eSPI_Pipeline(void);
+
+  // Start core 1 sending commands to tft, the display must already have had begin() called
+  void begin(TFT_eSPI *tft);
+
+  // Queue draw calls, these wait for space when the ring is full
+  void drawPixel(int32_t x, int32_t y, uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void fillScreen(uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void setRotation(uint8_t r);
+
+  // Queue a push of a w x h image, data must not change until a fence issued after it has completed
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+
+  // Queue a fence and return its sequence number, fenceDone() is true once everything before it has been sent
+  uint32_t fence(void);
+  bool fenceDone(uint32_t seq);
+
+  // Wait until everything queued so far has been sent
+  void flush(void);
+
+  // Number of times a draw call found the ring full and had to wait, and the most commands seen queued
+  uint32_t overflows(void) { return _overflows; }
+  uint32_t highWater(void) { return _highWater; }
+
+  // Run commands until the ring is empty, called in a loop on core 1
+  void poll(void);
+
+ private:
+  void put(const tft_cmd &c);
+  static void core1Entry(void);
+
+  TFT_eSPI *_tft;
+  TFT_eSPI_Ring _ring;
+
+  uint32_t _fenceSeq;                 // Last fence issued by core 0
+  std::atomic<uint32_t> _fenceDone;   // Last fence reached by core 1
+  uint32_t _overflows, _highWater;
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include "Region.h"
+#include <algorithm>
+
+// Operations applied to each band by combine()
+#define TFT_REGION_UNION     0
+#define TFT_REGION_SUBTRACT  1
+#define TFT_REGION_INTERSECT 2
+
+// Clamp a coordinate to the range the rectangles hold
+static int16_t regionClamp(int32_t v) {
+  return (int16_t)std::min<int32_t>(std::max<int32_t>(v, INT16_MIN), INT16_MAX);
+}
+
+// Left and right edges of the rectangles of r on row y, as pairs in x, returns the number of pairs
+static uint16_t regionSpans(const TFT_eRegion &r, int32_t y, int16_t *x) {
+  const tft_region_rect *p;
+  uint16_t n = r.row(y, &p);
+  for (uint16_t i = 0; i < n; i++) { x[2 * i] = p[i].x0; x[2 * i + 1] = p[i].x1; }
+  return n;
+}
+
+// Combine two sorted lists of spans, each edge toggles whether its list covers the pixels right of it
+// so the result changes only at an edge of either list, returns the number of spans written to out
+static uint16_t regionOp(const int16_t *a, uint16_t na, const int16_t *b, uint16_t nb, uint8_t op, int16_t *out) {
+  uint16_t ia = 0, ib = 0, no = 0;
+  bool inA = false, inB = false, inOut = false;
+
+  na *= 2;
+  nb *= 2;
+  while ((ia < na) || (ib < nb)) {
+    int16_t x = (ib == nb) ? a[ia] : (ia == na) ? b[ib] : std::min(a[ia], b[ib]);
+    while ((ia < na) && (a[ia] == x)) { inA = !inA; ia++; }
+    while ((ib < nb) && (b[ib] == x)) { inB = !inB; ib++; }
+
+    bool in = (op == TFT_REGION_UNION)    ? (inA || inB)
+            : (op == TFT_REGION_SUBTRACT) ? (inA && !inB)
+            :                               (inA && inB);
+    if (in == inOut) continue;
+
+    if (in) out[2 * no] = x;
+    else out[2 * no++ + 1] = x;
+    inOut = in;
+  }
+
+  return no;
+}
+
+TFT_eRegion::TFT_eRegion(void) {
+  _count = 0;
+}
+
+TFT_eRegion::TFT_eRegion(int32_t x, int32_t y, int32_t w, int32_t h) {
+  set(x, y, w, h);
+}
+
+// Make the region empty
+void TFT_eRegion::clear(void) {
+  _count = 0;
+}
+
+// Make the region a single rectangle
+void TFT_eRegion::set(int32_t x, int32_t y, int32_t w, int32_t h) {
+  tft_region_rect r = { regionClamp(x), regionClamp(y), regionClamp(x + w), regionClamp(y + h) };
+
+  _count = 0;
+  if ((r.x0 < r.x1) && (r.y0 < r.y1)) _rects[_count++] = r;
+}
+
+// Add the pixels of another region
+bool TFT_eRegion::unite(const TFT_eRegion &r) {
+  return combine(r, TFT_REGION_UNION);
+}
+
+// Remove the pixels of another region
+bool TFT_eRegion::subtract(const TFT_eRegion &r) {
+  return combine(r, TFT_REGION_SUBTRACT);
+}
+
+// Keep only the pixels also in another region
+bool TFT_eRegion::intersect(const TFT_eRegion &r) {
+  return combine(r, TFT_REGION_INTERSECT);
+}
+
+// Add the pixels of a rectangle
+bool TFT_eRegion::unite(int32_t x, int32_t y, int32_t w, int32_t h) {
+  return combine(TFT_eRegion(x, y, w, h), TFT_REGION_UNION);
+}
+
+// Remove the pixels of a rectangle
+bool TFT_eRegion::subtract(int32_t x, int32_t y, int32_t w, int32_t h) {
+  return combine(TFT_eRegion(x, y, w, h), TFT_REGION_SUBTRACT);
+}
+
+// Keep only the pixels also in a rectangle
+bool TFT_eRegion::intersect(int32_t x, int32_t y, int32_t w, int32_t h) {
+  return combine(TFT_eRegion(x, y, w, h), TFT_REGION_INTERSECT);
+}
+
+// Check if pixel x, y is in the region
+bool TFT_eRegion::contains(int32_t x, int32_t y) const {
+  const tft_region_rect *p;
+  uint16_t n = row(y, &p);
+  for (uint16_t i = 0; (i < n) && (p[i].x0 <= x); i++) {
+    if (x < p[i].x1) return true;
+  }
+  return false;
+}
+
+// Check the rectangles from the first band reaching row y until one overlaps or the bands pass the bottom edge
+bool TFT_eRegion::intersects(int32_t x, int32_t y, int32_t w, int32_t h) const {
+  if ((w < 1) || (h < 1)) return false;
+
+  for (uint16_t i = find(y); (i < _count) && (_rects[i].y0 < y + h); i++) {
+    if ((_rects[i].x0 < x + w) && (x < _rects[i].x1)) return true;
+  }
+  return false;
+}
+
+// Binary search for the first rectangle ending below row y, bands are sorted so their ends are too
+uint16_t TFT_eRegion::find(int32_t y) const {
+  uint16_t lo = 0, hi = _count;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (_rects[mid].y1 > y) hi = mid;
+    else lo = mid + 1;
+  }
+  return lo;
+}
+
+// Find the band holding row y, the rectangles of a band are next to each other
+uint16_t TFT_eRegion::row(int32_t y, const tft_region_rect **first) const {
+  uint16_t i = find(y);
+  *first = _rects + i;
+  if ((i == _count) || (_rects[i].y0 > y)) return 0;
+
+  uint16_t n = 1;
+  while ((i + n < _count) && (_rects[i + n].y0 == _rects[i].y0)) n++;
+  return n;
+}
+
+// Combine with another region band by band, the bands of the result are cut at every top and bottom edge
+// of either region, so neither changes within one. A band whose spans match the band just above is merged
+// into it, which keeps the result in the one banded form
+bool TFT_eRegion::combine(const TFT_eRegion &r, uint8_t op) {
+  int16_t ys[4 * TFT_REGION_RECTS];
+  uint16_t ny = 0;
+  for (uint16_t i = 0; i < _count; i++) { ys[ny++] = _rects[i].y0; ys[ny++] = _rects[i].y1; }
+  for (uint16_t i = 0; i < r._count; i++) { ys[ny++] = r._rects[i].y0; ys[ny++] = r._rects[i].y1; }
+  std::sort(ys, ys + ny);
+  ny = std::unique(ys, ys + ny) - ys;
+
+  TFT_eRegion out;
+  uint16_t last = 0, lastCount = 0;  // Band added last and its number of rectangles
+
+  for (uint16_t k = 0; k + 1 < ny; k++) {
+    int16_t a[2 * TFT_REGION_RECTS], b[2 * TFT_REGION_RECTS], x[4 * TFT_REGION_RECTS];
+    uint16_t na = regionSpans(*this, ys[k], a);
+    uint16_t nb = regionSpans(r, ys[k], b);
+    uint16_t n  = regionOp(a, na, b, nb, op, x);
+    if (n == 0) continue;
+
+    // Extend the band above if it ends here with the same spans
+    bool same = lastCount && (lastCount == n) && (out._rects[last].y1 == ys[k]);
+    for (uint16_t i = 0; same && (i < n); i++) {
+      same = (out._rects[last + i].x0 == x[2 * i]) && (out._rects[last + i].x1 == x[2 * i + 1]);
+    }
+
+    if (same) {
+      for (uint16_t i = 0; i < n; i++) out._rects[last + i].y1 = ys[k + 1];
+      continue;
+    }
+
+    if (out._count + n > TFT_REGION_RECTS) return false;
+
+    last = out._count;
+    lastCount = n;
+    for (uint16_t i = 0; i < n; i++) out._rects[out._count++] = { x[2 * i], ys[k], x[2 * i + 1], ys[k + 1] };
+  }
+
+  *this = out;
+  return true;
+}
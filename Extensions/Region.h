@@ -0,0 +1,63 @@
+#ifndef _TFT_eSPI_REGION_H_
+#define _TFT_eSPI_REGION_H_
+
+#include <stdint.h>
+
+// Most rectangles a region holds, operations whose result needs more fail and leave the region unchanged
+#ifndef TFT_REGION_RECTS
+#define TFT_REGION_RECTS 32
+#endif
+
+// Region rectangle, x1 and y1 are one past the right and bottom edges
+struct tft_region_rect {
+  int16_t x0, y0, x1, y1;
+};
+
+// Set of pixels held as disjoint rectangles, used as a clip region by TFT_eSPI::setClipRegion()
+// Rectangles are kept in bands: those sharing rows have the same y0 and y1 and are sorted left to right,
+// bands are sorted top to bottom and a band is merged into the one above if their rectangles match,
+// so each region has one form and a row is found by a binary search
+class TFT_eRegion
+{
+ public:
+  TFT_eRegion(void);
+  TFT_eRegion(int32_t x, int32_t y, int32_t w, int32_t h);
+
+  // Make the region empty, or a single rectangle
+  void clear(void);
+  void set(int32_t x, int32_t y, int32_t w, int32_t h);
+
+  // Combine with another region or a rectangle, returns false if the result would need more than
+  // TFT_REGION_RECTS rectangles, the region is then unchanged
+  bool unite(const TFT_eRegion &r);
+  bool subtract(const TFT_eRegion &r);
+  bool intersect(const TFT_eRegion &r);
+  bool unite(int32_t x, int32_t y, int32_t w, int32_t h);
+  bool subtract(int32_t x, int32_t y, int32_t w, int32_t h);
+  bool intersect(int32_t x, int32_t y, int32_t w, int32_t h);
+
+  // Whether the region holds no pixels, or holds pixel x, y
+  bool empty(void) const { return _count == 0; }
+  bool contains(int32_t x, int32_t y) const;
+
+  // Whether any pixel of a rectangle is in the region
+  bool intersects(int32_t x, int32_t y, int32_t w, int32_t h) const;
+
+  // Rectangles in band order
+  uint16_t count(void) const { return _count; }
+  const tft_region_rect *rects(void) const { return _rects; }
+
+  // Index of the first rectangle that ends below row y, count() if none do
+  uint16_t find(int32_t y) const;
+
+  // Rectangles of the band holding row y, returns how many and points first at the leftmost
+  uint16_t row(int32_t y, const tft_region_rect **first) const;
+
+ private:
+  bool combine(const TFT_eRegion &r, uint8_t op);
+
+  tft_region_rect _rects[TFT_REGION_RECTS];
+  uint16_t _count;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef _TFT_eSPI_RING_H_
+#define _TFT_eSPI_RING_H_
+
+// Command ring and codec used by TFT_eSPI_Pipeline to hand draw calls from core 0 to core 1
+// Only standard C++ is used here so the ring can be exercised on a host with std::thread
+
+#include <stdint.h>
+#include <atomic>
+
+// Number of commands the ring holds, must be a power of two
+#ifndef TFT_RING_SIZE
+#define TFT_RING_SIZE 64
+#endif
+
+// Draw call opcodes
+enum tft_cmd_op : uint8_t {
+  TFT_CMD_PIXEL,
+  TFT_CMD_FILL_RECT,
+  TFT_CMD_HLINE,
+  TFT_CMD_VLINE,
+  TFT_CMD_PUSH_IMAGE,
+  TFT_CMD_ROTATION,
+  TFT_CMD_FENCE
+};
+
+// An encoded draw call, data points at pixels owned by the caller and must stay valid until a later fence completes
+struct tft_cmd {
+  uint8_t  op;
+  int16_t  x, y, w, h;
+  uint32_t value;  // Color, rotation or fence sequence number
+  const void *data;
+};
+
+// Encode draw calls
+inline tft_cmd tft_cmd_pixel(int32_t x, int32_t y, uint32_t color) {
+  return tft_cmd{ TFT_CMD_PIXEL, (int16_t)x, (int16_t)y, 1, 1, color, nullptr };
+}
+
+inline tft_cmd tft_cmd_fill_rect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  return tft_cmd{ TFT_CMD_FILL_RECT, (int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h, color, nullptr };
+}
+
+inline tft_cmd tft_cmd_hline(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  return tft_cmd{ TFT_CMD_HLINE, (int16_t)x, (int16_t)y, (int16_t)w, 1, color, nullptr };
+}
+
+inline tft_cmd tft_cmd_vline(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  return tft_cmd{ TFT_CMD_VLINE, (int16_t)x, (int16_t)y, 1, (int16_t)h, color, nullptr };
+}
+
+inline tft_cmd tft_cmd_push_image(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+  return tft_cmd{ TFT_CMD_PUSH_IMAGE, (int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h, 0, data };
+}
+
+inline tft_cmd tft_cmd_rotation(uint8_t r) {
+  return tft_cmd{ TFT_CMD_ROTATION, 0, 0, 0, 0, r, nullptr };
+}
+
+inline tft_cmd tft_cmd_fence(uint32_t seq) {
+  return tft_cmd{ TFT_CMD_FENCE, 0, 0, 0, 0, seq, nullptr };
+}
+
+// Decode a command into calls on a display, T is TFT_eSPI on the target or a recording class on a host
+// Returns the sequence number for a fence, 0 otherwise
+template <class T> uint32_t tft_cmd_run(T &tft, const tft_cmd &c) {
+  switch (c.op) {
+    case TFT_CMD_PIXEL:
+      tft.drawPixel(c.x, c.y, c.value);
+      break;
+    case TFT_CMD_FILL_RECT:
+      tft.fillRect(c.x, c.y, c.w, c.h, c.value);
+      break;
+    case TFT_CMD_HLINE:
+      tft.drawFastHLine(c.x, c.y, c.w, c.value);
+      break;
+    case TFT_CMD_VLINE:
+      tft.drawFastVLine(c.x, c.y, c.h, c.value);
+      break;
+    case TFT_CMD_PUSH_IMAGE:
+      tft.setWindow(c.x, c.y, c.x + c.w - 1, c.y + c.h - 1);
+      tft.pushColors((uint16_t *)c.data, (uint32_t)c.w * c.h);
+      break;
+    case TFT_CMD_ROTATION:
+      tft.setRotation(c.value);
+      break;
+    case TFT_CMD_FENCE:
+      return c.value;
+  }
+  return 0;
+}
+
+// Lock-free ring with one producer and one consumer
+// The producer only writes _head and the consumer only writes _tail, each publishes with release ordering
+class TFT_eSPI_Ring
+{
+ public:
+  TFT_eSPI_Ring(void) : _head(0), _tail(0) {}
+
+  // Producer side, returns false if the ring is full
+  bool push(const tft_cmd &c) {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) == TFT_RING_SIZE) return false;
+
+    _buf[head & (TFT_RING_SIZE - 1)] = c;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side, returns false if the ring is empty
+  bool pop(tft_cmd &c) {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+
+    c = _buf[tail & (TFT_RING_SIZE - 1)];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Number of commands waiting, exact from either side and a snapshot otherwise
+  uint32_t size(void) const {
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+  }
+
+ private:
+  static_assert((TFT_RING_SIZE & (TFT_RING_SIZE - 1)) == 0, "TFT_RING_SIZE must be a power of two");
+
+  std::atomic<uint32_t> _head, _tail;  // Free running counts of commands pushed and popped
+  tft_cmd _buf[TFT_RING_SIZE];
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include "Terminal.h"
+#include <string.h>
+
+#ifndef PROGMEM
+  #define PROGMEM
+#endif
+#include "Fonts/glcdfont.c"
+
+TFT_eTerminal::TFT_eTerminal(TFT_eSPI *tft) {
+  _tft        = tft;
+  _top        = 0;
+  _lines      = 0;
+  _lineHeight = 8;
+  _charWidth  = 6;
+  _row        = 0;
+  _x          = 0;
+  _fg         = TFT_WHITE;
+  _bg         = TFT_BLACK;
+  _size       = 1;
+  memset(_lineLen, 0, sizeof(_lineLen));
+}
+
+// Set up the scrolling area for whole text lines
+bool TFT_eTerminal::begin(uint16_t top, uint16_t bottom, uint8_t size) {
+  if (size < 1) size = 1;
+  if (size > TFT_TERMINAL_MAX_SIZE) size = TFT_TERMINAL_MAX_SIZE;
+
+  _size       = size;
+  _lineHeight = 8 * size;
+  _charWidth  = 6 * size;
+  _top        = top;
+
+  uint16_t area = _tft->height() - top - bottom;
+  _lines = area / _lineHeight;
+  if (_lines > TFT_TERMINAL_MAX_LINES) _lines = TFT_TERMINAL_MAX_LINES;
+
+  // Rows that do not make a whole line join the bottom fixed area so lines never wrap in RAM
+  bool ok = _tft->setScrollArea(top, _tft->height() - top - _lines * _lineHeight);
+
+  clear();
+  return ok;
+}
+
+// Set the text colors
+void TFT_eTerminal::setTextColor(uint16_t fg, uint16_t bg) {
+  _fg = fg;
+  _bg = bg;
+}
+
+// Clear the text area
+void TFT_eTerminal::clear(void) {
+  _tft->fillRect(0, _top, _tft->width(), _lines * _lineHeight, _bg);
+  memset(_lineLen, 0, sizeof(_lineLen));
+  _row = 0;
+  _x   = 0;
+}
+
+// Move to the next line, once the area is full the oldest line is cleared and scrolled to the bottom
+void TFT_eTerminal::newLine(void) {
+  _x = 0;
+
+  if (_row + 1 < _lines) {
+    _row++;
+    return;
+  }
+
+  // The RAM rows of the top line are about to become the bottom line
+  int32_t y    = _tft->scrollRow(_top);
+  uint16_t slot = (y - _top) / _lineHeight;
+  if (_lineLen[slot]) _tft->fillRect(0, y, _lineLen[slot], _lineHeight, _bg);
+  _lineLen[slot] = 0;
+
+  _tft->scroll(_lineHeight);
+}
+
+// Draw a character cell at RAM position x, y
+void TFT_eTerminal::drawChar(int32_t x, int32_t y, uint8_t c) {
+  uint16_t line[6 * TFT_TERMINAL_MAX_SIZE];
+  uint16_t fg = _fg, bg = _bg;
+
+  // The row buffer is pushed as pixels so must match the byte order pushColors() expects
+  if (_tft->getSwapBytes()) {
+    fg = fg >> 8 | fg << 8;
+    bg = bg >> 8 | bg << 8;
+  }
+
+  _tft->startWrite();
+  _tft->setWindow(x, y, x + _charWidth - 1, y + _lineHeight - 1);
+
+  for (uint8_t row = 0; row < 8; row++) {
+    for (uint8_t col = 0; col < 6; col++) {
+      uint8_t bits = (col < 5) ? font[c * 5 + col] : 0;
+      uint16_t color = (bits >> row & 1) ? fg : bg;
+      for (uint8_t k = 0; k < _size; k++) line[col * _size + k] = color;
+    }
+    for (uint8_t k = 0; k < _size; k++) _tft->pushColors(line, _charWidth);
+  }
+
+  _tft->endWrite();
+}
+
+// Write a character
+size_t TFT_eTerminal::write(uint8_t c) {
+  if (_lines == 0) return 0;
+
+  if (c == '\n') { newLine(); return 1; }
+  if (c == '\r') { _x = 0;    return 1; }
+
+  if (_x + _charWidth > _tft->width()) newLine();
+
+  int32_t y = _tft->scrollRow(_top + _row * _lineHeight);
+  drawChar(_x, y, c);
+  _x += _charWidth;
+
+  uint16_t slot = (y - _top) / _lineHeight;
+  if (_x > _lineLen[slot]) _lineLen[slot] = _x;
+  return 1;
+}
+
+// Write a string
+size_t TFT_eTerminal::print(const char *str) {
+  size_t n = 0;
+  while (*str) n += write(*str++);
+  return n;
+}
+
+// Write a string and start a new line
+size_t TFT_eTerminal::println(const char *str) {
+  size_t n = print(str);
+  return n + write('\n');
+}
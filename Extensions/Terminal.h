@@ -0,0 +1,56 @@
+#ifndef _TFT_eSPI_TERMINAL_H_
+#define _TFT_eSPI_TERMINAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "TFT_eSPI.h"
+
+// Most text lines the terminal keeps track of, enough for 8 pixel lines on a 320 row screen
+#ifndef TFT_TERMINAL_MAX_LINES
+#define TFT_TERMINAL_MAX_LINES 40
+#endif
+
+// Largest text size, sets the size of the row buffer used to draw characters
+#define TFT_TERMINAL_MAX_SIZE 4
+
+// Scrolling text terminal using the display's hardware scrolling, each new line costs one scroll
+// command and the pixels of the line it replaces rather than a redraw of the screen
+// Text is drawn with the 5x7 GLCD font in 6x8 cells scaled by the text size, in rotation 0
+class TFT_eTerminal
+{
+ public:
+  TFT_eTerminal(TFT_eSPI *tft);
+
+  // Take the rows between the fixed areas for text and clear them
+  // The part of the area below the last whole text line is added to the bottom fixed area
+  // Returns false if the area holds no whole line or the display cannot scroll it, see TFT_eSPI::setScrollArea()
+  bool begin(uint16_t top = 0, uint16_t bottom = 0, uint8_t size = 1);
+
+  // Set the text colors, the background fills each character cell
+  void setTextColor(uint16_t fg, uint16_t bg);
+
+  // Write a character, '\n' starts a new line and '\r' returns to the start of the line
+  size_t write(uint8_t c);
+
+  // Write a string, and a string followed by a new line
+  size_t print(const char *str);
+  size_t println(const char *str);
+
+  // Clear the text area and return to the top line
+  void clear(void);
+
+ private:
+  void newLine(void);
+  void drawChar(int32_t x, int32_t y, uint8_t c);
+
+  TFT_eSPI *_tft;
+  uint16_t _top, _lines, _lineHeight, _charWidth;
+  uint16_t _row, _x;
+  uint16_t _fg, _bg;
+  uint8_t  _size;
+
+  // Width in pixels written to each RAM line slot, so a recycled line is only cleared as far as needed
+  uint16_t _lineLen[TFT_TERMINAL_MAX_LINES];
+};
+
+#endif
@@ -0,0 +1,77 @@
+// -------------------------------------------------- //
+// Assembled by hand from the source below            //
+// SPI with the DC level carried in the FIFO stream    //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// Source:
+//
+// .program tft_dc_io
+// .side_set 1                  ; SCLK
+// .wrap_target
+//     pull   block     side 0  ; Header: DC level in bit 31, number of bits - 1 in bits 30..0
+//     out    x, 1      side 0
+//     jmp    !x, dc_low side 0
+//     set    pins, 1   side 0
+//     jmp    bits      side 0
+// dc_low:
+//     set    pins, 0   side 0
+// bits:
+//     out    y, 31     side 0
+// bit_loop:
+//     out    pins, 1   side 0  ; Autopull every 16 bits, data is taken from bits 31..16 of each word
+//     jmp    y--, bit_loop side 1
+// .wrap
+
+//
+// Instruction words, as pioasm would encode them:
+//   bits 15..13 opcode: jmp 000, out 011, pull 100, set 111
+//   bit  12     side-set, the SCLK level, not optional so present on every instruction
+//   bits 11..8  delay, unused
+//   bits 7..0   operands:
+//     pull  bit 7 = 1 for pull, bit 6 IfEmpty = 0, bit 5 Block = 1
+//     out   bits 7..5 destination (pins 000, x 001, y 010), bits 4..0 bit count
+//     jmp   bits 7..5 condition (always 000, !x 001, y-- 100), bits 4..0 address from the start of the program
+//     set   bits 7..5 destination (pins 000), bits 4..0 value
+// pio_add_program() relocates the jmp addresses to where the program is loaded
+
+// --------- //
+// tft_dc_io //
+// --------- //
+
+#define tft_dc_io_wrap_target 0
+#define tft_dc_io_wrap 8
+
+static const uint16_t tft_dc_io_program_instructions[] = {
+            //     .wrap_target
+    0x80a0, //  0: pull   block           side 0
+    0x6021, //  1: out    x, 1            side 0
+    0x0025, //  2: jmp    !x, 5           side 0
+    0xe001, //  3: set    pins, 1         side 0
+    0x0006, //  4: jmp    6               side 0
+    0xe000, //  5: set    pins, 0         side 0
+    0x605f, //  6: out    y, 31           side 0
+    0x6001, //  7: out    pins, 1         side 0
+    0x1087, //  8: jmp    y--, 7          side 1
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program tft_dc_io_program = {
+    .instructions = tft_dc_io_program_instructions,
+    .length = 9,
+    .origin = -1,
+};
+
+static inline pio_sm_config tft_dc_io_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + tft_dc_io_wrap_target, offset + tft_dc_io_wrap);
+    sm_config_set_sideset(&c, 1, false, false);
+    return c;
+}
+#endif
@@ -0,0 +1,60 @@
+// This is the command sequence that initialises the GC9A01 driver
+//
+// This setup information is in the format accepted by the commandList() function:
+//   number of commands, then for each command:
+//   command, number of args (| TFT_INIT_DELAY if a delay follows), args..., [delay ms, 255 = 500 ms]
+//
+// See GC9A01_Init.h file for the same sequence as individual writecommand()/writedata() calls
+
+static constexpr uint8_t GC9A01_init_table[] = {
+  49,                         // 49 commands in list:
+  0xEF, 0,
+  0xEB, 1, 0x14,
+  0xFE, 0,
+  0xEF, 0,
+  0xEB, 1, 0x14,
+  0x84, 1, 0x40,
+  0x85, 1, 0xFF,
+  0x86, 1, 0xFF,
+  0x87, 1, 0xFF,
+  0x88, 1, 0x0A,
+  0x89, 1, 0x21,
+  0x8A, 1, 0x00,
+  0x8B, 1, 0x80,
+  0x8C, 1, 0x01,
+  0x8D, 1, 0x01,
+  0x8E, 1, 0xFF,
+  0x8F, 1, 0xFF,
+  0xB6, 2, 0x00, 0x20,
+  0x3A, 1, 0x05,              // 16-bit pixel format
+  0x90, 4, 0x08, 0x08, 0x08, 0x08,
+  0xBD, 1, 0x06,
+  0xBC, 1, 0x00,
+  0xFF, 3, 0x60, 0x01, 0x04,
+  0xC3, 1, 0x13,
+  0xC4, 1, 0x13,
+  0xC9, 1, 0x22,
+  0xBE, 1, 0x11,
+  0xE1, 2, 0x10, 0x0E,
+  0xDF, 3, 0x21, 0x0C, 0x02,
+  0xF0, 6, 0x45, 0x09, 0x08, 0x08, 0x26, 0x2A,
+  0xF1, 6, 0x43, 0x70, 0x72, 0x36, 0x37, 0x6F,
+  0xF2, 6, 0x45, 0x09, 0x08, 0x08, 0x26, 0x2A,
+  0xF3, 6, 0x43, 0x70, 0x72, 0x36, 0x37, 0x6F,
+  0xED, 2, 0x1B, 0x0B,
+  0xAE, 1, 0x77,
+  0xCD, 1, 0x63,
+  0x70, 9, 0x07, 0x07, 0x04, 0x0E, 0x0F, 0x09, 0x07, 0x08, 0x03,
+  0xE8, 1, 0x34,
+  0x62, 12, 0x18, 0x0D, 0x71, 0xED, 0x70, 0x70, 0x18, 0x0F, 0x71, 0xEF, 0x70, 0x70,
+  0x63, 12, 0x18, 0x11, 0x71, 0xF1, 0x70, 0x70, 0x18, 0x13, 0x71, 0xF3, 0x70, 0x70,
+  0x64, 7, 0x28, 0x29, 0xF1, 0x01, 0xF1, 0x00, 0x07,
+  0x66, 10, 0x3C, 0x00, 0xCD, 0x67, 0x45, 0x45, 0x10, 0x00, 0x00, 0x00,
+  0x67, 10, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x01, 0x54, 0x10, 0x32, 0x98,
+  0x74, 7, 0x10, 0x85, 0x80, 0x00, 0x00, 0x4E, 0x00,
+  0x98, 2, 0x3E, 0x07,
+  0x35, 0,                    // Tearing effect line on
+  0x21, 0,                    // Display inversion on
+  0x11, TFT_INIT_DELAY, 120,  // Sleep out, 120 ms delay
+  0x29, TFT_INIT_DELAY, 20,   // Display on, 20 ms delay
+};
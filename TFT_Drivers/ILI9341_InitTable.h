@@ -0,0 +1,36 @@
+// This is the command sequence that initialises the ILI9341 driver
+//
+// This setup information is in the format accepted by the commandList() function:
+//   number of commands, then for each command:
+//   command, number of args (| TFT_INIT_DELAY if a delay follows), args..., [delay ms, 255 = 500 ms]
+//
+// See ILI9341_Init.h file for the same sequence as individual writecommand()/writedata() calls
+
+static constexpr uint8_t ILI9341_init_table[] = {
+  21,                         // 21 commands in list:
+  0xEF, 3, 0x03, 0x80, 0x02,
+  0xCF, 3, 0x00, 0xC1, 0x30,
+  0xED, 4, 0x64, 0x03, 0x12, 0x81,
+  0xE8, 3, 0x85, 0x00, 0x78,
+  0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,
+  0xF7, 1, 0x20,
+  0xEA, 2, 0x00, 0x00,
+  0xC0, 1, 0x23,              // Power control, VRH[5:0]
+  0xC1, 1, 0x10,              // Power control, SAP[2:0];BT[3:0]
+  0xC5, 2, 0x3E, 0x28,        // VCM control
+  0xC7, 1, 0x86,              // VCM control2
+  0x36, 1, 0x48,              // Memory Access Control, rotation 0 (portrait mode), BGR
+  0x3A, 1, 0x55,              // 16-bit pixel format
+  0xB1, 2, 0x00, 0x13,        // Frame rate, 0x18 79Hz, 0x1B default 70Hz, 0x13 100Hz
+  0xB6, 3, 0x08, 0x82, 0x27,  // Display Function Control
+  0xF2, 1, 0x00,              // 3Gamma Function Disable
+  0x26, 1, 0x01,              // Gamma curve selected
+  0xE0, 15,                   // Set Gamma
+    0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, 0x4E, 0xF1,
+    0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00,
+  0xE1, 15,                   // Set Gamma
+    0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, 0x31, 0xC1,
+    0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F,
+  0x11, TFT_INIT_DELAY, 120,  // Exit Sleep, 120 ms delay
+  0x29, 0,                    // Display on
+};
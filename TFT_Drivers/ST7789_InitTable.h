@@ -0,0 +1,45 @@
+// This is the command sequence that initialises the ST7789 driver
+//
+// This setup information is in the format accepted by the commandList() function:
+//   number of commands, then for each command:
+//   command, number of args (| TFT_INIT_DELAY if a delay follows), args..., [delay ms, 255 = 500 ms]
+//
+// See ST7789_Init.h file for the same sequence as individual writecommand()/writedata() calls
+
+static constexpr uint8_t ST7789_init_table[] = {
+  21,                         // 21 commands in list:
+  0x11, TFT_INIT_DELAY, 120,  // Sleep out, 120 ms delay
+  0x13, 0,                    // Normal display mode on
+
+  //------------------------------display and color format setting--------------------------------//
+  0x36, 1, 0x00,              // Memory Access Control, RGB order
+  0xB6, 2, 0x0A, 0x82,        // JLX240 display datasheet
+  0xB0, 2, 0x00, 0xE0,        // RAM control, 5 to 6-bit conversion: r0 = r5, b0 = b5
+  0x3A, 1 | TFT_INIT_DELAY, 0x55, 10, // 16-bit pixel format, 10 ms delay
+
+  //--------------------------------ST7789V Frame rate setting----------------------------------//
+  0xB2, 5, 0x0C, 0x0C, 0x00, 0x33, 0x33, // Porch control
+  0xB7, 1, 0x35,              // Voltages: VGH / VGL
+
+  //---------------------------------ST7789V Power setting--------------------------------------//
+  0xBB, 1, 0x28,              // VCOMS, JLX240 display datasheet
+  0xC0, 1, 0x0C,              // LCM control
+  0xC2, 2, 0x01, 0xFF,        // VDV and VRH command enable
+  0xC3, 1, 0x10,              // Voltage VRHS
+  0xC4, 1, 0x20,              // VDV setting
+  0xC6, 1, 0x0F,              // FR Control 2
+  0xD0, 2, 0xA4, 0xA1,        // Power control 1
+
+  //--------------------------------ST7789V gamma setting---------------------------------------//
+  0xE0, 14,                   // Positive voltage gamma control
+    0xD0, 0x00, 0x02, 0x07, 0x0A, 0x28, 0x32,
+    0x44, 0x42, 0x06, 0x0E, 0x12, 0x14, 0x17,
+  0xE1, 14,                   // Negative voltage gamma control
+    0xD0, 0x00, 0x02, 0x07, 0x0A, 0x28, 0x31,
+    0x54, 0x47, 0x0E, 0x1C, 0x17, 0x1B, 0x1E,
+
+  0x21, 0,                    // Display inversion on
+  0x2A, 4, 0x00, 0x00, 0x00, 0xEF, // Column address set, 0 to 239
+  0x2B, 4 | TFT_INIT_DELAY, 0x00, 0x00, 0x01, 0x3F, 120, // Row address set, 0 to 319, 120 ms delay
+  0x29, TFT_INIT_DELAY, 120,  // Display on, 120 ms delay
+};
@@ -1,17 +1,135 @@
 #include "TFT_eSPI.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
 #include "pico/stdlib.h"
 
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+// Initialisation table for the selected display controller
+#if defined (ST7789_DRIVER)
+  #include "TFT_Drivers/ST7789_InitTable.h"
+  #define TFT_INIT_TABLE ST7789_init_table
+#elif defined (GC9A01_DRIVER)
+  #include "TFT_Drivers/GC9A01_InitTable.h"
+  #define TFT_INIT_TABLE GC9A01_init_table
+#else
+  #include "TFT_Drivers/ILI9341_InitTable.h"
+  #define TFT_INIT_TABLE ILI9341_init_table
+#endif
+
+// Depth of the RP2040 SPI (PL022) transmit FIFO in frames
+#define TFT_SPI_FIFO_DEPTH 8
+
+// Fills smaller than this are quicker to push from the CPU than to set up a DMA transfer
+#define TFT_DMA_MIN_PIXELS 64
+
+// Runs shorter than this are staged as bytes rather than sent as 16-bit frames
+#define TFT_SHORT_RUN 16
+
+// Number of pixels written and read back by each calibrateSPI() test, and passes needed per clock
+#define TFT_CAL_PIXELS 32
+#define TFT_CAL_PASSES 3
+
+// Number of points drawCircle() collects before handing them to drawPixels()
+#define TFT_PIXEL_BATCH 64
+
+// Polygons with up to this many edges are filled without allocating memory
+#define TFT_POLYGON_EDGES 32
+
+// Bytes sent to set a window (CASET, RASET and RAMWR with their parameters), counted against the flush budget
+// CASET and RASET are 5 bytes each and left out when the panel already has the range
+#define TFT_WINDOW_BYTES 11
+
+// Pixels pushImage24() converts per line buffer
+#define TFT_DITHER_SPAN 64
+
+// Pixels of an opaque bitmap expanded per line buffer, a multiple of 8 so whole bytes are expanded
+#define TFT_BITMAP_SPAN 64
+
+// Edge pixels of anti-aliased lines are blended in runs of up to this many, one background read per run
+#define TFT_AA_SPAN 64
+
+// Largest coordinate or radius accepted by drawWedgeLine(), keeps its fixed point products within 64 bits
+#define TFT_AA_LIMIT 8191
+
 // Constructor for hardware SPI
-TFT_eSPI::TFT_eSPI() {
-  _cs   = TFT_CS;
-  _dc   = TFT_DC;
-  _rst  = TFT_RST;
-  _mosi = TFT_MOSI;
-  _miso = TFT_MISO;
-  _sclk = TFT_SCLK;
-  _spi  = spi0;
+TFT_eSPI::TFT_eSPI() : TFT_eSPI(tft_bus_config TFT_BUS_CONFIG_DEFAULT) {
+}
+
+// Constructor for hardware SPI with clocks found by an earlier calibrateSPI()
+TFT_eSPI::TFT_eSPI(const tft_spi_clocks &clocks) : TFT_eSPI(tft_bus_config TFT_BUS_CONFIG_DEFAULT) {
+  _writeFreq = clocks.write_hz;
+  _readFreq  = clocks.read_hz;
+}
+
+// Constructor for a panel whose bus, pins and geometry are given at run time
+TFT_eSPI::TFT_eSPI(const tft_bus_config &config) {
+  _cs   = config.cs;
+  _dc   = config.dc;
+  _rst  = config.rst;
+  _mosi = config.mosi;
+  _miso = config.miso;
+  _sclk = config.sclk;
+  _bl   = config.backlight;
+  _spi  = config.spi ? spi1 : spi0;
+
+  _csMask = 1ul << _cs;
+  _dcMask = 1ul << _dc;
+
+  _writeFreq = config.write_hz;
+  _readFreq  = config.read_hz;
+
+  _initTable  = config.init_table ? config.init_table : TFT_INIT_TABLE;
+  _initWidth  = config.width;
+  _initHeight = config.height;
+  _colOffset  = config.col_offset;
+  _rowOffset  = config.row_offset;
+  _ramHeight  = config.ram_height ? config.ram_height : TFT_RAM_HEIGHT;
+
+  rotation = 0;
+  _width   = _initWidth;
+  _height  = _initHeight;
+  _xOffset = _colOffset;
+  _yOffset = _rowOffset;
+
+  _txLen   = 0;
+  _txDepth = 0;
+  _readyAt = 0;
+
+  addr_col = 0xFFFFFFFF;
+  addr_row = 0xFFFFFFFF;
+
+  _dmaChannel[0] = -1;
+  _dmaChannel[1] = -1;
+  _dmaTail    = -1;
+  _dmaEnabled = false;
+  _dmaActive  = false;
+  _swapBytes  = false;
+
+  _scrollTop    = 0;
+  _scrollBottom = 0;
+  _scrollOffset = 0;
+
+  _shadow      = nullptr;
+  _shadowOn    = false;
+  _shadowOwned = false;
+  _flushBudget = 0;
+  _flushRow    = 0;
+  memset(_dirty, 0, sizeof(_dirty));
+
+  _clip = nullptr;
+  _tile = nullptr;
+}
+
+// Destructor, a display sharing the bus must not be waited on once it is gone
+TFT_eSPI::~TFT_eSPI() {
+  if (_shadowOwned) free(_shadow);
+  deInitDMA();
+  if (_busOwner[spi_get_index(_spi)] == this) _busOwner[spi_get_index(_spi)] = nullptr;
 }
 
 // Initialize SPI and GPIO
@@ -31,9 +149,15 @@ void TFT_eSPI::spi_begin() {
     gpio_put(_rst, 1);  // Set RST high
   }
 
+  // Another display on this port must finish with it before the port is reset
+  TFT_eSPI *owner = _busOwner[spi_get_index(_spi)];
+  if (owner && (owner != this)) owner->bus_release();
+  dmaWait();
+
   // Initialize SPI
-  spi_init(_spi, 40000000);  // Initialize SPI with a default frequency of 40MHz
+  _writeFreq = spi_init(_spi, _writeFreq);  // Initialize SPI, the actual frequency may be lower than requested
   spi_set_format(_spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+  _busOwner[spi_get_index(_spi)] = this;  // The port now runs at this display's clock
   
   gpio_set_function(_mosi, GPIO_FUNC_SPI);
   gpio_set_function(_sclk, GPIO_FUNC_SPI);
@@ -43,36 +167,140 @@ void TFT_eSPI::spi_begin() {
   }
 }
 
-// Function to begin an SPI transaction
+// Display that last asserted CS on each SPI port
+TFT_eSPI *TFT_eSPI::_busOwner[2] = { nullptr, nullptr };
+
+// Function to begin an SPI transaction, nested calls keep CS low
+// The port is claimed on nested calls too, another display may have taken it inside this one's startWrite()
 void TFT_eSPI::spi_beginTransaction() {
-  gpio_put(_cs, 0);  // Assert CS pin (active low)
+  if (_busOwner[spi_get_index(_spi)] != this) bus_claim();
+
+  if (_txDepth++ == 0) {
+    if (_readyAt) bus_wait();  // Honour any delay left pending by reset() or commandList()
+    cs_low();  // Assert CS pin (active low)
+  }
+}
+
+// Take the port from the display that last used it and set this display's clock
+// If this display's transaction was suspended by another taking the port, its CS is asserted again
+void TFT_eSPI::bus_claim(void) {
+  TFT_eSPI *&owner = _busOwner[spi_get_index(_spi)];
+  if (owner) owner->bus_release();
+  spi_set_baudrate(_spi, _writeFreq);
+  owner = this;
+
+  if (_txDepth) cs_low();
+}
+
+// Give the port up to another display: DMA in flight completes and, inside a transaction, the buffered
+// bytes are sent at this display's clock and CS is released. The transaction stays open and continues
+// when this display next claims the port
+void TFT_eSPI::bus_release(void) {
+  dmaWait();
+  if (_txDepth) {
+    spi_flush();
+    cs_high();
+  }
 }
 
-// Function to end an SPI transaction
+// Function to end an SPI transaction, CS is released when the outermost transaction ends
 void TFT_eSPI::spi_endTransaction() {
-  gpio_put(_cs, 1);  // Deassert CS pin
+  if (_txDepth == 0) return;
+  if (--_txDepth == 0) {
+    spi_flush();
+    cs_high();  // Deassert CS pin
+  }
+}
+
+// Begin a write transaction so consecutive drawing calls share one CS assertion
+void TFT_eSPI::startWrite(void) {
+  spi_beginTransaction();
+}
+
+// End a write transaction, any buffered bytes are sent before CS is released
+void TFT_eSPI::endWrite(void) {
+  spi_endTransaction();
 }
 
-// Function to send a byte over SPI
+// Function to send any buffered bytes over SPI
+void TFT_eSPI::spi_flush(void) {
+  dmaWait();  // The bus belongs to the DMA channels until their transfers complete
+  if (_txLen) {
+    spi_write_blocking(_spi, _txBuf, _txLen);
+    _txLen = 0;
+  }
+}
+
+// Function to queue a byte for sending over SPI
 void TFT_eSPI::spi_transfer(uint8_t data) {
-  spi_write_blocking(_spi, &data, 1);
+  _txBuf[_txLen++] = data;
+  if (_txLen == TFT_SPI_BUFFER_SIZE) spi_flush();
+}
+
+// Function to queue a block of bytes, large blocks bypass the staging buffer
+void TFT_eSPI::spi_write(const uint8_t *data, uint32_t len) {
+  if (len >= TFT_SPI_BUFFER_SIZE) {
+    spi_flush();
+    spi_write_blocking(_spi, data, len);
+    return;
+  }
+  while (len--) spi_transfer(*data++);
 }
 
-// Function to read a byte over SPI
-uint8_t TFT_eSPI::spi_transfer(uint8_t data) {
+// Function to read a byte over SPI, buffered writes are sent first
+uint8_t TFT_eSPI::spi_read(uint8_t data) {
   uint8_t result;
-  spi_write_blocking(_spi, &data, 1);  // Write data
-  spi_read_blocking(_spi, 0x00, &result, 1);  // Read the response
+  spi_flush();
+  spi_write_read_blocking(_spi, &data, &result, 1);  // Clock out data and read the response
   return result;
 }
 
+// Function to switch to the read clock, display reads are slower than writes
+void TFT_eSPI::spi_read_begin(void) {
+  spi_flush();
+  spi_idle();
+  spi_set_baudrate(_spi, _readFreq);
+}
+
+// Function to return to the write clock after a read
+void TFT_eSPI::spi_read_end(void) {
+  spi_set_baudrate(_spi, _writeFreq);
+}
+
+// Function to write a byte straight to the TX FIFO, bypassing the staging buffer
+void TFT_eSPI::spi_put8(uint8_t data) {
+  while (!spi_is_writable(_spi)) {};
+  spi_get_hw(_spi)->dr = data;
+}
+
+// Function to wait until the bus is idle and discard anything clocked in
+void TFT_eSPI::spi_idle(void) {
+  spi_hw_t *hw = spi_get_hw(_spi);
+
+  while (hw->sr & SPI_SSPSR_BSY_BITS) {};
+  while (spi_is_readable(_spi)) (void)hw->dr;
+  hw->icr = SPI_SSPICR_RORIC_BITS;
+}
+
+// Function to send a command byte through the TX FIFO, the bus must be idle before DC changes
+void TFT_eSPI::spi_command_raw(uint8_t c) {
+  spi_idle();
+  dc_low();   // Command mode
+  spi_put8(c);
+  spi_idle();
+  dc_high();  // Back to data mode
+}
+
 // Send a command to the TFT
 void TFT_eSPI::writecommand(uint8_t c) {
-  gpio_put(_dc, 0);  // Command mode
+  // Window commands sent by the sketch make the cached window stale
+  if (c == 0x2A) addr_col = 0xFFFFFFFF;
+  if (c == 0x2B) addr_row = 0xFFFFFFFF;
+
   spi_beginTransaction();
-  spi_transfer(c);
+  spi_flush();       // Data bytes must leave before DC changes
+  spi_command_raw(c);
   spi_endTransaction();
-  gpio_put(_dc, 1);  // Back to data mode
 }
 
 // Send data to the TFT
@@ -88,16 +316,83 @@ void TFT_eSPI::reset(void) {
     gpio_put(_rst, 0);  // Assert reset
     sleep_ms(50);       // Wait 50ms
     gpio_put(_rst, 1);  // Deassert reset
-    sleep_ms(50);       // Wait 50ms
+    bus_delay(50);      // Wait 50ms before the next command, other work can run meanwhile
   }
+
+  // The controller window is unknown after a reset
+  addr_col = 0xFFFFFFFF;
+  addr_row = 0xFFFFFFFF;
+}
+
+// Defer the next bus access by ms, consecutive delays add up
+void TFT_eSPI::bus_delay(uint32_t ms) {
+  uint64_t now = time_us_64();
+  if (_readyAt < now) _readyAt = now;
+  _readyAt += (uint64_t)ms * 1000;
+}
+
+// Wait until any pending delay has expired
+void TFT_eSPI::bus_wait(void) {
+  uint64_t now = time_us_64();
+  if (now < _readyAt) sleep_us(_readyAt - now);
+  _readyAt = 0;
 }
 
 // Initialization of the display
 void TFT_eSPI::begin(void) {
+  spi_begin();
+
   // Reset display
   reset();
 
-  // Your display-specific initialization code here
+  // Send the controller specific initialisation sequence
+  commandList(_initTable);
+
+  // The init table leaves the display in rotation 0, reset leaves the whole screen scrolling with no offset
+  _scrollTop    = 0;
+  _scrollBottom = 0;
+  _scrollOffset = 0;
+
+  rotation = 0;
+  _width   = _initWidth;
+  _height  = _initHeight;
+  _xOffset = _colOffset;
+  _yOffset = _rowOffset;
+}
+
+// Send a table of commands, each command and its arguments are written to the TX FIFO as one burst
+// Delays are not slept immediately, they are folded into a deadline that the next command waits for
+void TFT_eSPI::commandList(const uint8_t *addr) {
+  uint8_t numCommands = *addr++;  // Number of commands to follow
+
+  spi_beginTransaction();
+  spi_flush();
+
+  while (numCommands--) {
+    uint8_t cmd     = *addr++;
+    uint8_t numArgs = *addr++;
+    uint8_t ms      = numArgs & TFT_INIT_DELAY;  // If high bit set, delay follows args
+    numArgs &= ~TFT_INIT_DELAY;
+
+    if (_readyAt) bus_wait();
+
+    spi_command_raw(cmd);
+    while (numArgs--) spi_put8(*addr++);
+
+    if (ms) {
+      ms = *addr++;
+      spi_idle();  // The delay runs from the end of the command
+      bus_delay(ms == 255 ? 500 : ms);
+    }
+  }
+
+  spi_idle();
+
+  // The table may have set a window
+  addr_col = 0xFFFFFFFF;
+  addr_row = 0xFFFFFFFF;
+
+  spi_endTransaction();
 }
 
 // Set the rotation of the display
@@ -107,90 +402,146 @@ void TFT_eSPI::setRotation(uint8_t m) {
 
   rotation = m % 4;  // Limit the rotation value to 0-3
 
+  // Window coordinates are interpreted in the new orientation so must be resent
+  addr_col = 0xFFFFFFFF;
+  addr_row = 0xFFFFFFFF;
+
   switch (rotation) {
     case 0:
       writedata(TFT_MADCTL_MX | TFT_MADCTL_BGR);
-      _width  = TFT_WIDTH;
-      _height = TFT_HEIGHT;
+      _width  = _initWidth;
+      _height = _initHeight;
+      _xOffset = _colOffset;
+      _yOffset = _rowOffset;
       break;
     case 1:
       writedata(TFT_MADCTL_MV | TFT_MADCTL_BGR);
-      _width  = TFT_HEIGHT;
-      _height = TFT_WIDTH;
+      _width  = _initHeight;
+      _height = _initWidth;
+      _xOffset = _rowOffset;
+      _yOffset = _colOffset;
       break;
     case 2:
       writedata(TFT_MADCTL_MY | TFT_MADCTL_BGR);
-      _width  = TFT_WIDTH;
-      _height = TFT_HEIGHT;
+      _width  = _initWidth;
+      _height = _initHeight;
+      _xOffset = _colOffset;
+      _yOffset = _rowOffset;
       break;
     case 3:
       writedata(TFT_MADCTL_MX | TFT_MADCTL_MY | TFT_MADCTL_MV | TFT_MADCTL_BGR);
-      _width  = TFT_HEIGHT;
-      _height = TFT_WIDTH;
+      _width  = _initHeight;
+      _height = _initWidth;
+      _xOffset = _rowOffset;
+      _yOffset = _colOffset;
       break;
   }
   spi_endTransaction();
+
+  // The shadow buffer is laid out for the old rotation
+  if (_shadow) shadow_mark(0, 0, _width, _height);
+}
+
+// Get the width of the display in the current rotation
+int16_t TFT_eSPI::width(void) {
+  return _width;
+}
+
+// Get the height of the display in the current rotation
+int16_t TFT_eSPI::height(void) {
+  return _height;
 }
 
-// Push a single pixel color
+// Push a single pixel color, the window and color are written straight to the TX FIFO in one burst
 void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
   if ((x < 0) || (x >= _width) || (y < 0) || (y >= _height)) return;
+  if (_clip && !_clip->contains(x, y)) return;
 
-  spi_beginTransaction();
+  if (_shadowOn) { shadow_fill(x, y, 1, 1, color); return; }
 
-  setAddrWindow(x, y, x + 1, y + 1);
+  spi_beginTransaction();
 
-  writedata(color >> 8);
-  writedata(color);
+  setAddrWindow(x, y, x, y);
+  spi_put8(color >> 8);
+  spi_put8(color);
+  spi_idle();
 
   spi_endTransaction();
 }
 
-// Set the address window for drawing
-void TFT_eSPI::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+// Set the address window for drawing, column and row windows are only sent if they changed
+// Commands and parameters go straight to the TX FIFO, the bus is only idled when DC changes
+// ramCmd is RAMWR (0x2C) for writes or RAMRD (0x2E) for reads
+void TFT_eSPI::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t ramCmd) {
   spi_beginTransaction();
+  spi_flush();
+
+  // Move the window to where the panel sits in the controller RAM
+  x0 += _xOffset; x1 += _xOffset;
+  y0 += _yOffset; y1 += _yOffset;
 
-  writecommand(0x2A);  // Column addr set
-  writedata(x0 >> 8);
-  writedata(x0 & 0xFF);
-  writedata(x1 >> 8);
-  writedata(x1 & 0xFF);
+  uint32_t col = (uint32_t)x0 << 16 | x1;
+  uint32_t row = (uint32_t)y0 << 16 | y1;
+
+  if (addr_col != col) {
+    spi_command_raw(0x2A);  // Column addr set
+    spi_put8(x0 >> 8); spi_put8(x0);
+    spi_put8(x1 >> 8); spi_put8(x1);
+    addr_col = col;
+  }
 
-  writecommand(0x2B);  // Row addr set
-  writedata(y0 >> 8);
-  writedata(y0 & 0xFF);
-  writedata(y1 >> 8);
-  writedata(y1 & 0xFF);
+  if (addr_row != row) {
+    spi_command_raw(0x2B);  // Row addr set
+    spi_put8(y0 >> 8); spi_put8(y0);
+    spi_put8(y1 >> 8); spi_put8(y1);
+    addr_row = row;
+  }
 
-  writecommand(0x2C);  // Write to RAM
+  spi_command_raw(ramCmd);  // Write or read RAM, always needed to restart at the window origin
 
   spi_endTransaction();
 }
 
+// Set the window for pushed pixels, x1,y1 is the bottom right corner (inclusive)
+// While clipped the window is only recorded, the pushed pixels then set a window for each visible run
+void TFT_eSPI::setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  if (_shadowOn || _clip) {
+    _winX = _winX0 = x0; _winX1 = x1;
+    _winY = _winY0 = y0; _winY1 = y1;
+    if (!_clip) shadow_mark(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    return;
+  }
+
+  setAddrWindow(x0, y0, x1, y1);
+}
+
 // Draw a filled rectangle
 void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
   if ((x >= _width) || (y >= _height)) return;
 
-  int32_t x2 = x + w - 1;
-  int32_t y2 = y + h - 1;
-
-  if ((x2 < 0) || (y2 < 0)) return;
-
   if (x < 0) { w += x; x = 0; }
   if (y < 0) { h += y; y = 0; }
-  if (x2 >= _width)  w = _width  - x;
-  if (y2 >= _height) h = _height - y;
+  if ((x + w) > _width)  w = _width  - x;
+  if ((y + h) > _height) h = _height - y;
 
-  spi_beginTransaction();
+  if ((w < 1) || (h < 1)) return;
 
-  setAddrWindow(x, y, x2, y2);
+  if (_clip) { clip_fill(x, y, w, h, color); return; }
 
-  uint16_t pixelCount = w * h;
-  while (pixelCount--) {
-    writedata(color >> 8);
-    writedata(color);
+  if (_shadowOn) { shadow_fill(x, y, w, h, color); return; }
+
+  // Large fills are handed to DMA, the next bus access waits for them to finish
+  if (_dmaEnabled && ((uint32_t)w * h >= TFT_DMA_MIN_PIXELS)) {
+    fillRectAsync(x, y, w, h, color);
+    return;
   }
 
+  spi_beginTransaction();
+
+  setAddrWindow(x, y, x + w - 1, y + h - 1);
+
+  pushBlock(color, (uint32_t)w * h);
+
   spi_endTransaction();
 }
 
@@ -201,64 +552,369 @@ void TFT_eSPI::fillScreen(uint32_t color) {
 
 // Draw a horizontal line
 void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
-  if ((x >= _width) || (y >= _height)) return;
-
-  int32_t x2 = x + w - 1;
-  if (x2 < 0) return;
+  if ((x >= _width) || (y < 0) || (y >= _height)) return;
 
   if (x < 0) { w += x; x = 0; }
-  if (x2 >= _width) w = _width - x;
+  if ((x + w) > _width) w = _width - x;
+
+  if (w < 1) return;
+
+  if (_clip) { clip_fill(x, y, w, 1, color); return; }
+
+  if (_shadowOn) { shadow_fill(x, y, w, 1, color); return; }
 
   spi_beginTransaction();
 
-  setAddrWindow(x, y, x2, y);
+  setAddrWindow(x, y, x + w - 1, y);
 
-  while (w--) {
-    writedata(color >> 8);
-    writedata(color);
-  }
+  pushBlock(color, w);
 
   spi_endTransaction();
 }
 
 // Draw a vertical line
 void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
-  if ((x >= _width) || (y >= _height)) return;
-
-  int32_t y2 = y + h - 1;
-  if (y2 < 0) return;
+  if ((x < 0) || (x >= _width) || (y >= _height)) return;
 
   if (y < 0) { h += y; y = 0; }
-  if (y2 >= _height) h = _height - y;
+  if ((y + h) > _height) h = _height - y;
+
+  if (h < 1) return;
+
+  if (_clip) { clip_fill(x, y, 1, h, color); return; }
+
+  if (_shadowOn) { shadow_fill(x, y, 1, h, color); return; }
+
+  spi_beginTransaction();
+
+  setAddrWindow(x, y, x, y + h - 1);
+
+  pushBlock(color, h);
+
+  spi_endTransaction();
+}
+
+// Sort points into raster order so each row can be scanned for horizontal runs
+// The sort is stable so duplicates keep their order and the last drawn is the last in the list, as drawPixel() gives
+template <typename T> static void sortByRow(T *points, uint32_t n) {
+  std::stable_sort(points, points + n, [](const T &a, const T &b) {
+    return (a.y != b.y) ? (a.y < b.y) : (a.x < b.x);
+  });
+}
+
+// Draw a list of points in one color, horizontal neighbours are merged into runs
+// The points array is sorted into raster order by this call
+void TFT_eSPI::drawPixels(tft_point *points, uint32_t n, uint32_t color) {
+  if (n == 0) return;
+
+  if (_shadowOn) {
+    while (n--) { drawPixel(points->x, points->y, color); points++; }
+    return;
+  }
+
+  sortByRow(points, n);
+
+  spi_beginTransaction();
+
+  uint32_t i = 0;
+  while (i < n) {
+    int32_t y  = points[i].y;
+    int32_t x0 = points[i].x;
+    int32_t x1 = x0;
+
+    // Extend the run over duplicates and adjacent pixels on the same row
+    while ((++i < n) && (points[i].y == y) && (points[i].x <= x1 + 1)) x1 = points[i].x;
+
+    if ((y < 0) || (y >= _height) || (x1 < 0) || (x0 >= _width)) continue;
+    if (x0 < 0) x0 = 0;
+    if (x1 >= _width) x1 = _width - 1;
+
+    if (_clip) { drawFastHLine(x0, y, x1 - x0 + 1, color); continue; }
+
+    setAddrWindow(x0, y, x1, y);
+    pushBlock(color, x1 - x0 + 1);
+  }
+
+  spi_endTransaction();
+}
+
+// Draw a list of points with their own colors, horizontal neighbours are merged into runs
+// The pixels array is sorted into raster order by this call, duplicates draw the last of their colors
+void TFT_eSPI::drawPixels(tft_pixel *pixels, uint32_t n) {
+  if (n == 0) return;
+
+  if (_shadowOn || _clip) {
+    while (n--) { drawPixel(pixels->x, pixels->y, pixels->color); pixels++; }
+    return;
+  }
+
+  sortByRow(pixels, n);
+
+  spi_beginTransaction();
+
+  uint32_t i = 0;
+  while (i < n) {
+    uint32_t first = i;
+    int32_t  y  = pixels[i].y;
+    int32_t  x1 = pixels[i].x;
+
+    while ((++i < n) && (pixels[i].y == y) && (pixels[i].x <= x1 + 1)) x1 = pixels[i].x;
+
+    if ((y < 0) || (y >= _height)) continue;
+
+    // Skip the part of the run that is off screen to the left
+    while ((first < i) && (pixels[first].x < 0)) first++;
+    if ((first == i) || (pixels[first].x >= _width)) continue;
+    if (x1 >= _width) x1 = _width - 1;
+
+    setAddrWindow(pixels[first].x, y, x1, y);
+
+    // The last of a set of duplicates is the one sent
+    for (uint32_t k = first; k < i; k++) {
+      if (pixels[k].x > x1) break;
+      if ((k + 1 < i) && (pixels[k + 1].x == pixels[k].x)) continue;
+      spi_transfer(pixels[k].color >> 8);
+      spi_transfer(pixels[k].color);
+    }
+  }
+
+  spi_endTransaction();
+}
+
+// Push a block of pixels of the same color to the current address window
+void TFT_eSPI::pushBlock(uint16_t color, uint32_t len) {
+  if (len == 0) return;
+
+  if (_clip) { clip_put(color, nullptr, nullptr, len); return; }
+
+  if (_shadowOn) { shadow_put(color, len); return; }
 
   spi_beginTransaction();
 
-  setAddrWindow(x, y, x, y2);
+  // Short runs are cheaper to stage as bytes than to change the frame size
+  if (len < TFT_SHORT_RUN) {
+    while (len--) {
+      spi_transfer(color >> 8);
+      spi_transfer(color);
+    }
+    spi_endTransaction();
+    return;
+  }
+
+  spi_begin16();
+
+  spi_hw_t *hw = spi_get_hw(_spi);
 
-  while (h--) {
-    writedata(color >> 8);
-    writedata(color);
+  // Refill the whole TX FIFO each time it runs empty
+  while (len >= TFT_SPI_FIFO_DEPTH) {
+    while (!(hw->sr & SPI_SSPSR_TFE_BITS)) {};
+    for (uint32_t i = 0; i < TFT_SPI_FIFO_DEPTH; i++) hw->dr = color;
+    len -= TFT_SPI_FIFO_DEPTH;
   }
 
+  // Mop up the remaining pixels
+  while (len--) {
+    while (!spi_is_writable(_spi)) {};
+    hw->dr = color;
+  }
+
+  spi_end16();
+  spi_endTransaction();
+}
+
+// Switch the SPI block to 16-bit frames so each frame carries one whole pixel, MS byte first
+void TFT_eSPI::spi_begin16(void) {
+  spi_flush();  // Staged 8-bit bytes must leave before the frame size changes
+  spi_set_format(_spi, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+}
+
+// Wait for the last 16-bit frame to leave, discard the received words and restore 8-bit frames
+void TFT_eSPI::spi_end16(void) {
+  spi_idle();
+  spi_set_format(_spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+}
+
+// Initialise a pair of DMA channels for pixel transfers, returns true if both were claimed
+// Two channels let a second buffer be chained behind the one on the wire
+bool TFT_eSPI::initDMA(void) {
+  if (_dmaEnabled) return false;
+
+  for (int i = 0; i < 2; i++) {
+    _dmaChannel[i] = dma_claim_unused_channel(false);
+    if (_dmaChannel[i] < 0) {
+      if (i) dma_channel_unclaim(_dmaChannel[0]);
+      return false;
+    }
+
+    _dmaConfig[i] = dma_channel_get_default_config(_dmaChannel[i]);
+    channel_config_set_transfer_data_size(&_dmaConfig[i], DMA_SIZE_16);
+    channel_config_set_write_increment(&_dmaConfig[i], false);
+    channel_config_set_dreq(&_dmaConfig[i], spi_get_index(_spi) ? DREQ_SPI1_TX : DREQ_SPI0_TX);
+  }
+
+  _dmaEnabled = true;
+  return true;
+}
+
+// Release the DMA channels, any transfer in progress is completed first
+void TFT_eSPI::deInitDMA(void) {
+  if (!_dmaEnabled) return;
+  dmaWait();
+  dma_channel_unclaim(_dmaChannel[0]);
+  dma_channel_unclaim(_dmaChannel[1]);
+  _dmaEnabled = false;
+}
+
+// Check if a DMA transfer is still in progress, finished transfers are retired here
+bool TFT_eSPI::dmaBusy(void) {
+  if (!_dmaActive) return false;
+  if (dma_channel_is_busy(_dmaChannel[0]) || dma_channel_is_busy(_dmaChannel[1])) return true;
+
+  dma_retire();
+  return false;
+}
+
+// Wait until all DMA transfers are complete (blocking)
+void TFT_eSPI::dmaWait(void) {
+  if (!_dmaActive) return;
+  while (dma_channel_is_busy(_dmaChannel[0]) || dma_channel_is_busy(_dmaChannel[1])) {};
+
+  dma_retire();
+}
+
+// Restore the SPI bus after DMA transfers and release the CS held for them
+void TFT_eSPI::dma_retire(void) {
+  _dmaActive = false;
+  _dmaTail   = -1;
+  spi_end16();
+  spi_endTransaction();
+}
+
+// Claim the bus for DMA, CS is held and 16-bit frames stay selected until the transfers are retired
+void TFT_eSPI::dma_begin(void) {
+  if (_dmaActive) return;
+
+  spi_beginTransaction();
+  spi_begin16();
+  _dmaActive = true;
+}
+
+// Start a DMA fill of a rectangle and return immediately, use dmaBusy() to check completion
+void TFT_eSPI::fillRectAsync(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!_dmaEnabled || _shadowOn || _clip) { fillRect(x, y, w, h, color); return; }
+
+  if ((x >= _width) || (y >= _height)) return;
+
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if ((x + w) > _width)  w = _width  - x;
+  if ((y + h) > _height) h = _height - y;
+
+  if ((w < 1) || (h < 1)) return;
+
+  dmaWait();  // _dmaColor is the DMA source so it must not change mid transfer
+
+  spi_beginTransaction();
+  setAddrWindow(x, y, x + w - 1, y + h - 1);
+  dma_begin();
   spi_endTransaction();
+
+  // Non-incrementing read of a single color word, no CPU involvement after this
+  _dmaColor = color;
+  channel_config_set_read_increment(&_dmaConfig[0], false);
+  channel_config_set_bswap(&_dmaConfig[0], false);
+  channel_config_set_chain_to(&_dmaConfig[0], _dmaChannel[0]);
+  dma_channel_configure(_dmaChannel[0], &_dmaConfig[0], &spi_get_hw(_spi)->dr, &_dmaColor, (uint32_t)w * h, true);
+
+  _dmaTail = 0;
+}
+
+// Push a buffer of pixels to the current address window by DMA
+// If a buffer is already on the wire the new one is chained behind it so the bus does not idle
+// between them, and the call returns once the earlier buffer has been sent so it can be refilled
+void TFT_eSPI::pushColorsAsync(uint16_t *data, uint32_t len) {
+  if (len == 0) return;
+  if (!_dmaEnabled || _shadowOn || _clip) { pushColors(data, len); return; }
+
+  dma_begin();
+
+  int8_t prev = _dmaTail;
+  int8_t next = (prev == 0) ? 1 : 0;
+  uint32_t ch = _dmaChannel[next];
+
+  channel_config_set_read_increment(&_dmaConfig[next], true);
+  channel_config_set_bswap(&_dmaConfig[next], _swapBytes);
+  channel_config_set_chain_to(&_dmaConfig[next], ch);  // Chaining to itself means no chain
+
+  if ((prev >= 0) && dma_channel_is_busy(_dmaChannel[prev])) {
+    dma_channel_configure(ch, &_dmaConfig[next], &spi_get_hw(_spi)->dr, data, len, false);
+
+    // Trigger this buffer when the one on the wire completes
+    channel_config_set_chain_to(&_dmaConfig[prev], ch);
+    dma_channel_set_config(_dmaChannel[prev], &_dmaConfig[prev], false);
+
+    // If the earlier transfer completed before the chain was set then it did not trigger this one
+    if (!dma_channel_is_busy(_dmaChannel[prev]) && !dma_channel_is_busy(ch) &&
+        (dma_channel_hw_addr(ch)->transfer_count == len)) dma_channel_start(ch);
+
+    dma_channel_wait_for_finish_blocking(_dmaChannel[prev]);
+  }
+  else {
+    dma_channel_configure(ch, &_dmaConfig[next], &spi_get_hw(_spi)->dr, data, len, true);
+  }
+
+  _dmaTail = next;
 }
+
+// Set whether pixel buffers hold colors with their bytes swapped
+void TFT_eSPI::setSwapBytes(bool swap) {
+  _swapBytes = swap;
+}
+
+// Get the byte swap setting for pixel buffers
+bool TFT_eSPI::getSwapBytes(void) {
+  return _swapBytes;
+}
+
 // Push a single color pixel to the TFT display at the set address window
 void TFT_eSPI::pushColor(uint16_t color) {
+  if (_clip) { clip_put(color, nullptr, nullptr, 1); return; }
+
+  if (_shadowOn) { shadow_put(color, 1); return; }
+
   spi_beginTransaction();
 
-  writedata(color >> 8);
-  writedata(color);
+  spi_transfer(color >> 8);
+  spi_transfer(color);
 
   spi_endTransaction();
 }
 
 // Push an array of colors to the TFT display
 void TFT_eSPI::pushColors(uint16_t *data, uint32_t len) {
+  if (_clip) { clip_put(0, data, nullptr, len); return; }
+
+  if (_shadowOn) {
+    while (len--) {
+      uint16_t color = *data++;
+      shadow_put(_swapBytes ? (uint16_t)(color >> 8 | color << 8) : color, 1);
+    }
+    return;
+  }
+
   spi_beginTransaction();
 
-  while (len--) {
-    writedata(*data >> 8);
-    writedata(*data++);
+  if (_swapBytes) {
+    while (len--) {
+      spi_transfer(*data);
+      spi_transfer(*data++ >> 8);
+    }
+  }
+  else {
+    while (len--) {
+      spi_transfer(*data >> 8);
+      spi_transfer(*data++);
+    }
   }
 
   spi_endTransaction();
@@ -266,25 +922,31 @@ void TFT_eSPI::pushColors(uint16_t *data, uint32_t len) {
 
 // Push a block of 8-bit color data to the display
 void TFT_eSPI::pushColors(uint8_t *data, uint32_t len) {
-  spi_beginTransaction();
+  if (_clip) { clip_put(0, nullptr, data, len / 2); return; }
 
-  while (len--) {
-    writedata(*data++);
+  if (_shadowOn) {
+    for (; len >= 2; len -= 2, data += 2) shadow_put(data[0] << 8 | data[1], 1);
+    return;
   }
 
+  spi_beginTransaction();
+
+  spi_write(data, len);
+
   spi_endTransaction();
 }
 
 // Set the brightness of the display using PWM
 void TFT_eSPI::setBrightness(uint8_t brightness) {
-  // Assuming the use of a GPIO pin for backlight control via PWM
-  // Configure the GPIO pin for PWM output (replace BACKLIGHT_PIN with actual pin)
-  gpio_set_function(BACKLIGHT_PIN, GPIO_FUNC_PWM);
-  uint slice_num = pwm_gpio_to_slice_num(BACKLIGHT_PIN);
+  if (_bl < 0) return;  // No backlight pin configured
+
+  // Configure the GPIO pin for PWM output
+  gpio_set_function(_bl, GPIO_FUNC_PWM);
+  uint slice_num = pwm_gpio_to_slice_num(_bl);
 
   // Set the PWM frequency and duty cycle
   pwm_set_wrap(slice_num, 255);  // 8-bit resolution
-  pwm_set_gpio_level(BACKLIGHT_PIN, brightness);
+  pwm_set_gpio_level(_bl, brightness);
   pwm_set_enabled(slice_num, true);
 }
 
@@ -294,14 +956,12 @@ uint8_t TFT_eSPI::readcommand8(uint8_t cmd) {
 
   spi_beginTransaction();
 
-  gpio_put(_dc, 0);  // Command mode
-  spi_transfer(cmd);
-  gpio_put(_dc, 1);  // Data mode
+  writecommand(cmd);
 
-  // Now we need to read the data
-  gpio_put(_cs, 0);  // Assert CS
-  data = spi_transfer(0x00);  // Dummy write to receive data
-  gpio_put(_cs, 1);  // Deassert CS
+  // CS is still low so the response follows the command
+  spi_read_begin();
+  data = spi_read(0x00);  // Dummy write to receive data
+  spi_read_end();
 
   spi_endTransaction();
 
@@ -314,37 +974,224 @@ uint16_t TFT_eSPI::read16(uint8_t cmd) {
 
   spi_beginTransaction();
 
-  gpio_put(_dc, 0);  // Command mode
-  spi_transfer(cmd);
-  gpio_put(_dc, 1);  // Data mode
+  writecommand(cmd);
 
-  gpio_put(_cs, 0);  // Assert CS
-  high = spi_transfer(0x00);  // Read high byte
-  low = spi_transfer(0x00);   // Read low byte
-  gpio_put(_cs, 1);  // Deassert CS
+  spi_read_begin();
+  high = spi_read(0x00);  // Read high byte
+  low = spi_read(0x00);   // Read low byte
+  spi_read_end();
 
   spi_endTransaction();
 
   return (high << 8) | low;
 }
 
-// Read the ID of the display (for compatibility checks)
-uint32_t TFT_eSPI::readID(void) {
+// Read a rectangle of pixels from display RAM into data as 565 colors
+void TFT_eSPI::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) {
+  if ((x < 0) || (y < 0) || (w < 1) || (h < 1) || ((x + w) > _width) || ((y + h) > _height)) return;
+
+  // A RAM tile holds what is drawn under it, pixels outside it read as black
+  if (_tile) {
+    for (int32_t j = 0; j < h; j++) {
+      for (int32_t i = 0; i < w; i++) {
+        int32_t tx = x + i - _tileX, ty = y + j - _tileY;
+        bool in = (tx >= 0) && (tx < _tileW) && (ty >= 0) && (ty < _tileH);
+        data[j * w + i] = in ? _tile[ty * _tileW + tx] : 0;
+      }
+    }
+    return;
+  }
+
+  // The shadow buffer holds what the screen will show once flushed
+  if (_shadowOn) {
+    for (int32_t j = 0; j < h; j++) memcpy(data + j * w, _shadow + (y + j) * _width + x, w * 2);
+    return;
+  }
+
   spi_beginTransaction();
 
-  writecommand(0x04);  // Read Display Identification Information
+  setAddrWindow(x, y, x + w - 1, y + h - 1, 0x2E);  // Read from RAM
 
-  uint32_t r = read16(0x04);
-  r <<= 16;
-  r |= read16(0x04);
+  spi_read_begin();
+  spi_read(0x00);  // Dummy byte
 
-  spi_endTransaction();
+  // The display returns 3 bytes per pixel, read them in chunks through the empty staging buffer
+  uint32_t len = (uint32_t)w * h;
+  while (len) {
+    uint32_t n = std::min<uint32_t>(len, TFT_SPI_BUFFER_SIZE / 3);
+    spi_read_blocking(_spi, 0x00, _txBuf, n * 3);
+    for (uint32_t i = 0; i < n; i++) {
+      uint8_t *p = _txBuf + i * 3;
+      *data++ = ((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3);
+    }
+    len -= n;
+  }
 
-  return r;
+  spi_read_end();
+
+  // The read is ended by CS going high, or by the next command if a transaction is open
+  spi_endTransaction();
 }
 
-// Invert the display colors
-void TFT_eSPI::invertDisplay(bool i) {
+// Write the calibration pattern and read it back, returns true if every pass matches
+bool TFT_eSPI::cal_test(void) {
+  uint16_t pattern[TFT_CAL_PIXELS];
+  uint16_t buffer[TFT_CAL_PIXELS];
+
+  for (uint32_t pass = 0; pass < TFT_CAL_PASSES; pass++) {
+    // Walking ones then walking zeros, inverted on alternate passes
+    for (uint32_t i = 0; i < TFT_CAL_PIXELS; i++) {
+      pattern[i] = (1 << (i & 15)) ^ ((i & 16) ? 0xFFFF : 0) ^ ((pass & 1) ? 0xFFFF : 0);
+    }
+
+    setAddrWindow(0, 0, TFT_CAL_PIXELS - 1, 0);
+    pushColors(pattern, TFT_CAL_PIXELS);
+    readRect(0, 0, TFT_CAL_PIXELS, 1, buffer);
+
+    // The display holds 18-bit color, the 565 bits must survive the round trip
+    for (uint32_t i = 0; i < TFT_CAL_PIXELS; i++) {
+      if (buffer[i] != pattern[i]) return false;
+    }
+  }
+
+  return true;
+}
+
+// Step one clock upwards while the calibration test passes, returns the clock one step below the
+// fastest pass for margin, or 0 if the slowest clock fails
+uint32_t TFT_eSPI::cal_sweep(uint32_t *freq, uint32_t minFreq, uint32_t maxFreq, uint32_t stepFreq, uint32_t id) {
+  uint32_t best = 0, margin = 0, last = 0;
+
+  for (uint32_t f = minFreq; f <= maxFreq; f += stepFreq) {
+    // Only some clocks can be generated, skip requests that give the same clock
+    uint32_t actual = spi_set_baudrate(_spi, f);
+    if (actual == last) continue;
+    last = actual;
+
+    *freq = actual;
+    spi_set_baudrate(_spi, _writeFreq);
+
+    if ((readID() != id) || !cal_test()) break;
+
+    margin = best;
+    best = actual;
+  }
+
+  return margin ? margin : best;
+}
+
+// Find the fastest write and read clocks that pass a pattern test with one step of margin
+// The clocks are applied and returned so they can be stored and passed to the constructor
+// The top left corner of the screen is overwritten
+tft_spi_clocks TFT_eSPI::calibrateSPI(uint32_t minFreq, uint32_t maxFreq, uint32_t stepFreq) {
+  tft_spi_clocks clocks = { _writeFreq, _readFreq };
+
+  // The test pattern must reach the display, the shadow copy of the corner is resent by the next flush
+  bool shadowOn = _shadowOn;
+  const TFT_eRegion *clip = _clip;
+  _shadowOn = false;
+  _clip     = nullptr;
+
+  // Register values read with both clocks at the slowest setting are the reference
+  _writeFreq = _readFreq = minFreq;
+  spi_flush();
+  spi_idle();
+  spi_set_baudrate(_spi, minFreq);
+  uint32_t id = readID();
+
+  // Write clock is stepped with reads at the slowest clock, then the read clock with slow writes
+  uint32_t writeFreq = cal_sweep(&_writeFreq, minFreq, maxFreq, stepFreq, id);
+  _writeFreq = minFreq;
+  uint32_t readFreq  = cal_sweep(&_readFreq,  minFreq, maxFreq, stepFreq, id);
+
+  if (writeFreq) clocks.write_hz = writeFreq;
+  if (readFreq)  clocks.read_hz  = readFreq;
+
+  _writeFreq = clocks.write_hz;
+  _readFreq  = clocks.read_hz;
+  spi_set_baudrate(_spi, _writeFreq);
+
+  _shadowOn = shadowOn;
+  _clip     = clip;
+  if (_shadowOn) shadow_mark(0, 0, TFT_CAL_PIXELS, 1);
+
+  return clocks;
+}
+
+// Read the ID of the display (for compatibility checks)
+uint32_t TFT_eSPI::readID(void) {
+  spi_beginTransaction();
+
+  writecommand(0x04);  // Read Display Identification Information
+
+  uint32_t r = read16(0x04);
+  r <<= 16;
+  r |= read16(0x04);
+
+  spi_endTransaction();
+
+  return r;
+}
+
+// Define the scrolling area by the heights of the fixed areas above and below it, the offset is reset
+// Rows are counted in the panel, a panel offset in controller RAM is added to the top area
+bool TFT_eSPI::setScrollArea(uint16_t top, uint16_t bottom) {
+  // The three areas must add up to the controller's RAM rows, those above and below the panel are fixed
+  int32_t below = (int32_t)_ramHeight - _rowOffset - _initHeight;
+  if ((top + bottom >= _initHeight) || (below < 0)) return false;
+
+  _scrollTop    = top;
+  _scrollBottom = bottom;
+  _scrollOffset = 0;
+
+  uint16_t tfa = top + _rowOffset;
+  uint16_t vsa = _initHeight - top - bottom;
+  uint16_t bfa = bottom + below;
+
+  spi_beginTransaction();
+  writecommand(0x33);  // Vertical scrolling definition
+  writedata(tfa >> 8);    writedata(tfa);
+  writedata(vsa >> 8);    writedata(vsa);
+  writedata(bfa >> 8);    writedata(bfa);
+
+  writecommand(0x37);  // Vertical scrolling start address
+  writedata(tfa >> 8);    writedata(tfa);
+  spi_endTransaction();
+  return true;
+}
+
+// Scroll the area, the controller shows RAM row top + offset at the top of the area
+void TFT_eSPI::scroll(int32_t n) {
+  int32_t vsa = _initHeight - _scrollTop - _scrollBottom;
+
+  n %= vsa;
+  if (n < 0) n += vsa;
+  _scrollOffset = (_scrollOffset + n) % vsa;
+
+  uint16_t vsp = _scrollTop + _rowOffset + _scrollOffset;
+
+  spi_beginTransaction();
+  writecommand(0x37);  // Vertical scrolling start address
+  writedata(vsp >> 8);
+  writedata(vsp);
+  spi_endTransaction();
+}
+
+// Map a screen row to the RAM row shown there, the fixed areas do not move
+int32_t TFT_eSPI::scrollRow(int32_t y) {
+  int32_t vsa = _initHeight - _scrollTop - _scrollBottom;
+
+  if ((y < _scrollTop) || (y >= _scrollTop + vsa)) return y;
+  return _scrollTop + (y - _scrollTop + _scrollOffset) % vsa;
+}
+
+// Get the current scroll offset
+uint16_t TFT_eSPI::getScrollOffset(void) {
+  return _scrollOffset;
+}
+
+// Invert the display colors
+void TFT_eSPI::invertDisplay(bool i) {
   spi_beginTransaction();
   writecommand(i ? 0x21 : 0x20);  // 0x21 = invert colors, 0x20 = normal mode
   spi_endTransaction();
@@ -352,12 +1199,14 @@ void TFT_eSPI::invertDisplay(bool i) {
 
 // Write a 16-bit command to the display
 void TFT_eSPI::writecommand16(uint16_t c) {
-  gpio_put(_dc, 0);  // Command mode
   spi_beginTransaction();
+  spi_flush();       // Data bytes must leave before DC changes
+  dc_low();   // Command mode
   spi_transfer(c >> 8);  // Send high byte
   spi_transfer(c & 0xFF);  // Send low byte
+  spi_flush();
+  dc_high();  // Data mode
   spi_endTransaction();
-  gpio_put(_dc, 1);  // Data mode
 }
 
 // Write a 16-bit data value to the display
@@ -368,7 +1217,7 @@ void TFT_eSPI::writedata16(uint16_t d) {
   spi_endTransaction();
 }
 
-// Draw a circle outline
+// Draw a circle outline, points are batched so adjacent pixels share an address window
 void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
   int32_t f = 1 - r;
   int32_t ddF_x = 1;
@@ -376,10 +1225,15 @@ void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
   int32_t x = 0;
   int32_t y = r;
 
-  drawPixel(x0  , y0+r, color);
-  drawPixel(x0  , y0-r, color);
-  drawPixel(x0+r, y0  , color);
-  drawPixel(x0-r, y0  , color);
+  tft_point pts[TFT_PIXEL_BATCH];
+  uint32_t n = 0;
+
+  pts[n++] = { (int16_t)(x0    ), (int16_t)(y0 + r) };
+  pts[n++] = { (int16_t)(x0    ), (int16_t)(y0 - r) };
+  pts[n++] = { (int16_t)(x0 + r), (int16_t)(y0    ) };
+  pts[n++] = { (int16_t)(x0 - r), (int16_t)(y0    ) };
+
+  spi_beginTransaction();
 
   while (x < y) {
     if (f >= 0) {
@@ -391,15 +1245,24 @@ void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
     ddF_x += 2;
     f += ddF_x;
 
-    drawPixel(x0 + x, y0 + y, color);
-    drawPixel(x0 - x, y0 + y, color);
-    drawPixel(x0 + x, y0 - y, color);
-    drawPixel(x0 - x, y0 - y, color);
-    drawPixel(x0 + y, y0 + x, color);
-    drawPixel(x0 - y, y0 + x, color);
-    drawPixel(x0 + y, y0 - x, color);
-    drawPixel(x0 - y, y0 - x, color);
+    if (n > TFT_PIXEL_BATCH - 8) {
+      drawPixels(pts, n, color);
+      n = 0;
+    }
+
+    pts[n++] = { (int16_t)(x0 + x), (int16_t)(y0 + y) };
+    pts[n++] = { (int16_t)(x0 - x), (int16_t)(y0 + y) };
+    pts[n++] = { (int16_t)(x0 + x), (int16_t)(y0 - y) };
+    pts[n++] = { (int16_t)(x0 - x), (int16_t)(y0 - y) };
+    pts[n++] = { (int16_t)(x0 + y), (int16_t)(y0 + x) };
+    pts[n++] = { (int16_t)(x0 - y), (int16_t)(y0 + x) };
+    pts[n++] = { (int16_t)(x0 + y), (int16_t)(y0 - x) };
+    pts[n++] = { (int16_t)(x0 - y), (int16_t)(y0 - x) };
   }
+
+  drawPixels(pts, n, color);
+
+  spi_endTransaction();
 }
 
 // Fill a circle
@@ -444,25 +1307,1058 @@ void TFT_eSPI::fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t corne
 }
 
 
+// Polygon edge, x is the first pixel at or right of the crossing of the current scanline
+// The exact crossing is x - r / d, stepped per scanline by the integer DDA terms sx, sr
+struct tft_edge {
+  int32_t x, r, d, sx, sr;
+  int16_t y0, y1;  // First scanline and the one after the last
+  int8_t  dir;     // 1 for downward edges, -1 for upward, for the non-zero rule
+};
+
+// Set an edge to scanline y, the crossing at the centre of scanline y0 + k is x0 + (2k + 1) * dx / 2dy
+// and the first pixel whose centre is not left of it is x0 + ceil(((2k + 1) * dx - dy) / 2dy)
+static void edgeStart(tft_edge &e, int32_t x0, int32_t dx, int32_t y) {
+  int64_t num = (int64_t)(2 * (y - e.y0) + 1) * dx - e.d / 2;
+  int64_t q   = (num >= 0) ? (num + e.d - 1) / e.d : -((-num) / e.d);
+  e.x = x0 + q;
+  e.r = q * e.d - num;
+}
+
+// Fill a polygon with a sorted edge table, an active edge list and integer DDA along each edge
+void TFT_eSPI::fillPolygon(const tft_point *points, uint32_t n, uint32_t color, uint8_t rule) {
+  if (n < 3) return;
+
+  tft_edge  stack[TFT_POLYGON_EDGES];
+  tft_edge *edges = stack;
+  if (n > TFT_POLYGON_EDGES) {
+    edges = (tft_edge *)malloc(n * sizeof(tft_edge));
+    if (edges == nullptr) return;
+  }
+
+  // Build the edge table, horizontal edges never cross a pixel centre so are dropped
+  // x0 and dx are parked in x and sx until the edge becomes active
+  uint32_t ne = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    const tft_point &a = points[i];
+    const tft_point &b = points[(i + 1 == n) ? 0 : i + 1];
+    if (a.y == b.y) continue;
+
+    tft_edge &e = edges[ne++];
+    const tft_point &top = (a.y < b.y) ? a : b;
+    const tft_point &bot = (a.y < b.y) ? b : a;
+
+    e.dir = (a.y < b.y) ? 1 : -1;
+    e.y0  = top.y;
+    e.y1  = bot.y;
+    e.d   = 2 * (bot.y - top.y);
+    e.x   = top.x;
+    e.sx  = bot.x - top.x;
+  }
+
+  // A polygon of horizontal edges only covers no pixel centres
+  if (ne == 0) {
+    if (edges != stack) free(edges);
+    return;
+  }
+
+  std::sort(edges, edges + ne, [](const tft_edge &a, const tft_edge &b) { return a.y0 < b.y0; });
+
+  // Active edges are kept at the start of the array, [0, na), the edges still to start follow
+  int32_t ymin = std::max<int32_t>(edges[0].y0, 0);
+  int32_t ymax = 0;
+  for (uint32_t i = 0; i < ne; i++) ymax = std::max<int32_t>(ymax, edges[i].y1);
+  ymax = std::min<int32_t>(ymax, _height);
+
+  spi_beginTransaction();
+
+  uint32_t na = 0, next = 0;
+  for (int32_t y = ymin; y < ymax; y++) {
+    // Drop finished edges
+    for (uint32_t i = 0; i < na; ) {
+      if (edges[i].y1 <= y) edges[i] = edges[--na];
+      else i++;
+    }
+
+    // Add edges starting on this scanline, or above the screen for the first visible one
+    while ((next < ne) && (edges[next].y0 <= y)) {
+      tft_edge e = edges[next++];
+      if (e.y1 <= y) continue;
+
+      // Each scanline moves the crossing by 2dx / 2dy, split into whole pixels and a remainder
+      int32_t x0 = e.x, dx = e.sx;
+      int32_t step = 2 * dx;
+      e.sx = (step >= 0) ? step / e.d : -((-step + e.d - 1) / e.d);
+      e.sr = step - e.sx * e.d;
+      edgeStart(e, x0, dx, y);
+      edges[na++] = e;
+    }
+
+    // Sort the crossings, insertion sort as the order rarely changes between scanlines
+    for (uint32_t i = 1; i < na; i++) {
+      tft_edge e = edges[i];
+      uint32_t j = i;
+      while ((j > 0) && (edges[j - 1].x > e.x)) { edges[j] = edges[j - 1]; j--; }
+      edges[j] = e;
+    }
+
+    // Fill between crossings, pixel x is inside a span if x + 0.5 lies in [left, right)
+    int32_t winding = 0;
+    for (uint32_t i = 0; i + 1 < na; i++) {
+      winding += edges[i].dir;
+      bool inside = (rule == TFT_FILL_NON_ZERO) ? (winding != 0) : (i & 1) == 0;
+      if (inside && (edges[i + 1].x > edges[i].x)) drawFastHLine(edges[i].x, y, edges[i + 1].x - edges[i].x, color);
+    }
+
+    // Step each edge to the next scanline
+    for (uint32_t i = 0; i < na; i++) {
+      tft_edge &e = edges[i];
+      e.x += e.sx;
+      e.r -= e.sr;
+      if (e.r < 0) { e.r += e.d; e.x++; }
+    }
+  }
+
+  spi_endTransaction();
+
+  if (edges != stack) free(edges);
+}
+
+// Integer square root
+static uint32_t wedgeSqrt(uint64_t v) {
+  uint64_t r = 0, bit = (uint64_t)1 << 62;
+  while (bit > v) bit >>= 2;
+  while (bit) {
+    if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+    else r >>= 1;
+    bit >>= 2;
+  }
+  return r;
+}
+
+// Division rounded towards minus infinity
+static int64_t wedgeFloorDiv(int64_t a, int64_t b) {
+  if (b < 0) { a = -a; b = -b; }
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// Narrow the pixel range lo..hi to the pixels x where c + d * x >= 0
+static void wedgeClip(int32_t &lo, int32_t &hi, int64_t c, int64_t d) {
+  if (d > 0) {
+    int64_t x = -wedgeFloorDiv(c, d);
+    if (x > lo) lo = (x > hi) ? hi + 1 : x;
+  }
+  else if (d < 0) {
+    int64_t x = wedgeFloorDiv(c, -d);
+    if (x < hi) hi = (x < lo) ? lo - 1 : x;
+  }
+  else if (c < 0) hi = lo - 1;
+}
+
+// Narrow the pixel range lo..hi to the pixels within r of a centre at cx, on a row dy from it
+static void wedgeCircle(int32_t &lo, int32_t &hi, int32_t cx, int32_t dy, int32_t r) {
+  int64_t q = (int64_t)r * r - (int64_t)dy * dy;
+  if ((r < 0) || (q < 0)) { hi = lo - 1; return; }
+
+  int32_t hw = wedgeSqrt(q);
+  lo = std::max<int32_t>(lo, -wedgeFloorDiv(hw - cx, 256));
+  hi = std::min<int32_t>(hi,  wedgeFloorDiv(cx + hw, 256));
+}
+
+// Wedge in 1/256 pixel units, u is the unit vector from a to b scaled by 4096 and len is the distance a to b
+struct tft_wedge {
+  int32_t ax, ay, bx, by, ar, br;
+  int32_t ux, uy, len;
+};
+
+// Coverage of pixel x, y in 1/256ths, the radius at the nearest point of the axis less the distance to it, plus 0.5
+// s is the distance along the axis from a scaled by 4096, pixels before a are nearest to a and those past b to b
+static int32_t wedgeCoverage(const tft_wedge &w, int32_t x, int32_t y) {
+  int32_t dx = x * 256 - w.ax, dy = y * 256 - w.ay;
+  int64_t s  = (int64_t)dx * w.ux + (int64_t)dy * w.uy;
+  int64_t l  = (int64_t)w.len << 12;
+
+  if (s <= 0) return w.ar + 128 - (int32_t)wedgeSqrt((int64_t)dx * dx + (int64_t)dy * dy);
+
+  if (s >= std::max<int64_t>(l, 1)) {
+    dx = x * 256 - w.bx;
+    dy = y * 256 - w.by;
+    return w.br + 128 - (int32_t)wedgeSqrt((int64_t)dx * dx + (int64_t)dy * dy);
+  }
+
+  int64_t n = (int64_t)dy * w.ux - (int64_t)dx * w.uy;
+  if (n < 0) n = -n;
+  return w.ar + (int32_t)((int64_t)(w.br - w.ar) * s / l) + 128 - (int32_t)(n >> 12);
+}
+
+// Draw an anti-aliased line with round ends
+void TFT_eSPI::drawWideLine(float ax, float ay, float bx, float by, float wd, uint32_t fg_color, uint32_t bg_color) {
+  drawWedgeLine(ax, ay, bx, by, wd / 2.0f, wd / 2.0f, fg_color, bg_color);
+}
+
+// Draw an anti-aliased wedge in fixed point, each row is split into spans by coverage: runs outside are skipped,
+// runs wholly inside are filled by drawFastHLine and only the edge pixels between them are blended
+// The row is cut where it crosses the normals at a and b, within each part the span ends come from a circle
+// or from two half-planes, so only edge pixels need their coverage worked out
+void TFT_eSPI::drawWedgeLine(float ax, float ay, float bx, float by, float ar, float br, uint32_t fg_color, uint32_t bg_color) {
+  const float lim = TFT_AA_LIMIT;
+  if (!((ar >= 0.0f) && (ar <= lim) && (br >= 0.0f) && (br <= lim))) return;
+  if (!((ax >= -lim) && (ax <= lim) && (ay >= -lim) && (ay <= lim))) return;
+  if (!((bx >= -lim) && (bx <= lim) && (by >= -lim) && (by <= lim))) return;
+
+  auto fixed = [](float v) { return (int32_t)(v * 256.0f + ((v < 0.0f) ? -0.5f : 0.5f)); };
+
+  tft_wedge w;
+  w.ax = fixed(ax); w.ay = fixed(ay); w.ar = fixed(ar);
+  w.bx = fixed(bx); w.by = fixed(by); w.br = fixed(br);
+
+  int32_t bax = w.bx - w.ax, bay = w.by - w.ay;
+  w.len = wedgeSqrt((int64_t)bax * bax + (int64_t)bay * bay);
+  w.ux  = w.len ? (int32_t)(((int64_t)bax << 12) / w.len) : 4096;
+  w.uy  = w.len ? (int32_t)(((int64_t)bay << 12) / w.len) : 0;
+
+  int64_t l  = (int64_t)w.len << 12;
+  int64_t lb = std::max<int64_t>(l, 1);
+  int32_t dr = w.br - w.ar;
+
+  // Only the rows and columns of a RAM tile can be drawn while one is active
+  int32_t left = 0, top = 0, right = _width - 1, bottom = _height - 1;
+  if (_tile) {
+    left  = _tileX; right  = _tileX + _tileW - 1;
+    top   = _tileY; bottom = _tileY + _tileH - 1;
+  }
+
+  int32_t y0 = std::max<int32_t>(-wedgeFloorDiv(128 - std::min(w.ay - w.ar, w.by - w.br), 256), top);
+  int32_t y1 = std::min<int32_t>(wedgeFloorDiv(std::max(w.ay + w.ar, w.by + w.br) + 128, 256), bottom);
+
+  uint16_t fg = fg_color;
+  uint16_t line[TFT_AA_SPAN];
+  uint8_t  alpha[TFT_AA_SPAN];
+
+  // Blend the edge pixels xa..xb of row y, the background is read once per run if no color was given
+  auto edge = [&](int32_t xa, int32_t xb, int32_t y) {
+    while (xa <= xb) {
+      int32_t n = std::min<int32_t>(xb - xa + 1, TFT_AA_SPAN);
+
+      int32_t first = n, last = -1;
+      for (int32_t i = 0; i < n; i++) {
+        int32_t c = wedgeCoverage(w, xa + i, y);
+        alpha[i] = (c <= TFT_AA_LOW) ? 0 : (c >= TFT_AA_HIGH) ? 255 : c;
+        if (alpha[i]) { if (first == n) first = i; last = i; }
+      }
+
+      if (last >= 0) {
+        if (bg_color == 0x00FFFFFF) readRect(xa + first, y, last - first + 1, 1, line + first);
+        else for (int32_t i = first; i <= last; i++) line[i] = bg_color;
+        alphaBlendRow(alpha + first, fg, line + first, line + first, last - first + 1);
+
+        // Each run of covered pixels is pushed through one window
+        for (int32_t i = first; i <= last; ) {
+          if (!alpha[i]) { i++; continue; }
+          int32_t j = i;
+          for (; (j <= last) && alpha[j]; j++) {
+            uint16_t c = (alpha[j] == 255) ? fg : line[j];
+            line[j] = _swapBytes ? (uint16_t)(c >> 8 | c << 8) : c;
+          }
+          setWindow(xa + i, y, xa + j - 1, y);
+          pushColors(line + i, j - i);
+          i = j;
+        }
+      }
+      xa += n;
+    }
+  };
+
+  spi_beginTransaction();
+
+  for (int32_t y = y0; y <= y1; y++) {
+    int32_t dy = y * 256 - w.ay;
+
+    // Distances along and across the axis (scaled by 4096) are linear along the row: s0 + sx * x, n0 + nx * x
+    int64_t sx = 256 * (int64_t)w.ux, s0 = (int64_t)dy * w.uy - (int64_t)w.ax * w.ux;
+    int64_t nx = -256 * (int64_t)w.uy, n0 = (int64_t)dy * w.ux + (int64_t)w.ax * w.uy;
+
+    // Parts of the row nearest to a, to the body and to b, as wedgeCoverage() divides them
+    int32_t lo[3], hi[3];
+    for (int i = 0; i < 3; i++) { lo[i] = left; hi[i] = right; }
+    wedgeClip(lo[0], hi[0], -s0, -sx);
+    wedgeClip(lo[1], hi[1], s0 - 1, sx);
+    wedgeClip(lo[1], hi[1], l - 1 - s0, -sx);
+    wedgeClip(lo[2], hi[2], s0 - lb, sx);
+
+    // Pixels with any coverage are within radius + 0.5 of the axis, those fully covered within radius - 0.5
+    // In the body the radius changes along the axis, each side is a half-plane scaled by len * 4096
+    int32_t outLo[3], outHi[3], inLo[3], inHi[3];
+    for (int i = 0; i < 3; i++) { outLo[i] = inLo[i] = lo[i]; outHi[i] = inHi[i] = hi[i]; }
+
+    wedgeCircle(outLo[0], outHi[0], w.ax, dy, w.ar + 128);
+    wedgeCircle(inLo[0],  inHi[0],  w.ax, dy, w.ar - 128);
+    wedgeCircle(outLo[2], outHi[2], w.bx, y * 256 - w.by, w.br + 128);
+    wedgeCircle(inLo[2],  inHi[2],  w.bx, y * 256 - w.by, w.br - 128);
+
+    int64_t c = (int64_t)dr * s0, d = (int64_t)dr * sx;
+    int64_t nc = w.len * n0, nd = w.len * nx;
+    wedgeClip(outLo[1], outHi[1], (w.ar + 128) * l + c - nc, d - nd);
+    wedgeClip(outLo[1], outHi[1], (w.ar + 128) * l + c + nc, d + nd);
+    wedgeClip(inLo[1],  inHi[1],  (w.ar - 128) * l + c - nc, d - nd);
+    wedgeClip(inLo[1],  inHi[1],  (w.ar - 128) * l + c + nc, d + nd);
+
+    int32_t xl = _width, xr = -1;
+    for (int i = 0; i < 3; i++) {
+      if (outLo[i] > outHi[i]) continue;
+      xl = std::min(xl, outLo[i]);
+      xr = std::max(xr, outHi[i]);
+    }
+    if (xl > xr) continue;
+
+    // The parts run left to right from a to b if the axis points right, so do their fully covered spans
+    int32_t x = xl;
+    for (int k = 0; k < 3; k++) {
+      int i = (sx >= 0) ? k : 2 - k;
+      if (inLo[i] > inHi[i]) continue;
+
+      if (inLo[i] > x) edge(x, inLo[i] - 1, y);
+      int32_t xs = inLo[i], xe = inHi[i];
+
+      // Join the span of the next part if it starts on the following pixel
+      while (k < 2) {
+        int j = (sx >= 0) ? k + 1 : 1 - k;
+        if ((inLo[j] > inHi[j]) || (inLo[j] != xe + 1)) break;
+        xe = inHi[j];
+        k++;
+      }
+
+      drawFastHLine(xs, y, xe - xs + 1, fg);
+      x = xe + 1;
+    }
+    if (x <= xr) edge(x, xr, y);
+  }
+
+  spi_endTransaction();
+}
+
+// Blend with the foreground split into its red and blue, and its green, red and blue are blended together
+// in one word with the 6 bits gap between them taking the products, green on its own with the full alpha
+static inline uint16_t blendSplit(uint32_t alpha, uint32_t frb, uint32_t fxg, uint32_t bgc) {
+  uint32_t rxb = bgc & 0xF81F;
+  rxb += (frb - rxb) * (alpha >> 2) >> 6;
+  uint32_t xgx = bgc & 0x07E0;
+  xgx += (fxg - xgx) * alpha >> 8;
+  return (rxb & 0xF81F) | (xgx & 0x07E0);
+}
+
+// Two pixels read or written as one word, the first in the low half as both the RP2040 and hosts are little endian
+typedef uint32_t __attribute__((may_alias)) blend_pair;
+
+// Red and blue of one pixel, as blendSplit()
+static inline uint32_t blendRB(uint32_t alpha, uint32_t frb, uint32_t bgc) {
+  uint32_t rxb = bgc & 0xF81F;
+  rxb += (frb - rxb) * (alpha >> 2) >> 6;
+  return rxb & 0xF81F;
+}
+
+// Blend a pair of pixels, red and blue a pixel at a time and both greens in the 16-bit lanes of one word
+// fgg holds the two foreground greens at bit 0 of each lane. Each lane is computed as
+// gb * 256 + (gf - gb) * a, which is gf * a + gb * (256 - a) < 2^14, and its top 6 bits are those of blendSplit()
+// The difference is biased by 64 so the lanes stay positive, and the bias times alpha is taken off once both
+// lanes hold more than it, so no lane borrows from the other
+static inline uint32_t blendPair(uint32_t a0, uint32_t a1, uint32_t frb0, uint32_t frb1, uint32_t fgg, uint32_t bgw) {
+  uint32_t gb = bgw >> 5 & 0x003F003F;
+  uint32_t e  = fgg + 0x00400040 - gb;
+  uint32_t g  = ((e & 0xFFFF) * a0 | (e >> 16) * a1 << 16) + (gb << 8) - ((a0 | a1 << 16) << 6);
+
+  return blendRB(a0, frb0, bgw) | blendRB(a1, frb1, bgw >> 16) << 16 | (g >> 3 & 0x07E007E0);
+}
+
+// Ordered dither offsets for alphaBlendRowDither(), a 4x4 Bayer matrix
+static const uint8_t blendBayer[4][4] = {
+  {  0,  8,  2, 10 },
+  { 12,  4, 14,  6 },
+  {  3, 11,  1,  9 },
+  { 15,  7, 13,  5 }
+};
+
+// Thresholds for color24to16Row() from 0 to 31, an 8x8 Bayer matrix and a 16x16 blue noise matrix made by
+// void-and-cluster, which has no regular pattern to pick out
+static const uint8_t ditherBayer[8][8] = {
+  {  0, 16,  4, 20,  1, 17,  5, 21 },
+  { 24,  8, 28, 12, 25,  9, 29, 13 },
+  {  6, 22,  2, 18,  7, 23,  3, 19 },
+  { 30, 14, 26, 10, 31, 15, 27, 11 },
+  {  1, 17,  5, 21,  0, 16,  4, 20 },
+  { 25,  9, 29, 13, 24,  8, 28, 12 },
+  {  7, 23,  3, 19,  6, 22,  2, 18 },
+  { 31, 15, 27, 11, 30, 14, 26, 10 }
+};
+
+static const uint8_t ditherBlueNoise[16][16] = {
+  { 29,  6, 23,  2,  7, 21, 15,  5, 20,  0, 30, 13,  2, 16,  1,  8 },
+  { 26,  1, 14, 12, 30, 25,  2, 28, 17,  8, 15, 21,  9, 28, 12, 18 },
+  { 10, 17, 28, 20,  9, 18, 13, 10, 22, 27,  3, 28, 19, 25,  5, 22 },
+  {  3,  7, 24,  3,  5, 23,  0, 31,  5, 12, 23,  6, 10,  0, 16, 30 },
+  { 27, 19, 12, 31, 16, 27,  7, 25, 19,  1, 17, 14, 31, 21,  8, 13 },
+  {  5, 23,  0,  9, 21, 11, 17, 14, 10, 29, 26,  7, 18,  4, 25, 20 },
+  { 10, 15, 27, 14, 26,  1, 30,  3, 21,  5, 22,  2, 24, 12, 28,  2 },
+  { 30, 20,  7,  4, 19,  6, 22,  8, 27, 13, 15, 10, 29, 16,  6, 17 },
+  { 24,  1, 28, 16, 30, 11, 15, 24, 18,  0, 30, 20,  8,  1, 22, 13 },
+  {  5, 11, 22,  9, 24,  0, 27,  4, 11,  7, 25,  4, 26, 19, 29,  9 },
+  { 31, 15, 18,  3, 13,  7, 20, 14, 29, 22, 16, 12,  6, 14,  3, 20 },
+  {  2, 26,  6, 29, 25, 17, 31,  2,  9, 18,  1, 31, 23, 11, 25, 16 },
+  { 12, 23, 10, 21,  4, 11, 23,  6, 25, 12, 21,  8, 16,  0, 27,  7 },
+  { 28, 18,  0, 15, 28,  1, 19, 14, 29,  4, 27,  3, 29, 18, 21,  9 },
+  { 24,  4, 31,  8, 13, 24,  8, 22,  2, 17, 14, 19, 10,  5, 13,  3 },
+  { 15, 11, 19, 26, 17,  4, 30, 11, 26,  9, 24,  6, 26, 23, 31, 20 }
+};
+
+// Channel values scaled so an 8-bit value v is v * levels * 32 / 255, with red, green and blue placed in
+// 10, 11 and 10 bit lanes of a word. Adding a threshold to every lane then dropping 5 bits of each rounds all
+// three channels at once, the sums never carry between lanes
+// TFT_DITHER_NONE takes the nearest levels, in place in the 565 word. Adding half a level to the scaled values
+// would round up those within 1/64 level below half way, as the scale itself is rounded to 1/32 of a level
+struct tft_dither_scale {
+  uint32_t r[256], g[256], b[256];
+  uint16_t nr[256], ng[256], nb[256];
+  constexpr tft_dither_scale() : r(), g(), b(), nr(), ng(), nb() {
+    for (uint32_t v = 0; v < 256; v++) {
+      r[v] = (v * 31 * 32 + 127) / 255 << 21;
+      g[v] = (v * 63 * 32 + 127) / 255 << 10;
+      b[v] = (v * 31 * 32 + 127) / 255;
+      nr[v] = (v * 31 * 2 + 255) / 510 << 11;
+      ng[v] = (v * 63 * 2 + 255) / 510 << 5;
+      nb[v] = (v * 31 * 2 + 255) / 510;
+    }
+  }
+};
+static constexpr tft_dither_scale ditherScale;
+
+// Bit reversed nibbles, to read XBM bytes with the leftmost pixel in the top bit
+static const uint8_t bitmapReverse[16] = { 0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF };
+
+// Eight pixels of a bitmap row from bit p, leftmost in the top bit. The next byte is only read if it holds
+// bits before end, so a row is never read past its last byte
+static inline uint8_t bitmapByte(const uint8_t *row, uint32_t p, uint32_t end, bool lsbFirst) {
+  uint32_t b = p >> 3, s = p & 7;
+  uint32_t v = row[b];
+  if (s && ((b + 1) * 8 < end)) v = v << 8 | row[b + 1];
+  else v <<= 8;
+  if (lsbFirst) v = bitmapReverse[v >> 12 & 15] << 8 | bitmapReverse[v >> 8 & 15] << 12 |
+                    bitmapReverse[v >> 4 & 15] | bitmapReverse[v & 15] << 4;
+  return v >> (8 - s);
+}
+
+// Blend two 565 colors
+uint16_t TFT_eSPI::alphaBlend(uint8_t alpha, uint16_t fgc, uint16_t bgc) {
+  return blendSplit(alpha, fgc & 0xF81F, fgc & 0x07E0, bgc);
+}
+
+// Blend a row over one foreground color, the foreground is split once for the row
+// Pixel pairs are read and written as words if bg and out share alignment, blended by blendPair(), and pairs with no alpha are copied
+void TFT_eSPI::alphaBlendRow(const uint8_t *alpha, uint16_t fg, const uint16_t *bg, uint16_t *out, uint32_t n) {
+  uint32_t frb = fg & 0xF81F, fxg = fg & 0x07E0;
+  uint32_t fgg = (fxg >> 5) * 0x00010001;
+
+  if (!(((uintptr_t)bg ^ (uintptr_t)out) & 2)) {
+    if (((uintptr_t)out & 2) && n) { *out++ = blendSplit(*alpha++, frb, fxg, *bg++); n--; }
+
+    const blend_pair *b = (const blend_pair *)bg;
+    blend_pair *o = (blend_pair *)out;
+    for (; n >= 2; n -= 2, alpha += 2) {
+      uint32_t w = *b++;
+      if (alpha[0] | alpha[1]) w = blendPair(alpha[0], alpha[1], frb, frb, fgg, w);
+      *o++ = w;
+    }
+    bg  = (const uint16_t *)b;
+    out = (uint16_t *)o;
+  }
+
+  while (n--) *out++ = blendSplit(*alpha++, frb, fxg, *bg++);
+}
+
+// Blend a row with a foreground color per pixel, pairs are taken as words if all three rows share alignment
+void TFT_eSPI::alphaBlendRow(const uint8_t *alpha, const uint16_t *fg, const uint16_t *bg, uint16_t *out, uint32_t n) {
+  if (!((((uintptr_t)bg ^ (uintptr_t)out) | ((uintptr_t)fg ^ (uintptr_t)out)) & 2)) {
+    if (((uintptr_t)out & 2) && n) { *out++ = blendSplit(*alpha++, *fg & 0xF81F, *fg & 0x07E0, *bg++); fg++; n--; }
+
+    const blend_pair *f = (const blend_pair *)fg, *b = (const blend_pair *)bg;
+    blend_pair *o = (blend_pair *)out;
+    for (; n >= 2; n -= 2, alpha += 2, f++) {
+      uint32_t w = *b++;
+      if (alpha[0] | alpha[1]) {
+        uint32_t c = *f;
+        w = blendPair(alpha[0], alpha[1], c & 0xF81F, c >> 16 & 0xF81F, c >> 5 & 0x003F003F, w);
+      }
+      *o++ = w;
+    }
+    fg  = (const uint16_t *)f;
+    bg  = (const uint16_t *)b;
+    out = (uint16_t *)o;
+  }
+
+  while (n--) { *out++ = blendSplit(*alpha++, *fg & 0xF81F, *fg & 0x07E0, *bg++); fg++; }
+}
+
+// Blend a row with each alpha moved by up to +/-dither from a 4x4 ordered pattern, so smooth gradients do not
+// band. Pixel i is at screen position x + i, y, pixels with no alpha are left as the background
+void TFT_eSPI::alphaBlendRowDither(const uint8_t *alpha, uint16_t fg, const uint16_t *bg, uint16_t *out, uint32_t n,
+                                   int32_t x, int32_t y, uint8_t dither) {
+  uint32_t frb = fg & 0xF81F, fxg = fg & 0x07E0;
+  uint32_t fgg = (fxg >> 5) * 0x00010001;
+  const uint8_t *pattern = blendBayer[y & 3];
+
+  // Offsets by pixel position, so each alpha is moved by a table lookup
+  int32_t offset[4];
+  for (uint32_t k = 0; k < 4; k++) offset[k] = ((2 * pattern[k] - 15) * dither) >> 4;
+
+  auto moved = [&](uint32_t i) -> uint32_t {
+    int32_t a = alpha[i];
+    return a ? std::min<int32_t>(std::max<int32_t>(a + offset[(x + i) & 3], 0), 255) : 0;
+  };
+
+  uint32_t i = 0;
+  if (!(((uintptr_t)bg ^ (uintptr_t)out) & 2)) {
+    if (((uintptr_t)out & 2) && n) { out[0] = blendSplit(moved(0), frb, fxg, bg[0]); i = 1; }
+
+    for (; i + 2 <= n; i += 2) {
+      uint32_t w = *(const blend_pair *)(bg + i);
+      if (alpha[i] | alpha[i + 1]) w = blendPair(moved(i), moved(i + 1), frb, frb, fgg, w);
+      *(blend_pair *)(out + i) = w;
+    }
+  }
+
+  for (; i < n; i++) out[i] = blendSplit(moved(i), frb, fxg, bg[i]);
+}
+
+// Convert a row of r, g, b bytes to 565 colors, the pattern row and mask are picked before the loop so each pixel
+// is three table lookups, one threshold lookup spread to the three lanes by a multiply, and shifts
+// Without a pattern each pixel is the three nearest levels or'ed together
+void TFT_eSPI::color24to16Row(const uint8_t *rgb, uint16_t *out, uint32_t n, int32_t x, int32_t y, uint8_t dither) {
+  const uint8_t *pattern;
+  uint32_t mask;
+  if (dither == TFT_DITHER_BAYER) { pattern = ditherBayer[y & 7]; mask = 7; }
+  else if (dither == TFT_DITHER_BLUE_NOISE) { pattern = ditherBlueNoise[y & 15]; mask = 15; }
+  else {
+    for (uint32_t i = 0; i < n; i++, rgb += 3) out[i] = ditherScale.nr[rgb[0]] | ditherScale.ng[rgb[1]] | ditherScale.nb[rgb[2]];
+    return;
+  }
+
+  for (uint32_t i = 0; i < n; i++, rgb += 3) {
+    uint32_t w = ditherScale.r[rgb[0]] + ditherScale.g[rgb[1]] + ditherScale.b[rgb[2]] + pattern[(x + i) & mask] * 0x00200401;
+    out[i] = ((w >> 15) & 0xF800) | ((w >> 10) & 0x07E0) | ((w >> 5) & 0x001F);
+  }
+}
+
+// Push an image of r, g, b bytes clipped to the screen, converted into a line buffer a run at a time
+// The window is set once and each converted run continues where the last one stopped
+void TFT_eSPI::pushImage24(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t *rgb, uint8_t dither) {
+  int32_t x0 = std::max<int32_t>(x, 0), x1 = std::min<int32_t>(x + w, _width);
+  int32_t y0 = std::max<int32_t>(y, 0), y1 = std::min<int32_t>(y + h, _height);
+  if ((x0 >= x1) || (y0 >= y1)) return;
+
+  uint16_t line[TFT_DITHER_SPAN];
+
+  // The line holds colors, not a buffer in the byte order of the sketch
+  bool swap = _swapBytes;
+  _swapBytes = false;
+
+  spi_beginTransaction();
+  setWindow(x0, y0, x1 - 1, y1 - 1);
+
+  for (int32_t j = y0; j < y1; j++) {
+    const uint8_t *src = rgb + ((uint32_t)(j - y) * w + (x0 - x)) * 3;
+    for (int32_t i = x0; i < x1; i += TFT_DITHER_SPAN) {
+      int32_t n = std::min<int32_t>(x1 - i, TFT_DITHER_SPAN);
+      color24to16Row(src, line, n, i, j, dither);
+      pushColors(line, n);
+      src += n * 3;
+    }
+  }
+
+  spi_endTransaction();
+
+  _swapBytes = swap;
+}
+
+// Draw a bitmap with set bits in a color
+void TFT_eSPI::drawBitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint16_t fgcolor) {
+  drawBitmapBits(x, y, bitmap, 0, (w + 7) / 8, w, h, false, fgcolor);
+}
+
+// Draw a bitmap with set and clear bits in two colors
+void TFT_eSPI::drawBitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint16_t fgcolor, uint16_t bgcolor) {
+  drawBitmapBits(x, y, bitmap, 0, (w + 7) / 8, w, h, false, fgcolor, bgcolor);
+}
+
+// Draw an XBM bitmap with set bits in a color
+void TFT_eSPI::drawXBitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint16_t fgcolor) {
+  drawBitmapBits(x, y, bitmap, 0, (w + 7) / 8, w, h, true, fgcolor);
+}
+
+// Draw an XBM bitmap with set and clear bits in two colors
+void TFT_eSPI::drawXBitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint16_t fgcolor, uint16_t bgcolor) {
+  drawBitmapBits(x, y, bitmap, 0, (w + 7) / 8, w, h, true, fgcolor, bgcolor);
+}
+
+// Draw a 1bpp image clipped to the screen, a byte of pixels at a time
+// Transparent rows are scanned for runs with count leading zeros, a byte of clear or set bits is skipped or
+// added to the run in one step. Opaque rows expand each nibble through a table of four colors
+void TFT_eSPI::drawBitmapBits(int32_t x, int32_t y, const uint8_t *bitmap, int32_t sx, uint32_t stride, int32_t w, int32_t h,
+                              bool lsbFirst, uint16_t fg_color, uint32_t bg_color) {
+  int32_t x0 = std::max<int32_t>(x, 0), x1 = std::min<int32_t>(x + w, _width);
+  int32_t y0 = std::max<int32_t>(y, 0), y1 = std::min<int32_t>(y + h, _height);
+  if ((x0 >= x1) || (y0 >= y1) || (sx < 0)) return;
+
+  // Bit columns of the visible part
+  uint32_t p0 = sx + (x0 - x), end = sx + (x1 - x);
+  bitmap += (y0 - y) * stride;
+
+  if (bg_color == 0x00FFFFFF) {
+    spi_beginTransaction();
+
+    for (int32_t j = y0; j < y1; j++, bitmap += stride) {
+      int32_t run = -1;  // Bit column where the run of set bits being collected starts
+
+      for (uint32_t p = p0; p < end; p += 8) {
+        uint32_t n = std::min<uint32_t>(end - p, 8);
+        uint32_t v = (uint32_t)bitmapByte(bitmap, p, end, lsbFirst) << 24 & (0xFF000000u << (8 - n));
+
+        for (uint32_t k = 0; k < n; ) {
+          uint32_t s = v << k;
+          if (run < 0) {
+            uint32_t z = s ? __builtin_clz(s) : 32;
+            if (z >= n - k) break;
+            run = p + k + z;
+            k += z;
+          }
+          else {
+            uint32_t o = __builtin_clz(~s);
+            if (o >= n - k) break;
+            drawFastHLine(x + run - sx, j, p + k + o - run, fg_color);
+            run = -1;
+            k += o;
+          }
+        }
+      }
+
+      if (run >= 0) drawFastHLine(x + run - sx, j, end - run, fg_color);
+    }
+
+    spi_endTransaction();
+    return;
+  }
+
+  // Four pixels for each nibble
+  uint16_t nibble[16][4];
+  for (uint8_t i = 0; i < 16; i++) {
+    for (uint8_t k = 0; k < 4; k++) nibble[i][k] = (i & (8 >> k)) ? fg_color : (uint16_t)bg_color;
+  }
+
+  uint16_t line[TFT_BITMAP_SPAN];
+
+  // The line holds colors, not a buffer in the byte order of the sketch
+  bool swap = _swapBytes;
+  _swapBytes = false;
+
+  spi_beginTransaction();
+  setWindow(x0, y0, x1 - 1, y1 - 1);
+
+  for (int32_t j = y0; j < y1; j++, bitmap += stride) {
+    for (uint32_t p = p0; p < end; p += TFT_BITMAP_SPAN) {
+      uint32_t n = std::min<uint32_t>(end - p, TFT_BITMAP_SPAN);
+      for (uint32_t k = 0; k < n; k += 8) {
+        uint8_t v = bitmapByte(bitmap, p + k, end, lsbFirst);
+        memcpy(line + k, nibble[v >> 4], 8);
+        memcpy(line + k + 4, nibble[v & 15], 8);
+      }
+      pushColors(line, n);
+    }
+  }
+
+  spi_endTransaction();
+
+  _swapBytes = swap;
+}
+
+// Start drawing into a RAM copy of the screen
+bool TFT_eSPI::shadowBegin(uint16_t *buffer) {
+  if (_shadow) return true;
+
+  // The dirty bitmap has 32 tiles per row and TFT_SHADOW_ROWS rows, the screen must fit it in any rotation
+  int32_t side = std::max<int32_t>(_width, _height);
+  if ((side > 32 * TFT_SHADOW_TILE) || (side > TFT_SHADOW_ROWS * TFT_SHADOW_TILE)) return false;
+
+  _shadowOwned = (buffer == nullptr);
+  if (_shadowOwned) buffer = (uint16_t *)malloc((uint32_t)_width * _height * 2);
+  if (buffer == nullptr) return false;
+
+  _shadow   = buffer;
+  _shadowOn = true;
+  _flushRow = 0;
+  _winX = _winX0 = _winX1 = 0;
+  _winY = _winY0 = _winY1 = 0;
+
+  // Start from a black screen, the whole of it is sent by the first flush
+  memset(_shadow, 0, (uint32_t)_width * _height * 2);
+  shadow_mark(0, 0, _width, _height);
+  return true;
+}
+
+// Send anything outstanding and return to drawing straight to the display
+void TFT_eSPI::shadowEnd(void) {
+  if (!_shadow) return;
+
+  uint32_t budget = _flushBudget;
+  _flushBudget = 0;
+  flush();
+  _flushBudget = budget;
+
+  if (_shadowOwned) free(_shadow);
+  _shadow   = nullptr;
+  _shadowOn = false;
+}
+
+// Set the most bytes a flush() may send, 0 for no limit
+void TFT_eSPI::setFlushBudget(uint32_t maxBytes) {
+  _flushBudget = maxBytes;
+}
+
+// Bytes the next flush() will send, including the window commands
+uint32_t TFT_eSPI::flushBytes(void) {
+  if (!_shadow) return 0;
+  return shadow_rects(false);
+}
+
+// Send the changed tiles
+bool TFT_eSPI::flush(void) {
+  if (!_shadow) return true;
+
+  // Pixels are sent from the shadow buffer, which was clipped as it was drawn, so drawing must reach the display
+  // unclipped while this runs
+  bool swap = _swapBytes;
+  const TFT_eRegion *clip = _clip;
+  _shadowOn  = false;
+  _swapBytes = false;
+  _clip      = nullptr;
+
+  spi_beginTransaction();
+  shadow_rects(true);
+  spi_endTransaction();
+
+  _clip      = clip;
+  _swapBytes = swap;
+  _shadowOn  = true;
+
+  for (uint32_t r = 0; r < TFT_SHADOW_ROWS; r++) {
+    if (_dirty[r]) return false;
+  }
+  return true;
+}
+
+// Fill a clipped rectangle of the shadow buffer
+// A RAM tile only takes the part of the rectangle over it
+void TFT_eSPI::shadow_fill(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+  if (_tile) {
+    int32_t x0 = std::max<int32_t>(x, _tileX), x1 = std::min<int32_t>(x + w, _tileX + _tileW);
+    int32_t y0 = std::max<int32_t>(y, _tileY), y1 = std::min<int32_t>(y + h, _tileY + _tileH);
+    if ((x0 >= x1) || (y0 >= y1)) return;
+
+    uint16_t *p = _tile + (y0 - _tileY) * _tileW + (x0 - _tileX);
+    for (int32_t j = y0; j < y1; j++, p += _tileW) {
+      for (int32_t i = 0; i < x1 - x0; i++) p[i] = color;
+    }
+    return;
+  }
+
+  uint16_t *p = _shadow + y * _width + x;
+
+  for (int32_t j = 0; j < h; j++, p += _width) {
+    for (int32_t i = 0; i < w; i++) p[i] = color;
+  }
+
+  shadow_mark(x, y, w, h);
+}
+
+// Write pixels at the setWindow() position, wrapping within the window as the display does
+void TFT_eSPI::shadow_put(uint16_t color, uint32_t len) {
+  while (len--) {
+    if (_tile) {
+      int32_t tx = _winX - _tileX, ty = _winY - _tileY;
+      if ((tx >= 0) && (tx < _tileW) && (ty >= 0) && (ty < _tileH)) _tile[ty * _tileW + tx] = color;
+    }
+    else if ((_winX >= 0) && (_winX < _width) && (_winY >= 0) && (_winY < _height)) _shadow[_winY * _width + _winX] = color;
+
+    if (++_winX > _winX1) {
+      _winX = _winX0;
+      if (++_winY > _winY1) _winY = _winY0;
+    }
+  }
+}
+
+// Mark the tiles a rectangle touches as changed
+void TFT_eSPI::shadow_mark(int32_t x, int32_t y, int32_t w, int32_t h) {
+  if (_tile) return;  // Only a tile is being drawn, the shadow buffer is unchanged
+
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if ((x + w) > _width)  w = _width  - x;
+  if ((y + h) > _height) h = _height - y;
+  if ((w < 1) || (h < 1)) return;
+
+  uint32_t c0 = x / TFT_SHADOW_TILE, c1 = (x + w - 1) / TFT_SHADOW_TILE;
+  uint32_t r0 = y / TFT_SHADOW_TILE, r1 = (y + h - 1) / TFT_SHADOW_TILE;
+
+  uint32_t bits = ((c1 == 31) ? 0xFFFFFFFF : ((1ul << (c1 + 1)) - 1)) & ~((1ul << c0) - 1);
+  for (uint32_t r = r0; r <= r1; r++) _dirty[r] |= bits;
+}
+
+// Merge dirty tiles into rectangles, a run of tiles along a row is extended down while every tile
+// under it is dirty, so each rectangle needs one window. Rectangles are sent if send is true,
+// otherwise only counted. Returns the bytes sent or that would be sent within the flush budget
+uint32_t TFT_eSPI::shadow_rects(bool send) {
+  uint32_t copy[TFT_SHADOW_ROWS];
+  uint32_t *dirty = _dirty;
+  if (!send) {
+    memcpy(copy, _dirty, sizeof(copy));
+    dirty = copy;
+  }
+
+  uint32_t rows  = (_height + TFT_SHADOW_TILE - 1) / TFT_SHADOW_TILE;
+  uint32_t total = 0;
+
+  // Windows are counted as setAddrWindow() sends them, skipping a column or row range the panel already has
+  uint32_t col = addr_col, row = addr_row;
+
+  // Start where the last budget limited flush stopped so the bottom of the screen is not starved
+  if (_flushRow >= rows) _flushRow = 0;
+
+  for (uint32_t n = 0; n < rows; n++) {
+    uint32_t r = (_flushRow + n) % rows;
+
+    while (dirty[r]) {
+      // First run of dirty tiles in this row
+      uint32_t c0  = __builtin_ctz(dirty[r]);
+      uint32_t run = ~(dirty[r] >> c0);
+      uint32_t len = run ? __builtin_ctz(run) : 32 - c0;
+      uint32_t bits = ((len == 32) ? 0xFFFFFFFF : ((1ul << len) - 1)) << c0;
+
+      uint32_t r1 = r + 1;
+      while ((r1 < rows) && ((dirty[r1] & bits) == bits)) r1++;
+
+      int32_t x = c0 * TFT_SHADOW_TILE;
+      int32_t y = r * TFT_SHADOW_TILE;
+      int32_t w = std::min<int32_t>(len * TFT_SHADOW_TILE, _width - x);
+      int32_t h = std::min<int32_t>((r1 - r) * TFT_SHADOW_TILE, _height - y);
+
+      // Trim the rectangle to the tile rows that fit the budget, at least one row is always sent
+      if (_flushBudget && (total + TFT_WINDOW_BYTES + (uint32_t)w * h * 2 > _flushBudget)) {
+        uint32_t rowBytes = (uint32_t)w * TFT_SHADOW_TILE * 2;
+        uint32_t left = (_flushBudget > total + TFT_WINDOW_BYTES) ? _flushBudget - total - TFT_WINDOW_BYTES : 0;
+        uint32_t fit  = left / rowBytes;
+        if ((fit == 0) && (total == 0)) fit = 1;
+
+        if (fit == 0) {
+          if (send) _flushRow = r;
+          return total;
+        }
+
+        if (fit < r1 - r) {
+          r1 = r + fit;
+          h  = std::min<int32_t>(fit * TFT_SHADOW_TILE, _height - y);
+        }
+      }
+
+      for (uint32_t k = r; k < r1; k++) dirty[k] &= ~bits;
+      uint32_t wcol = (uint32_t)(uint16_t)(x + _xOffset) << 16 | (uint16_t)(x + w - 1 + _xOffset);
+      uint32_t wrow = (uint32_t)(uint16_t)(y + _yOffset) << 16 | (uint16_t)(y + h - 1 + _yOffset);
+      total += TFT_WINDOW_BYTES - ((wcol == col) ? 5 : 0) - ((wrow == row) ? 5 : 0) + (uint32_t)w * h * 2;
+      col = wcol;
+      row = wrow;
+
+      if (send) {
+        setAddrWindow(x, y, x + w - 1, y + h - 1);
+        for (int32_t j = 0; j < h; j++) pushColorsAsync(_shadow + (y + j) * _width + x, w);
+      }
+    }
+  }
+
+  if (send) _flushRow = 0;
+  return total;
+}
+
+// Clip drawing to a region, nullptr for none
+void TFT_eSPI::setClipRegion(const TFT_eRegion *region) {
+  _clip = region;
+}
+
+// Fill the parts of a rectangle inside the clip region, starting from the first band it reaches
+void TFT_eSPI::clip_fill(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  const TFT_eRegion *clip = _clip;
+  _clip = nullptr;
+
+  spi_beginTransaction();
+
+  const tft_region_rect *r = clip->rects();
+  for (uint16_t i = clip->find(y); (i < clip->count()) && (r[i].y0 < y + h); i++) {
+    int32_t x0 = std::max<int32_t>(x, r[i].x0), x1 = std::min<int32_t>(x + w, r[i].x1);
+    int32_t y0 = std::max<int32_t>(y, r[i].y0), y1 = std::min<int32_t>(y + h, r[i].y1);
+    if ((x0 < x1) && (y0 < y1)) fillRect(x0, y0, x1 - x0, y1 - y0, color);
+  }
+
+  spi_endTransaction();
+
+  _clip = clip;
+}
+
+// Push pixels at the setWindow() position, wrapping within the window as the display does
+// Each window row is cut to the band of the clip region holding it and the visible runs are sent through
+// their own windows, the colors come from data or bytes if given, otherwise color is repeated
+void TFT_eSPI::clip_put(uint16_t color, uint16_t *data, uint8_t *bytes, uint32_t len) {
+  const TFT_eRegion *clip = _clip;
+  _clip = nullptr;
+
+  // Sending a run moves the window when shadowed, so the clipped one is kept here
+  int32_t wx0 = _winX0, wx1 = _winX1, wy0 = _winY0, wy1 = _winY1;
+  int32_t x = _winX, y = _winY;
+
+  spi_beginTransaction();
+
+  while (len) {
+    int32_t n = std::min<int32_t>(len, std::max<int32_t>(wx1 - x + 1, 1));
+
+    const tft_region_rect *r;
+    uint16_t k = ((y >= 0) && (y < _height)) ? clip->row(y, &r) : 0;
+    for (uint16_t i = 0; (i < k) && (r[i].x0 < x + n); i++) {
+      int32_t a = std::max<int32_t>(std::max<int32_t>(x, r[i].x0), 0);
+      int32_t b = std::min<int32_t>(std::min<int32_t>(x + n, r[i].x1), _width);
+      if (a >= b) continue;
+
+      setWindow(a, y, b - 1, y);
+      if (data) pushColors(data + (a - x), b - a);
+      else if (bytes) pushColors(bytes + 2 * (a - x), 2 * (b - a));
+      else pushBlock(color, b - a);
+    }
+
+    if (data)  data  += n;
+    if (bytes) bytes += 2 * n;
+    len -= n;
+    x   += n;
+    if (x > wx1) {
+      x = wx0;
+      if (++y > wy1) y = wy0;
+    }
+  }
+
+  spi_endTransaction();
+
+  _winX0 = wx0; _winX1 = wx1; _winX = x;
+  _winY0 = wy0; _winY1 = wy1; _winY = y;
+  _clip = clip;
+}
+
+// Start drawing into a RAM tile, clipped to the screen, drawing goes through the shadow functions
+void TFT_eSPI::tileBegin(uint16_t *buffer, int32_t x, int32_t y, int32_t w, int32_t h) {
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if ((x + w) > _width)  w = _width  - x;
+  if ((y + h) > _height) h = _height - y;
+
+  _tile  = buffer;
+  _tileX = x; _tileY = y;
+  _tileW = std::max<int32_t>(w, 0);
+  _tileH = std::max<int32_t>(h, 0);
+  _tileShadowOn = _shadowOn;
+  _shadowOn = true;
+}
+
+// Push the tile as one window, to the shadow buffer if one is active
+void TFT_eSPI::tileEnd(void) {
+  if (!_tile) return;
+
+  uint16_t *buffer = _tile;
+  _tile     = nullptr;
+  _shadowOn = _tileShadowOn;
+  if ((_tileW < 1) || (_tileH < 1)) return;
+
+  // The tile holds colors, not a buffer in the byte order of the sketch
+  bool swap = _swapBytes;
+  _swapBytes = false;
+
+  spi_beginTransaction();
+  setWindow(_tileX, _tileY, _tileX + _tileW - 1, _tileY + _tileH - 1);
+  pushColors(buffer, (uint32_t)_tileW * _tileH);
+  spi_endTransaction();
+
+  _swapBytes = swap;
+}
+
+#include "Extensions/Bus.cpp"
+
+#include "Extensions/Terminal.cpp"
+
+#include "Extensions/ArcMeter.cpp"
+
+#include "Extensions/Path.cpp"
+
+#include "Extensions/Region.cpp"
+
+#include "Extensions/DisplayList.cpp"
+
+#include "Extensions/Gradient.cpp"
+
+#ifdef TFT_PIPELINE
+  #include "Extensions/Pipeline.cpp"
+#endif
+
+#ifdef TFT_PIO_SPI
+  #include "Extensions/PIO_SPI.cpp"
+#endif
+
 // Explanation:
-// TFT_eSPI Constructor: Initializes the GPIO pins and SPI interface.
+// TFT_eSPI Constructor: Takes the SPI instance, pins, clocks and panel geometry from a tft_bus_config, the default one is built from the macros.
+// cs_low, cs_high, dc_low, dc_high: Toggle CS and DC with single SIO set/clear writes using masks computed by the constructor.
 // spi_begin: Configures the GPIO pins and initializes SPI with the Raspberry Pi Pico API.
-// spi_beginTransaction & spi_endTransaction: Manage the CS pin for SPI communication.
-// spi_transfer: Handles sending and receiving data over SPI.
+// spi_beginTransaction & spi_endTransaction: Manage the CS pin for SPI communication, taking the port over from another display sharing it.
+// bus_claim & bus_release: Hand the port between displays, a display inside startWrite() sends its buffered bytes and releases CS before giving it up.
+// spi_transfer, spi_write, spi_flush: Stage bytes in a buffer and send them in large spi_write_blocking chunks.
+// spi_read: Sends any staged bytes, then clocks a byte in from the display.
+// startWrite & endWrite: Hold CS low across several drawing calls so their bytes are coalesced.
 // writecommand & writedata: Send commands or data to the display.
-// reset: Resets the TFT display by toggling the reset pin.
-// begin: Placeholder for further initialization steps specific to the display.
-// setRotation: Sets the rotation of the display and adjusts the width and height accordingly.
-// drawPixel: Draws a single pixel on the screen at the specified coordinates.
-// setAddrWindow: Defines the area of the screen where data will be written.
+// reset: Resets the TFT display by toggling the reset pin, the recovery time is left pending rather than slept.
+// bus_delay, bus_wait: Defer the next bus access so init delays add up and only block when the bus is needed.
+// begin: Starts the SPI bus, resets the display and sends the controller init table with commandList.
+// commandList: Sends a table of commands and arguments from TFT_Drivers/*_InitTable.h as FIFO bursts.
+// setRotation: Sets the rotation of the display and adjusts the width, height and RAM offsets accordingly.
+// width, height: Return the display size in the current rotation.
+// drawPixel: Draws a single pixel, writing any changed window and the color straight to the TX FIFO in one burst.
+// setWindow: Public access to setAddrWindow for sketches that push their own pixels.
+// setAddrWindow: Defines the area of the screen where data will be written, skipping CASET/RASET when unchanged.
 // fillRect: Draws a filled rectangle with the specified dimensions and color.
 // fillScreen: Fills the entire screen with a single color.
 // drawFastHLine: Draws a horizontal line on the display.
 // drawFastVLine: Draws a vertical line on the display.
+// drawPixels: Draws a list of points, sorted into raster order and merged into horizontal runs that share a window.
+// pushBlock: Streams a run of one color as 16-bit SPI frames, used by fillRect, fillScreen and the fast lines.
+// initDMA, deInitDMA: Claim and release a pair of DMA channels attached to the SPI transmit FIFO.
+// fillRectAsync: Fills a rectangle by DMA from a single color word, fillRect uses it for large areas when DMA is enabled.
+// pushColorsAsync: Pushes a pixel buffer by DMA, chaining it behind the buffer already on the wire for double buffering.
+// setSwapBytes, getSwapBytes: Select byte swapped pixel buffers, applied by the DMA bswap option for async pushes.
+// dmaBusy, dmaWait: Query or wait for completion of DMA transfers, the held CS is released once they complete.
 // pushColor, pushColors: These functions are used to push pixel data to the TFT display.
 // setBrightness: Adjusts the display brightness using PWM (if available).
-// readcommand8, read16, readID: Functions to read data or the ID from the TFT display.
+// readcommand8, read16, readID: Functions to read data or the ID from the TFT display, using the read clock.
+// readRect: Reads a rectangle of display RAM and converts the 18-bit pixels to 565 colors.
+// calibrateSPI: Steps the write and read clocks up separately while a readback test passes, keeping one step of margin.
+// fillPolygon: Fills a polygon by the even-odd or non-zero rule from a sorted edge table, one drawFastHLine per span.
+// drawWideLine, drawWedgeLine: Anti-aliased lines in fixed point, inner spans go to drawFastHLine and only edge pixels are blended.
+// alphaBlend: Blends two 565 colors by an 8-bit alpha, shared by the anti-aliased primitives and TFT_ePath.
+// alphaBlendRow, alphaBlendRowDither: Blend rows bit-exact with alphaBlend, taking pixel pairs as words with both greens blended in the 16-bit lanes of one word.
+// color24to16Row, pushImage24: Convert r, g, b rows to 565 with a Bayer or blue noise threshold added to all three channels in one word, no branches per pixel.
+// drawBitmap, drawXBitmap, drawBitmapBits: Draw 1bpp images, transparent ones as runs of set bits and opaque ones through a nibble to color table as one window.
+// TFT_eGradient: Color stops are interpolated into a line once, fill() finds each pixel's place on it and streams runs through two line buffers by DMA.
+// shadowBegin, shadowEnd: Redirect drawing to a RAM copy of the screen, marking the 16x16 tiles each primitive touches.
+// flush, flushBytes, setFlushBudget: Send dirty tiles merged into rectangles with one window each, within an optional byte budget.
+// tileBegin, tileEnd: Draw into a RAM tile through the shadow functions and push it as one window, readRect reads the tile so blending needs no readback.
+// setScrollArea, scroll, scrollRow, getScrollOffset: Hardware vertical scrolling, scrollRow maps a screen row to the RAM row drawn there, setScrollArea returns false for an area it cannot set.
 // invertDisplay: Inverts the display colors.
 // writecommand16, writedata16: Write 16-bit commands or data to the display.
-// drawCircle, fillCircle, fillCircleHelper: Functions to draw and fill circles on the display.
+// setClipRegion, clip_fill, clip_put: Clip drawing to a TFT_eRegion, fills are cut to its rectangles and pushed window rows to its bands.
+// drawCircle, fillCircle, fillCircleHelper: Functions to draw and fill circles on the display, drawCircle batches its points through drawPixels.
 
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/structs/sio.h"
 #include "pico/stdlib.h"
 
 // Define default pin numbers (you may need to adjust these for your setup)
@@ -20,6 +22,55 @@
 #define TFT_WIDTH  240
 #define TFT_HEIGHT 320
 
+// Select the display controller, its init table is sent by begin()
+#if !defined (ILI9341_DRIVER) && !defined (ST7789_DRIVER) && !defined (GC9A01_DRIVER)
+#define ILI9341_DRIVER
+#endif
+
+// Rows of controller RAM, a panel may show fewer of them than the controller holds
+// The default for tft_bus_config::ram_height, a panel described at run time can give its own
+#ifndef TFT_RAM_HEIGHT
+#if defined (GC9A01_DRIVER)
+#define TFT_RAM_HEIGHT 240
+#else
+#define TFT_RAM_HEIGHT 320
+#endif
+#endif
+
+// Memory Access Control (MADCTL) bits used by setRotation()
+#define TFT_MADCTL_MY  0x80
+#define TFT_MADCTL_MX  0x40
+#define TFT_MADCTL_MV  0x20
+#define TFT_MADCTL_ML  0x10
+#define TFT_MADCTL_BGR 0x08
+#define TFT_MADCTL_MH  0x04
+
+// Flag in an init table argument count to show a delay follows the arguments
+#define TFT_INIT_DELAY 0x80
+
+// Size of the staging buffer used to coalesce SPI writes within a transaction
+#ifndef TFT_SPI_BUFFER_SIZE
+#define TFT_SPI_BUFFER_SIZE 256
+#endif
+
+// Shadow framebuffer tiles are 16x16 pixels, the dirty bitmap covers up to 32x32 tiles (512x512 pixels)
+#define TFT_SHADOW_TILE 16
+#define TFT_SHADOW_ROWS 32
+
+// Fill rules for fillPolygon()
+#define TFT_FILL_EVEN_ODD 0
+#define TFT_FILL_NON_ZERO 1
+
+// Threshold patterns for color24to16Row() and pushImage24()
+#define TFT_DITHER_NONE       0
+#define TFT_DITHER_BAYER      1
+#define TFT_DITHER_BLUE_NOISE 2
+
+// Coverage in 1/256ths of a pixel at or below which an anti-aliased edge pixel is left alone, and at or above
+// which it is drawn in the foreground color
+#define TFT_AA_LOW  8
+#define TFT_AA_HIGH 248
+
 // Color definitions for easier coding
 #define TFT_BLACK       0x0000
 #define TFT_BLUE        0x001F
@@ -30,19 +81,82 @@
 #define TFT_YELLOW      0xFFE0
 #define TFT_WHITE       0xFFFF
 
+// Default SPI clocks, these can be replaced by values found with calibrateSPI()
+#ifndef SPI_FREQUENCY
+#define SPI_FREQUENCY 40000000
+#endif
+#ifndef SPI_READ_FREQUENCY
+#define SPI_READ_FREQUENCY 20000000
+#endif
+
+// SPI write and read clocks, as returned by calibrateSPI() for storage and passed to the constructor
+struct tft_spi_clocks {
+    uint32_t write_hz;
+    uint32_t read_hz;
+};
+
+// SPI bus, pins and panel geometry, passed to the constructor to drive a panel without rebuilding
+// spi is the SPI port number (0 or 1) rather than spi_inst_t* so the whole struct can be constexpr
+// Pins set to -1 are not connected, an init_table of nullptr selects the table of the build's driver
+struct tft_bus_config {
+    uint8_t spi;
+    int8_t cs, dc, rst, mosi, miso, sclk, backlight;
+    uint32_t write_hz, read_hz;
+    uint16_t width, height;          // Panel size in rotation 0
+    uint16_t col_offset, row_offset; // Position of the panel within the controller RAM in rotation 0
+    const uint8_t *init_table;
+    uint16_t ram_height;             // Rows of controller RAM, 0 for TFT_RAM_HEIGHT
+};
+
+// Configuration built from the pin, size and clock macros above
+#define TFT_BUS_CONFIG_DEFAULT { 0, TFT_CS, TFT_DC, TFT_RST, TFT_MOSI, TFT_MISO, TFT_SCLK, BACKLIGHT_PIN, \
+                                 SPI_FREQUENCY, SPI_READ_FREQUENCY, TFT_WIDTH, TFT_HEIGHT, 0, 0, nullptr, TFT_RAM_HEIGHT }
+
+// Point used by the batched drawing functions
+struct tft_point {
+    int16_t x, y;
+};
+
+// Point with its own color used by the batched drawing functions
+struct tft_pixel {
+    int16_t x, y;
+    uint16_t color;
+};
+
+class TFT_eRegion;
+
 class TFT_eSPI {
 public:
     TFT_eSPI(); // Constructor
+    TFT_eSPI(const tft_spi_clocks &clocks); // Constructor using stored clocks from calibrateSPI()
+    TFT_eSPI(const tft_bus_config &config); // Constructor for a panel described at run time
+    ~TFT_eSPI(); // Destructor
 
     // Initialize the display
     void begin();
 
+    // Begin and end a write transaction, CS stays low and writes are buffered until endWrite()
+    void startWrite(void);
+    void endWrite(void);
+
+    // Send a table of commands in the commandList() format, see TFT_Drivers/*_InitTable.h
+    void commandList(const uint8_t *addr);
+
     // Set the display rotation
     void setRotation(uint8_t r);
 
+    // Get the display width and height in the current rotation
+    int16_t width(void);
+    int16_t height(void);
+
     // Push a single color pixel to the display
     void drawPixel(int32_t x, int32_t y, uint32_t color);
 
+    // Draw a list of points, the array is sorted into raster order and adjacent pixels are sent as runs
+    // Where a point is listed more than once the last of its colors is drawn, as drawing them in turn would
+    void drawPixels(tft_point *points, uint32_t n, uint32_t color);
+    void drawPixels(tft_pixel *pixels, uint32_t n);
+
     // Fill the screen with a single color
     void fillScreen(uint32_t color);
 
@@ -55,6 +169,31 @@ public:
     // Draw a vertical line
     void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
 
+    // Fill a rectangle by DMA and return immediately, falls back to fillRect() if DMA is not enabled
+    void fillRectAsync(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+
+    // Push a buffer of pixels to the current address window by DMA, a second call chains its buffer
+    // behind the first and returns once the first has been sent, so the two buffers can alternate
+    void pushColorsAsync(uint16_t *data, uint32_t len);
+
+    // Set or get whether pixel buffers hold colors with the bytes swapped
+    void setSwapBytes(bool swap);
+    bool getSwapBytes(void);
+
+    // Claim or release DMA channels for pixel transfers, initDMA() returns true if they were claimed
+    bool initDMA(void);
+    void deInitDMA(void);
+
+    // Check if a DMA transfer is in progress, or wait for it to complete
+    bool dmaBusy(void);
+    void dmaWait(void);
+
+    // Set the window that following pushBlock/pushColors/pushColorsAsync calls fill, in raster order
+    void setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+
+    // Push a block of len pixels of the same color to the current address window
+    void pushBlock(uint16_t color, uint32_t len);
+
     // Push a single color to the current pixel position
     void pushColor(uint16_t color);
 
@@ -70,6 +209,43 @@ public:
     uint16_t read16(uint8_t cmd);
     uint32_t readID(void);
 
+    // Read a rectangle of pixels from the display as 565 colors
+    void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
+
+    // Find and apply the fastest reliable write and read clocks, store the result to skip this on later boots
+    // The top left corner of the screen is overwritten by the test pattern
+    tft_spi_clocks calibrateSPI(uint32_t minFreq = 10000000, uint32_t maxFreq = 80000000, uint32_t stepFreq = 2000000);
+
+    // Draw into a RAM copy of the screen, flush() then sends only the 16x16 tiles that changed
+    // buffer must hold width * height pixels, one is allocated if it is nullptr
+    // The buffer is in the current rotation, changing rotation marks the whole screen as changed
+    // Returns false if the buffer cannot be allocated or a side of the screen is over 512 pixels
+    bool shadowBegin(uint16_t *buffer = nullptr);
+    void shadowEnd(void);
+
+    // Send the changed tiles merged into rectangles, returns true if none are left
+    // Each call sends at most the budget, the remaining tiles are sent by the following calls
+    bool flush(void);
+
+    // Number of bytes the next flush() will send, and the budget for a flush (0 for no limit)
+    uint32_t flushBytes(void);
+    void setFlushBudget(uint32_t maxBytes);
+
+    // Hardware vertical scrolling, in rotation 0 only as the controller scrolls its RAM rows
+    // top and bottom are the heights of the fixed areas, the rows between them scroll
+    // Returns false and leaves the area as it was if no rows would scroll, or if the panel's rows run past the
+    // controller RAM rows of tft_bus_config::ram_height
+    bool setScrollArea(uint16_t top, uint16_t bottom);
+
+    // Scroll the area up by n rows, or down if n is negative
+    void scroll(int32_t n);
+
+    // Row in display RAM that shows at screen row y, draw there to appear at y
+    int32_t scrollRow(int32_t y);
+
+    // Number of rows the area has been scrolled up by
+    uint16_t getScrollOffset(void);
+
     // Invert the display colors
     void invertDisplay(bool i);
 
@@ -82,36 +258,221 @@ public:
     void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
     void fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t corners, int32_t delta, uint32_t color);
 
+    // Fill a polygon, a pixel is filled if its centre is inside by the fill rule, each scanline is sent as spans
+    // Polygons sharing an edge do not overlap, so shapes can be built from several without overdraw
+    void fillPolygon(const tft_point *points, uint32_t n, uint32_t color, uint8_t rule = TFT_FILL_EVEN_ODD);
+
+    // Draw an anti-aliased line of width wd with round ends, or a wedge with end radii ar and br
+    // Coordinates have sub-pixel precision, pixel centres are on whole numbers, and are limited to +/-8191
+    // Edge pixels are blended with bg_color, or with the screen read back a row segment at a time if it is 0x00FFFFFF
+    void drawWideLine(float ax, float ay, float bx, float by, float wd, uint32_t fg_color, uint32_t bg_color = 0x00FFFFFF);
+    void drawWedgeLine(float ax, float ay, float bx, float by, float ar, float br, uint32_t fg_color, uint32_t bg_color = 0x00FFFFFF);
+
+    // Blend two colors, alpha 255 gives the foreground and 0 the background
+    uint16_t alphaBlend(uint8_t alpha, uint16_t fgc, uint16_t bgc);
+
+    // Blend n pixels of bg by a row of alphas into out, over one foreground color or a row of them
+    // The results match alphaBlend() bit for bit, out may be bg to blend in place
+    void alphaBlendRow(const uint8_t *alpha, uint16_t fg, const uint16_t *bg, uint16_t *out, uint32_t n);
+    void alphaBlendRow(const uint8_t *alpha, const uint16_t *fg, const uint16_t *bg, uint16_t *out, uint32_t n);
+
+    // As alphaBlendRow() with each non-zero alpha moved by up to +/-dither by an ordered pattern at screen
+    // position x + i, y, to break up banding in gradients
+    void alphaBlendRowDither(const uint8_t *alpha, uint16_t fg, const uint16_t *bg, uint16_t *out, uint32_t n,
+                             int32_t x, int32_t y, uint8_t dither);
+
+    // Convert n pixels of 8-bit r, g, b bytes to 565 colors, each channel is rounded by a threshold from the pattern
+    // at screen position x + i, y so gradients and photos dither rather than band
+    void color24to16Row(const uint8_t *rgb, uint16_t *out, uint32_t n, int32_t x, int32_t y, uint8_t dither = TFT_DITHER_BLUE_NOISE);
+
+    // Push a w x h image of 8-bit r, g, b bytes, converted a run at a time by color24to16Row()
+    void pushImage24(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t *rgb, uint8_t dither = TFT_DITHER_BLUE_NOISE);
+
+    // Draw a 1bpp bitmap of rows (w + 7) / 8 bytes long, the leftmost pixel of each byte is the top bit, or the
+    // bottom bit for drawXBitmap(). Set bits are drawn in fgcolor, clear bits in bgcolor or left as they are
+    void drawBitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint16_t fgcolor);
+    void drawBitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint16_t fgcolor, uint16_t bgcolor);
+    void drawXBitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint16_t fgcolor);
+    void drawXBitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint16_t fgcolor, uint16_t bgcolor);
+
+    // Draw w x h pixels of a 1bpp image from bit column sx of rows stride bytes apart, for 1bpp sprites and
+    // icon fonts whose glyphs sit side by side in one strip. lsbFirst selects the XBM bit order
+    // With bg_color 0x00FFFFFF set bits are drawn as horizontal runs and clear bits left, otherwise whole bytes
+    // are expanded to colors into a line buffer and the bitmap is pushed as one window
+    void drawBitmapBits(int32_t x, int32_t y, const uint8_t *bitmap, int32_t sx, uint32_t stride, int32_t w, int32_t h,
+                        bool lsbFirst, uint16_t fg_color, uint32_t bg_color = 0x00FFFFFF);
+
+    // Clip drawing to a region, nullptr draws everywhere again. The region is used in place so it must stay valid
+    // while set, and can be changed between frames. Fills, lines and pixels are cut to its rectangles, and pixels
+    // pushed through setWindow() are sent as the parts of each window row inside it
+    void setClipRegion(const TFT_eRegion *region);
+
+    // Draw into a RAM tile covering x, y, w, h of the screen instead of the display, buffer holds w * h pixels
+    // Drawing outside the tile is dropped and readRect() reads the tile, so anti-aliased edges are blended
+    // without reading the display. tileEnd() pushes the tile as one window, only drawing calls may come between
+    void tileBegin(uint16_t *buffer, int32_t x, int32_t y, int32_t w, int32_t h);
+    void tileEnd(void);
+
 private:
     // SPI and GPIO related functions
     void spi_begin();
     void spi_beginTransaction();
     void spi_endTransaction();
     void spi_transfer(uint8_t data);
-    uint8_t spi_transfer(uint8_t data);
+    void spi_write(const uint8_t *data, uint32_t len);
+    void spi_flush(void);
+    uint8_t spi_read(uint8_t data);
+    void spi_read_begin(void);
+    void spi_read_end(void);
+    void spi_put8(uint8_t data);
+    void spi_idle(void);
+    void spi_command_raw(uint8_t c);
+    void spi_begin16(void);
+    void spi_end16(void);
+    void cs_low(void)  { sio_hw->gpio_clr = _csMask; }
+    void cs_high(void) { sio_hw->gpio_set = _csMask; }
+    void dc_low(void)  { sio_hw->gpio_clr = _dcMask; }
+    void dc_high(void) { sio_hw->gpio_set = _dcMask; }
+    void dma_retire(void);
+    void dma_begin(void);
+    void bus_delay(uint32_t ms);
+    void bus_wait(void);
+    void bus_claim(void);
+    void bus_release(void);
 
     // Display control functions
     void reset(void);
     void writecommand(uint8_t c);
     void writedata(uint8_t d);
-    void setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+    void setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t ramCmd = 0x2C);
+    bool cal_test(void);
+    void shadow_fill(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color);
+    void shadow_put(uint16_t color, uint32_t len);
+    void shadow_mark(int32_t x, int32_t y, int32_t w, int32_t h);
+    uint32_t shadow_rects(bool send);
+    void clip_fill(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void clip_put(uint16_t color, uint16_t *data, uint8_t *bytes, uint32_t len);
+    uint32_t cal_sweep(uint32_t *freq, uint32_t minFreq, uint32_t maxFreq, uint32_t stepFreq, uint32_t id);
 
     // SPI instance and control pins
     spi_inst_t *_spi;
-    int8_t _cs, _dc, _rst, _mosi, _miso, _sclk;
+    uint32_t _writeFreq, _readFreq;
+    int8_t _cs, _dc, _rst, _mosi, _miso, _sclk, _bl;
+
+    // SIO masks for the CS and DC pins, so each toggle is a single register write
+    uint32_t _csMask, _dcMask;
+
+    // Display that last asserted CS on each SPI port, so panels sharing a bus hand it over cleanly
+    static TFT_eSPI *_busOwner[2];
+
+    // Init table sent by begin()
+    const uint8_t *_initTable;
 
-    // Display dimensions
+    // Staging buffer and nesting depth of the current write transaction
+    uint8_t  _txBuf[TFT_SPI_BUFFER_SIZE];
+    uint16_t _txLen;
+    uint8_t  _txDepth;
+
+    // Time in microseconds before which the display must not be sent anything, 0 if none
+    uint64_t _readyAt;
+
+    // Last column and row windows sent to the display as start << 16 | end, 0xFFFFFFFF if unknown
+    uint32_t addr_col, addr_row;
+
+    // DMA channel pair, _dmaTail indexes the channel last started (-1 if none)
+    // _dmaColor is the source word for DMA fills
+    int32_t  _dmaChannel[2];
+    dma_channel_config _dmaConfig[2];
+    int8_t   _dmaTail;
+    bool     _dmaEnabled, _dmaActive;
+    uint16_t _dmaColor;
+
+    // Pixel buffers hold colors with the bytes swapped
+    bool     _swapBytes;
+
+    // Shadow framebuffer, a bit per tile set in _dirty for each tile drawn since it was last sent
+    // _win* is the window set by setWindow() and the position the next pushed pixel is written to, also used while clipped
+    uint16_t *_shadow;
+    bool     _shadowOn, _shadowOwned;
+    uint32_t _dirty[TFT_SHADOW_ROWS];
+    uint32_t _flushBudget;
+    uint8_t  _flushRow;
+    int16_t  _winX0, _winY0, _winX1, _winY1, _winX, _winY;
+
+    // Clip region set by setClipRegion(), nullptr if drawing is not clipped
+    const TFT_eRegion *_clip;
+
+    // RAM tile set by tileBegin(), nullptr if none. Tiles are drawn through the shadow functions so _shadowOn is
+    // set while one is active, the value it had is kept in _tileShadowOn
+    uint16_t *_tile;
+    int16_t  _tileX, _tileY, _tileW, _tileH;
+    bool     _tileShadowOn;
+
+    // Hardware scroll fixed areas and the current offset within the scrolling area
+    uint16_t _scrollTop, _scrollBottom, _scrollOffset;
+
+    // Display dimensions, and panel size and RAM offsets in rotation 0
     uint16_t _width, _height;
+    uint16_t _initWidth, _initHeight;
+    uint16_t _colOffset, _rowOffset;
+    uint16_t _ramHeight;
+    uint16_t _xOffset, _yOffset;
     uint8_t rotation;
 };
 
+// Load the shared bus arbiter
+#include "Extensions/Bus.h"
+
+// Load the scrolling text terminal
+#include "Extensions/Terminal.h"
+
+// Load the ring meter
+#include "Extensions/ArcMeter.h"
+
+// Load the vector path renderer
+#include "Extensions/Path.h"
+
+// Load the clip region
+#include "Extensions/Region.h"
+
+// Load the retained display list
+#include "Extensions/DisplayList.h"
+
+// Load the multi-stop gradient
+#include "Extensions/Gradient.h"
+
+// Load the dual core pipeline if TFT_PIPELINE is defined, pico_multicore must then be linked
+#ifdef TFT_PIPELINE
+  #include "Extensions/Pipeline.h"
+#endif
+
+// Load the PIO SPI transmitter if TFT_PIO_SPI is defined, hardware_pio must then be linked
+#ifdef TFT_PIO_SPI
+  #include "Extensions/PIO_SPI.h"
+#endif
+
 #endif
 
 
 // Explanation of the Header File:
 // Class Declaration: The TFT_eSPI class contains all the necessary methods and properties for controlling the TFT display.
-// Constructor & Initialization: The constructor and begin method are defined for initializing the display and setting up the necessary SPI and GPIO configurations.
+// Constructor & Initialization: The constructors (default macros, stored clocks or a tft_bus_config) and begin method are defined for initializing the display and setting up the necessary SPI and GPIO configurations.
 // SPI Communication Methods: Functions like spi_begin, spi_beginTransaction, spi_endTransaction, and spi_transfer handle the SPI communication with the display.
+// Write Transactions: startWrite and endWrite hold CS low and stage bytes in _txBuf so they are sent in large spi_write_blocking chunks.
 // Display Control Methods: Functions such as setRotation, drawPixel, fillScreen, fillRect, etc., provide the interface for drawing on the display.
 // Utility Methods: Functions for setting brightness, inverting the display, and reading data or commands are also included.
-// GPIO and Pin Definitions: Pin definitions are included to set the default GPIO pins for SPI communication and control.
\ No newline at end of file
+// GPIO and Pin Definitions: Pin definitions are included to set the default GPIO pins for SPI communication and control.
+// Shared Bus: TFT_eSPI_Bus (Extensions/Bus.h) queues frame segments for several displays on one SPI port and keeps throughput and latency counters.
+// Dual Core Pipeline: With TFT_PIPELINE defined, TFT_eSPI_Pipeline (Extensions/Pipeline.h) queues draw calls on core 0 in the lock-free ring of Extensions/Ring.h for core 1 to send.
+// PIO SPI: With TFT_PIO_SPI defined, TFT_eSPI_PIO (Extensions/PIO_SPI.h) sends window commands and pixels in one chained DMA transfer, the DC level travels in the FIFO stream described in Extensions/DC_stream.h.
+// Shadow Framebuffer: shadowBegin redirects drawing to RAM and marks 16x16 tiles dirty, flush sends them as merged rectangles within a byte budget.
+// Hardware Scrolling: setScrollArea, scroll and scrollRow wrap VSCRDEF/VSCRSADD, TFT_eTerminal (Extensions/Terminal.h) writes one new line per scroll.
+// Anti-aliased Lines: drawWideLine and drawWedgeLine work in fixed point, filling inner spans and blending only the edge pixels.
+// Vector Paths: TFT_ePath (Extensions/Path.h) flattens lines and Bezier curves in fixed point and strokes or fills them anti-aliased by area coverage.
+// Ring Meter: TFT_eArcMeter (Extensions/ArcMeter.h) caches a ring's row spans and redraws only the arc between the old and new value.
+// Bus Configuration: tft_bus_config carries the SPI instance, pins, clocks, panel size, offsets and init table, TFT_BUS_CONFIG_DEFAULT builds one from the macros.
+// Clip Regions: TFT_eRegion (Extensions/Region.h) holds banded rectangles with union, subtract and intersect, setClipRegion cuts fills, lines and pushed windows to it.
+// Display Lists: TFT_eDisplayList (Extensions/DisplayList.h) records draw calls as bytecode and redraws only the calls whose boxes overlap what changed since the last frame.
+// RAM Tiles: tileBegin and tileEnd draw a screen tile in RAM, TFT_eDisplayList::endTiled bins recorded calls into tiles and composites each without reading the display.
+// Gradients: TFT_eGradient (Extensions/Gradient.h) interpolates color stops into a 256 entry line once and fills linear, radial or conic gradients from it, dithered to 565.
+// Bitmaps: drawBitmap, drawXBitmap and drawBitmapBits draw 1bpp images as runs of set bits, or opaque through a nibble table and one window.
@@ -0,0 +1,148 @@
+#ifndef _TFT_eSPI_MEM_DISPLAY_H_
+#define _TFT_eSPI_MEM_DISPLAY_H_
+
+// In-memory display with the calls tft_dlist_run() and TFT_eDisplayList::endTiled() make, so display lists
+// can be replayed on a host and compared pixel for pixel with drawing the same calls immediately
+// Drawing honours a clip region and a RAM tile as TFT_eSPI does, anti-aliased wedges blend with the pixels
+// under them, read from the tile while one is set
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "Extensions/Region.h"
+
+class MemDisplay
+{
+ public:
+  MemDisplay(int32_t w, int32_t h) : _w(w), _h(h), _fb(w * h, 0) {}
+
+  int16_t width(void)  { return _w; }
+  int16_t height(void) { return _h; }
+  uint16_t pixel(int32_t x, int32_t y) const { return _fb[y * _w + x]; }
+  const std::vector<uint16_t> &pixels(void) const { return _fb; }
+
+  void setClipRegion(const TFT_eRegion *region) { _clip = region; }
+
+  void tileBegin(uint16_t *buffer, int32_t x, int32_t y, int32_t w, int32_t h) {
+    _tile = buffer; _tx = x; _ty = y; _tw = w; _th = h;
+  }
+
+  // The tile is pushed as a window, its pixels beyond the screen are dropped
+  void tileEnd(void) {
+    uint16_t *t = _tile;
+    _tile = nullptr;
+    for (int32_t j = 0; j < _th; j++)
+      for (int32_t i = 0; i < _tw; i++) plot(_tx + i, _ty + j, t[j * _tw + i]);
+  }
+
+  void drawPixel(int32_t x, int32_t y, uint32_t color) { plot(x, y, color); }
+
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    int32_t x0 = std::max<int32_t>(x, 0), x1 = std::min<int32_t>((int64_t)x + w, _w);
+    int32_t y0 = std::max<int32_t>(y, 0), y1 = std::min<int32_t>((int64_t)y + h, _h);
+    for (int32_t j = y0; j < y1; j++)
+      for (int32_t i = x0; i < x1; i++) plot(i, j, color);
+  }
+
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fillRect(x, y, 1, h, color); }
+
+  // Pixels whose centres are within r + 0.5 of the centre, the outline is those with a neighbour outside
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+    for (int32_t dy = -r; dy <= r; dy++)
+      for (int32_t dx = -r; dx <= r; dx++) {
+        if (!inCircle(dx, dy, r)) continue;
+        if (inCircle(dx - 1, dy, r) && inCircle(dx + 1, dy, r) && inCircle(dx, dy - 1, r) && inCircle(dx, dy + 1, r)) continue;
+        plot(x0 + dx, y0 + dy, color);
+      }
+  }
+
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+    for (int32_t dy = -r; dy <= r; dy++)
+      for (int32_t dx = -r; dx <= r; dx++)
+        if (inCircle(dx, dy, r)) plot(x0 + dx, y0 + dy, color);
+  }
+
+  // Coverage from the distance to the wedge's edge, blended over bg_color, or the pixel under it if that is
+  // 0x00FFFFFF. Pixels are kept within the box TFT_eDisplayList records for a wedge
+  void drawWedgeLine(float ax, float ay, float bx, float by, float ar, float br, uint32_t fg_color, uint32_t bg_color = 0x00FFFFFF) {
+    int32_t x0 = floorf(std::min(ax - ar, bx - br)), x1 = ceilf(std::max(ax + ar, bx + br));
+    int32_t y0 = floorf(std::min(ay - ar, by - br)), y1 = ceilf(std::max(ay + ar, by + br));
+    float dx = bx - ax, dy = by - ay, len2 = dx * dx + dy * dy;
+
+    for (int32_t y = y0; y <= y1; y++)
+      for (int32_t x = x0; x <= x1; x++) {
+        float px = x - ax, py = y - ay;
+        float t = (len2 > 0.0f) ? std::min(std::max((px * dx + py * dy) / len2, 0.0f), 1.0f) : 0.0f;
+        float ex = px - t * dx, ey = py - t * dy;
+        float d = sqrtf(ex * ex + ey * ey) - (ar + t * (br - ar));
+        int32_t alpha = (int32_t)(std::min(std::max(0.5f - d, 0.0f), 1.0f) * 255.0f + 0.5f);
+        if (alpha == 0) continue;
+
+        uint16_t under = (bg_color == 0x00FFFFFF) ? read(x, y) : (uint16_t)bg_color;
+        plot(x, y, blend(alpha, fg_color, under));
+      }
+  }
+
+  void setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    _wx0 = x0; _wy0 = y0; _wx1 = x1; _wy1 = y1;
+    _wx = x0; _wy = y0;
+  }
+
+  void pushColors(const uint16_t *data, uint32_t len) {
+    while (len--) {
+      plot(_wx, _wy, *data++);
+      if (++_wx > _wx1) { _wx = _wx0; _wy++; }
+    }
+  }
+
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+    setWindow(x, y, x + w - 1, y + h - 1);
+    pushColors(data, (uint32_t)w * h);
+  }
+
+  void fillScreen(uint32_t color) { fillRect(0, 0, _w, _h, color); }
+
+ private:
+  static bool inCircle(int32_t dx, int32_t dy, int32_t r) { return dx * dx + dy * dy <= r * r + r; }
+
+  static uint16_t blend(int32_t alpha, uint16_t fg, uint16_t bg) {
+    int32_t r = ((fg >> 11) * alpha + (bg >> 11) * (255 - alpha) + 127) / 255;
+    int32_t g = ((fg >> 5 & 63) * alpha + (bg >> 5 & 63) * (255 - alpha) + 127) / 255;
+    int32_t b = ((fg & 31) * alpha + (bg & 31) * (255 - alpha) + 127) / 255;
+    return r << 11 | g << 5 | b;
+  }
+
+  uint16_t read(int32_t x, int32_t y) {
+    if (_tile) {
+      int32_t i = x - _tx, j = y - _ty;
+      return ((i >= 0) && (i < _tw) && (j >= 0) && (j < _th)) ? _tile[j * _tw + i] : 0;
+    }
+    return ((x >= 0) && (x < _w) && (y >= 0) && (y < _h)) ? _fb[y * _w + x] : 0;
+  }
+
+  void plot(int32_t x, int32_t y, uint16_t color) {
+    if (_tile) {
+      int32_t i = x - _tx, j = y - _ty;
+      if ((i >= 0) && (i < _tw) && (j >= 0) && (j < _th)) _tile[j * _tw + i] = color;
+      return;
+    }
+    if ((x < 0) || (x >= _w) || (y < 0) || (y >= _h)) return;
+    if (_clip && !_clip->contains(x, y)) return;
+    _fb[y * _w + x] = color;
+  }
+
+  int32_t _w, _h;
+  std::vector<uint16_t> _fb;
+
+  const TFT_eRegion *_clip = nullptr;
+
+  uint16_t *_tile = nullptr;
+  int32_t  _tx = 0, _ty = 0, _tw = 0, _th = 0;
+
+  int32_t  _wx0 = 0, _wy0 = 0, _wx1 = 0, _wy1 = 0, _wx = 0, _wy = 0;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef _STUB_HARDWARE_SPI_H
+#define _STUB_HARDWARE_SPI_H
+
+#include "pico/stdlib.h"
+
+// Writes to the data register clock a frame out to the emulated panel
+struct spi_dr_reg {
+  spi_dr_reg &operator=(uint32_t v);
+  operator uint32_t() const;
+};
+
+typedef struct {
+  volatile uint32_t cr0, cr1;
+  spi_dr_reg dr;
+  volatile uint32_t sr, cpsr, imsc, ris, mis, icr, dmacr;
+} spi_hw_t;
+
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t *spi0, *spi1;
+
+typedef enum { SPI_CPOL_0, SPI_CPOL_1 } spi_cpol_t;
+typedef enum { SPI_CPHA_0, SPI_CPHA_1 } spi_cpha_t;
+typedef enum { SPI_LSB_FIRST, SPI_MSB_FIRST } spi_order_t;
+
+#define SPI_SSPSR_BSY_BITS    0x10u
+#define SPI_SSPSR_RNE_BITS    0x04u
+#define SPI_SSPSR_TNF_BITS    0x02u
+#define SPI_SSPSR_TFE_BITS    0x01u
+#define SPI_SSPICR_RORIC_BITS 0x01u
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate);
+uint spi_get_baudrate(const spi_inst_t *spi);
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len);
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len);
+int spi_write16_blocking(spi_inst_t *spi, const uint16_t *src, size_t len);
+spi_hw_t *spi_get_hw(spi_inst_t *spi);
+uint spi_get_index(const spi_inst_t *spi);
+bool spi_is_writable(const spi_inst_t *spi);
+bool spi_is_readable(const spi_inst_t *spi);
+bool spi_is_busy(const spi_inst_t *spi);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _STUB_HARDWARE_STRUCTS_SIO_H
+#define _STUB_HARDWARE_STRUCTS_SIO_H
+
+#include <stdint.h>
+
+// Writes to the set and clear registers drive the emulated pins
+struct sio_set_reg { void operator=(uint32_t mask); };
+struct sio_clr_reg { void operator=(uint32_t mask); };
+
+typedef struct {
+  volatile uint32_t cpuid, gpio_in, gpio_hi_in, _pad, gpio_out;
+  sio_set_reg gpio_set;
+  sio_clr_reg gpio_clr;
+  volatile uint32_t gpio_togl, gpio_oe, gpio_oe_set, gpio_oe_clr;
+} sio_hw_t;
+
+extern sio_hw_t *sio_hw;
+
+#endif
@@ -0,0 +1,416 @@
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "host_stub.h"
+#include <string.h>
+
+stub_state stub;
+
+struct spi_inst { uint index; };
+static spi_inst port0 = { 0 }, port1 = { 1 };
+spi_inst_t *spi0 = &port0, *spi1 = &port1;
+
+static spi_hw_t spiHw[2];
+static sio_hw_t sioHw;
+sio_hw_t *sio_hw = &sioHw;
+
+static dma_channel_hw_t dmaHw[STUB_DMA_CHANNELS];
+
+// ID bytes returned by RDDID, after the dummy byte
+static const uint8_t panelId[3] = { 0x85, 0x85, 0x52 };
+
+void stub_reset_counters(void) {
+  stub.sdkCalls = 0;
+  stub.fifoWrites = 0;
+  stub.bytes = 0;
+  stub.frames16 = 0;
+  stub.busNs = 0;
+  stub.formats = 0;
+  stub.commands = 0;
+  stub.pixelsWritten = 0;
+  stub.ramWrites = 0;
+  stub.ramReads = 0;
+  stub.pixelsRead = 0;
+  stub.csAsserts = 0;
+  stub.csConflicts = 0;
+  stub.deselected = 0;
+  stub.initsSelected = 0;
+  stub.initsBusy = 0;
+  for (uint32_t i = 0; i < STUB_DMA_CHANNELS; i++) {
+    stub.dma[i].triggers = 0;
+    stub.dma[i].transfers = 0;
+  }
+}
+
+void stub_reset(void) {
+  memset(stub.ram, 0, sizeof(stub.ram));
+  stub.writeLimitHz = 0;
+  stub.readLimitHz = 0;
+  stub.dmaBusyPolls = 0;
+  stub.csPins = 1u << STUB_PANEL_CS;
+  stub.pins |= stub.csPins;
+  stub_reset_counters();
+}
+
+uint16_t stub_pixel(int32_t x, int32_t y) {
+  return stub.ram[y * STUB_RAM_WIDTH + x];
+}
+
+// Number of chip selects that are low
+static uint32_t selected(void) {
+  return __builtin_popcount(~stub.pins & stub.csPins);
+}
+
+static bool panelSelected(void) {
+  return !(stub.pins >> STUB_PANEL_CS & 1);
+}
+
+// Step the RAM pointer through the window in raster order
+static void advance(void) {
+  if (++stub.cx > stub.xe) {
+    stub.cx = stub.xs;
+    stub.cy++;
+  }
+}
+
+// A byte written to the panel
+static void panelWrite(uint8_t b) {
+  bool data = stub.pins >> STUB_PANEL_DC & 1;
+  if (data && stub.writeLimitHz && (stub.baud > stub.writeLimitHz)) b ^= 0x10;
+
+  if (!data) {
+    stub.cmd = b;
+    stub.argCount = 0;
+    stub.readIndex = 0;
+    stub.commands++;
+    if (b == 0x2C) stub.ramWrites++;
+    if (b == 0x2E) stub.ramReads++;
+    if ((b == 0x2C) || (b == 0x2E)) {
+      stub.cx = stub.xs;
+      stub.cy = stub.ys;
+      stub.half = -1;
+    }
+    return;
+  }
+
+  if ((stub.cmd == 0x2A) || (stub.cmd == 0x2B)) {
+    uint16_t *p = (stub.cmd == 0x2A) ? ((stub.argCount < 2) ? &stub.xs : &stub.xe)
+                                     : ((stub.argCount < 2) ? &stub.ys : &stub.ye);
+    *p = (stub.argCount & 1) ? (*p | b) : (uint16_t)(b << 8);
+  }
+  else if (stub.cmd == 0x2C) {
+    if (stub.half < 0) { stub.half = b; return; }
+    if ((stub.cx < STUB_RAM_WIDTH) && (stub.cy < STUB_RAM_HEIGHT)) {
+      stub.ram[stub.cy * STUB_RAM_WIDTH + stub.cx] = stub.half << 8 | b;
+    }
+    stub.half = -1;
+    stub.pixelsWritten++;
+    advance();
+    return;
+  }
+
+  if (stub.argCount < sizeof(stub.args)) stub.args[stub.argCount] = b;
+  stub.argCount++;
+
+  if ((stub.cmd == 0x33) && (stub.argCount == 6)) {
+    stub.tfa = stub.args[0] << 8 | stub.args[1];
+    stub.vsa = stub.args[2] << 8 | stub.args[3];
+    stub.bfa = stub.args[4] << 8 | stub.args[5];
+  }
+  else if ((stub.cmd == 0x37) && (stub.argCount == 2)) {
+    stub.vsp = stub.args[0] << 8 | stub.args[1];
+  }
+}
+
+// A byte read from the panel, RAMRD gives a dummy byte then 3 bytes of 6-bit color per pixel
+static uint8_t panelRead(void) {
+  uint8_t v = 0;
+  uint32_t i = stub.readIndex++;
+
+  if (stub.cmd == 0x2E) {
+    if (i > 0) {
+      uint16_t c = ((stub.cx < STUB_RAM_WIDTH) && (stub.cy < STUB_RAM_HEIGHT)) ? stub.ram[stub.cy * STUB_RAM_WIDTH + stub.cx] : 0;
+      uint32_t k = (i - 1) % 3;
+      v = (k == 0) ? (c >> 8 & 0xF8) : (k == 1) ? (c >> 3 & 0xFC) : (c << 3 & 0xF8);
+      if (k == 2) { stub.pixelsRead++; advance(); }
+    }
+  }
+  else if (stub.cmd == 0x04) {
+    v = ((i > 0) && (i < 4)) ? panelId[i - 1] : 0;
+  }
+
+  if (stub.readLimitHz && (stub.baud > stub.readLimitHz)) v ^= 0x80;
+  return v;
+}
+
+// A frame clocked out of the port
+static void frame(uint32_t v) {
+  uint32_t n = (stub.frameBits > 8) ? 2 : 1;
+
+  stub.bytes += n;
+  if (stub.baud) stub.busNs += (uint64_t)stub.frameBits * 1000000000u / stub.baud;
+  if (n == 2) stub.frames16++;
+
+  if (selected() > 1) stub.csConflicts++;
+  if (selected() == 0) stub.deselected++;
+  if (!panelSelected()) return;
+
+  if (n == 2) panelWrite(v >> 8);
+  panelWrite(v);
+}
+
+// A byte clocked in while one is clocked out
+static uint8_t exchange(void) {
+  stub.bytes++;
+  if (stub.baud) stub.busNs += 8ull * 1000000000u / stub.baud;
+  if (selected() > 1) stub.csConflicts++;
+  return panelSelected() ? panelRead() : 0xFF;
+}
+
+spi_dr_reg &spi_dr_reg::operator=(uint32_t v) {
+  stub.fifoWrites++;
+  frame(v);
+  return *this;
+}
+
+spi_dr_reg::operator uint32_t() const {
+  return 0;
+}
+
+// Divider search of the SDK, so only clocks the hardware can make are returned
+uint spi_set_baudrate(spi_inst_t *, uint baudrate) {
+  uint prescale, postdiv;
+  for (prescale = 2; prescale <= 254; prescale += 2) {
+    if (STUB_PERI_HZ < (prescale + 2) * 256 * (uint64_t)baudrate) break;
+  }
+  for (postdiv = 256; postdiv > 1; --postdiv) {
+    if (STUB_PERI_HZ / (prescale * (postdiv - 1)) > baudrate) break;
+  }
+  stub.baud = STUB_PERI_HZ / (prescale * postdiv);
+  return stub.baud;
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+  if (selected()) stub.initsSelected++;
+  for (uint32_t i = 0; i < STUB_DMA_CHANNELS; i++) {
+    if (stub.dmaBusyLeft[i]) stub.initsBusy++;
+  }
+  stub.frameBits = 8;
+  return spi_set_baudrate(spi, baudrate);
+}
+
+uint spi_get_baudrate(const spi_inst_t *) {
+  return stub.baud;
+}
+
+void spi_set_format(spi_inst_t *, uint data_bits, spi_cpol_t, spi_cpha_t, spi_order_t) {
+  stub.frameBits = data_bits;
+  stub.formats++;
+}
+
+int spi_write_blocking(spi_inst_t *, const uint8_t *src, size_t len) {
+  stub.sdkCalls++;
+  for (size_t i = 0; i < len; i++) frame(src[i]);
+  return len;
+}
+
+int spi_write16_blocking(spi_inst_t *, const uint16_t *src, size_t len) {
+  stub.sdkCalls++;
+  for (size_t i = 0; i < len; i++) frame(src[i]);
+  return len;
+}
+
+int spi_read_blocking(spi_inst_t *, uint8_t, uint8_t *dst, size_t len) {
+  stub.sdkCalls++;
+  for (size_t i = 0; i < len; i++) dst[i] = exchange();
+  return len;
+}
+
+int spi_write_read_blocking(spi_inst_t *, const uint8_t *, uint8_t *dst, size_t len) {
+  stub.sdkCalls++;
+  for (size_t i = 0; i < len; i++) dst[i] = exchange();
+  return len;
+}
+
+// The FIFOs never fill as frames leave as soon as they are written
+spi_hw_t *spi_get_hw(spi_inst_t *spi) {
+  spi_hw_t *hw = &spiHw[spi->index];
+  hw->sr = SPI_SSPSR_TNF_BITS | SPI_SSPSR_TFE_BITS;
+  return hw;
+}
+
+uint spi_get_index(const spi_inst_t *spi) {
+  return spi->index;
+}
+
+bool spi_is_writable(const spi_inst_t *) {
+  return true;
+}
+
+bool spi_is_readable(const spi_inst_t *) {
+  return false;
+}
+
+bool spi_is_busy(const spi_inst_t *) {
+  return false;
+}
+
+void gpio_init(uint) {}
+void gpio_set_dir(uint, bool) {}
+void gpio_set_function(uint, enum gpio_function) {}
+
+void gpio_put(uint gpio, bool value) {
+  if ((gpio == STUB_PANEL_CS) && !value && !panelSelected()) stub.csAsserts++;
+  if (value) stub.pins |= 1u << gpio;
+  else stub.pins &= ~(1u << gpio);
+}
+
+bool gpio_get(uint gpio) {
+  return stub.pins >> gpio & 1;
+}
+
+void sio_set_reg::operator=(uint32_t mask) {
+  for (uint32_t p = 0; p < 32; p++) {
+    if (mask >> p & 1) gpio_put(p, 1);
+  }
+}
+
+void sio_clr_reg::operator=(uint32_t mask) {
+  for (uint32_t p = 0; p < 32; p++) {
+    if (mask >> p & 1) gpio_put(p, 0);
+  }
+}
+
+void sleep_ms(uint32_t ms) {
+  stub.nowUs += (uint64_t)ms * 1000;
+}
+
+void sleep_us(uint64_t us) {
+  stub.nowUs += us;
+}
+
+uint32_t time_us_32(void) {
+  return stub.nowUs;
+}
+
+uint64_t time_us_64(void) {
+  return stub.nowUs;
+}
+
+uint pwm_gpio_to_slice_num(uint gpio) {
+  return (gpio >> 1) & 7;
+}
+
+void pwm_set_wrap(uint, uint16_t) {}
+void pwm_set_gpio_level(uint, uint16_t) {}
+void pwm_set_enabled(uint, bool) {}
+
+int dma_claim_unused_channel(bool) {
+  for (uint32_t i = 0; i < STUB_DMA_CHANNELS; i++) {
+    if (!stub.dma[i].claimed) {
+      stub.dma[i].claimed = true;
+      return i;
+    }
+  }
+  return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+  stub.dma[channel].claimed = false;
+}
+
+// Defaults of the SDK, 32-bit transfers with the read address incrementing and no chain
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  dma_channel_config c = { DMA_SIZE_32, true, false, false, DREQ_FORCE, channel };
+  return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+  c->size = size;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+  c->dreq = dreq;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+  c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+  c->write_increment = incr;
+}
+
+void channel_config_set_bswap(dma_channel_config *c, bool bswap) {
+  c->bswap = bswap;
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) {
+  c->chain_to = chain_to;
+}
+
+// Finish a channel, a chain to another channel triggers it
+static void dmaComplete(uint channel) {
+  stub.dmaBusyLeft[channel] = 0;
+  uint next = stub.dma[channel].config.chain_to;
+  if (next != channel) dma_channel_start(next);
+}
+
+// Move the data of a channel, frames written to an SPI data register are clocked out
+void dma_channel_start(uint channel) {
+  stub_dma_channel &d = stub.dma[channel];
+  const uint8_t *src = (const uint8_t *)d.read_addr;
+  uint32_t size = 1u << d.config.size;
+
+  d.triggers++;
+  for (uint32_t i = 0; i < d.count; i++) {
+    uint32_t v = 0;
+    memcpy(&v, src, size);
+    if (d.config.bswap && (size == 2)) v = (v >> 8 & 0xFF) | (v << 8 & 0xFF00);
+    if (d.config.read_increment) src += size;
+
+    if ((d.write_addr == (volatile void *)&spiHw[0].dr) || (d.write_addr == (volatile void *)&spiHw[1].dr)) {
+      *(spi_dr_reg *)d.write_addr = v;
+    }
+    d.transfers++;
+  }
+  dmaHw[channel].transfer_count = 0;
+
+  if (stub.dmaBusyPolls) stub.dmaBusyLeft[channel] = stub.dmaBusyPolls;
+  else dmaComplete(channel);
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+  stub_dma_channel &d = stub.dma[channel];
+  d.config = *config;
+  d.write_addr = write_addr;
+  d.read_addr = read_addr;
+  d.count = transfer_count;
+  dmaHw[channel].transfer_count = transfer_count;
+  if (trigger) dma_channel_start(channel);
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger) {
+  stub.dma[channel].config = *config;
+  if (trigger) dma_channel_start(channel);
+}
+
+void dma_channel_abort(uint channel) {
+  stub.dmaBusyLeft[channel] = 0;
+}
+
+bool dma_channel_is_busy(uint channel) {
+  if (stub.dmaBusyLeft[channel] == 0) return false;
+  if (--stub.dmaBusyLeft[channel] == 0) dmaComplete(channel);
+  return true;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+  if (stub.dmaBusyLeft[channel]) dmaComplete(channel);
+}
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel) {
+  return &dmaHw[channel];
+}
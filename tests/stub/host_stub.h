@@ -0,0 +1,95 @@
+#ifndef _TFT_eSPI_HOST_STUB_H_
+#define _TFT_eSPI_HOST_STUB_H_
+
+// Host stand-ins for the Pico SDK functions the library calls
+// The SPI port drives an emulated panel with the RAM of an ILI9341, it understands CASET, RASET, RAMWR, RAMRD,
+// VSCRDEF and VSCRSADD and returns a fixed ID, and every call, byte and frame is counted so tests can check how the bus is driven
+// DMA channels record their configuration and move their data as soon as they are triggered
+
+#include <stdint.h>
+#include "hardware/dma.h"
+
+// Panel RAM size and the pins the panel's CS and DC are wired to, those of TFT_BUS_CONFIG_DEFAULT
+#define STUB_RAM_WIDTH  240
+#define STUB_RAM_HEIGHT 320
+#define STUB_PANEL_CS   5
+#define STUB_PANEL_DC   6
+
+#define STUB_DMA_CHANNELS 12
+
+// Clock the PL022 divides down from, spi_set_baudrate() returns the clocks its dividers can make
+#define STUB_PERI_HZ 125000000
+
+// DMA channel as last configured, and what it has done
+struct stub_dma_channel {
+  bool     claimed;
+  dma_channel_config config;
+  const volatile void *read_addr;
+  volatile void *write_addr;
+  uint32_t count;      // Transfer count of the last configuration
+  uint32_t triggers;   // Times the channel was started
+  uint64_t transfers;  // Transfers done in total
+};
+
+struct stub_state {
+  // Panel RAM and the state of its command parser
+  uint16_t ram[STUB_RAM_WIDTH * STUB_RAM_HEIGHT];
+  uint8_t  cmd;
+  uint8_t  args[16];
+  uint32_t argCount;
+  uint16_t xs, xe, ys, ye, cx, cy;
+  int32_t  half;      // First byte of a pixel written to RAMWR, -1 if none
+  uint32_t readIndex; // Bytes read since the last command
+  uint16_t tfa, vsa, bfa, vsp; // Scrolling areas and start address from VSCRDEF and VSCRSADD
+
+  // Pin levels, and the pins that are chip selects of devices on the bus
+  uint32_t pins;
+  uint32_t csPins;
+
+  // Port state
+  uint32_t baud;
+  uint32_t frameBits;
+
+  // Counters
+  uint32_t sdkCalls;      // spi_write_blocking(), spi_write16_blocking(), spi_read_blocking() and spi_write_read_blocking()
+  uint64_t fifoWrites;    // Frames written to the data register, by the CPU or by DMA
+  uint64_t bytes;         // Bytes clocked out, a 16-bit frame is two
+  uint64_t frames16;      // Frames clocked out while 16-bit frames were selected
+  uint64_t busNs;         // Time on the wire at the clocks in use
+  uint32_t formats;       // spi_set_format() calls
+  uint32_t commands;      // Bytes the panel took as commands
+  uint64_t pixelsWritten; // Pixels the panel stored
+  uint32_t ramWrites;     // RAMWR commands the panel took
+  uint32_t ramReads;      // RAMRD commands the panel took
+  uint64_t pixelsRead;    // Pixels the panel returned to RAMRD
+  uint32_t csAsserts;     // Times the panel's CS went low
+  uint32_t csConflicts;   // Frames clocked out while more than one chip select was low
+  uint32_t deselected;    // Frames clocked out with no chip select low
+  uint32_t initsSelected; // spi_init() calls while a chip select was low
+  uint32_t initsBusy;     // spi_init() calls while a DMA channel was still running
+
+  // Data bytes written above writeLimitHz, or read above readLimitHz, have a bit flipped, 0 for no limit
+  uint32_t writeLimitHz, readLimitHz;
+
+  // DMA channels are left busy after a trigger until dma_channel_wait_for_finish_blocking() or this many
+  // dma_channel_is_busy() polls, so code that must wait for DMA can be checked to do so
+  uint32_t dmaBusyPolls;
+  uint32_t dmaBusyLeft[STUB_DMA_CHANNELS];
+
+  stub_dma_channel dma[STUB_DMA_CHANNELS];
+
+  uint64_t nowUs;
+};
+
+extern stub_state stub;
+
+// Clear the panel RAM, the counters and the error injection
+void stub_reset(void);
+
+// Clear only the counters
+void stub_reset_counters(void);
+
+// Panel pixel at x, y of its RAM
+uint16_t stub_pixel(int32_t x, int32_t y);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef _STUB_PICO_STDLIB_H
+#define _STUB_PICO_STDLIB_H
+
+// Host stand-in for the Pico SDK, only what the library uses is declared
+// The functions are defined in host_stub.cpp
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+static inline void tight_loop_contents(void) {}
+
+#define __not_in_flash_func(f) f
+
+#endif
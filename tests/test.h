@@ -0,0 +1,36 @@
+#ifndef _TFT_eSPI_TEST_H_
+#define _TFT_eSPI_TEST_H_
+
+// Checks for the host tests, a failed check prints where it failed and the test exits with 1 at the end
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include "TFT_eSPI.h"
+#include "host_stub.h"
+
+static int testFailures = 0;
+
+#define CHECK(c) do { \
+    if (!(c)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #c); testFailures++; } \
+  } while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long va = (long long)(a), vb = (long long)(b); \
+    if (va != vb) { printf("%s:%d: CHECK_EQ(%s, %s) failed, %lld != %lld\n", __FILE__, __LINE__, #a, #b, va, vb); testFailures++; } \
+  } while (0)
+
+// Exit status of the test
+static inline int testResult(void) {
+  printf(testFailures ? "%d checks failed\n" : "ok\n", testFailures);
+  return testFailures ? 1 : 0;
+}
+
+// Seconds of host time taken by fn, for the throughput figures the benchmarks print
+template <class F> double testSeconds(F fn) {
+  auto t0 = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+#endif
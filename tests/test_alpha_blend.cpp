@@ -0,0 +1,118 @@
+// The row blends must match alphaBlend() bit for bit, including the pairs whose greens are blended together in
+// the lanes of one word. Every green pair and alpha is checked, then random rows at every alignment
+// Prints pixels per second for alphaBlend() called per pixel and for each row kernel
+
+#include "test.h"
+
+static uint32_t seed = 1;
+static uint32_t rnd(void) {
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 8;
+}
+
+// Dither offsets as documented for alphaBlendRowDither(), a 4x4 Bayer matrix
+static const uint8_t bayer[4][4] = { { 0, 8, 2, 10 }, { 12, 4, 14, 6 }, { 3, 11, 1, 9 }, { 15, 7, 13, 5 } };
+
+int main() {
+  TFT_eSPI tft;
+
+  // Every foreground and background green with every alpha, in both halves of a pair
+  {
+    alignas(4) uint16_t bg[2], out[2];
+    uint8_t alpha[2];
+    uint32_t bad = 0;
+    for (uint32_t gf = 0; gf < 64; gf++)
+      for (uint32_t gb = 0; gb < 64; gb++)
+        for (uint32_t a = 0; a < 256; a++) {
+          uint16_t fg = gf << 5 | (rnd() & 0xF81F);
+          bg[0] = gb << 5 | (rnd() & 0xF81F);
+          bg[1] = rnd();
+          alpha[0] = a;
+          alpha[1] = rnd();
+          tft.alphaBlendRow(alpha, fg, bg, out, 2);
+          bad += (out[0] != tft.alphaBlend(alpha[0], fg, bg[0])) || (out[1] != tft.alphaBlend(alpha[1], fg, bg[1]));
+
+          std::swap(bg[0], bg[1]);
+          std::swap(alpha[0], alpha[1]);
+          alignas(4) uint16_t fgRow[2] = { (uint16_t)rnd(), fg };
+          tft.alphaBlendRow(alpha, fgRow, bg, out, 2);
+          bad += (out[0] != tft.alphaBlend(alpha[0], fgRow[0], bg[0])) || (out[1] != tft.alphaBlend(alpha[1], fgRow[1], bg[1]));
+        }
+    CHECK_EQ(bad, 0);
+  }
+
+  // Random rows at every alignment of bg, fg and out, in place and not, with runs of zero alpha
+  {
+    alignas(4) uint16_t bg[72], fgRow[72], out[72], ref[72];
+    uint8_t alpha[72];
+    uint32_t bad = 0;
+    for (uint32_t t = 0; t < 4000; t++) {
+      for (uint32_t i = 0; i < 72; i++) {
+        bg[i] = rnd();
+        fgRow[i] = rnd();
+        uint32_t r = rnd();
+        alpha[i] = (r & 3) ? (r >> 4) : ((r & 4) ? 255 : 0);
+      }
+      uint16_t fg = rnd();
+      uint32_t ob = t & 1, of = t >> 1 & 1, oo = t >> 2 & 1, n = rnd() % 64;
+      bool inPlace = t & 8;
+      int32_t x = rnd() % 200, y = rnd() % 200;
+      uint8_t dither = rnd() % 64;
+
+      uint16_t *o = inPlace ? bg + ob : out + oo;
+      memcpy(ref, bg + ob, n * 2);
+
+      tft.alphaBlendRow(alpha, fg, bg + ob, o, n);
+      for (uint32_t i = 0; i < n; i++) bad += (o[i] != tft.alphaBlend(alpha[i], fg, ref[i]));
+
+      memcpy(bg + ob, ref, n * 2);
+      tft.alphaBlendRow(alpha, fgRow + of, bg + ob, o, n);
+      for (uint32_t i = 0; i < n; i++) bad += (o[i] != tft.alphaBlend(alpha[i], fgRow[of + i], ref[i]));
+
+      memcpy(bg + ob, ref, n * 2);
+      tft.alphaBlendRowDither(alpha, fg, bg + ob, o, n, x, y, dither);
+      for (uint32_t i = 0; i < n; i++) {
+        int32_t a = alpha[i];
+        if (a) a = std::min<int32_t>(std::max<int32_t>(a + (((2 * bayer[y & 3][(x + i) & 3] - 15) * dither) >> 4), 0), 255);
+        bad += (o[i] != tft.alphaBlend(a, fg, ref[i]));
+      }
+      memcpy(bg + ob, ref, n * 2);
+    }
+    CHECK_EQ(bad, 0);
+  }
+
+  // Pixels per second, an anti-aliased edge row with a few fully covered and uncovered pixels
+  const uint32_t n = 256, reps = 20000;
+  alignas(4) static uint16_t bg[n], fgRow[n], out[n];
+  static uint8_t alpha[n];
+  for (uint32_t i = 0; i < n; i++) {
+    bg[i] = rnd();
+    fgRow[i] = rnd();
+    alpha[i] = (i % 16 == 0) ? 0 : (i % 16 == 1) ? 255 : rnd();
+  }
+
+  volatile uint16_t sink = 0;
+  double px = (double)n * reps;
+  double s0 = testSeconds([&] {
+    for (uint32_t r = 0; r < reps; r++) {
+      for (uint32_t i = 0; i < n; i++) out[i] = tft.alphaBlend(alpha[i], r, bg[i]);
+      sink = sink + out[r % n];
+    }
+  });
+  double s1 = testSeconds([&] {
+    for (uint32_t r = 0; r < reps; r++) { tft.alphaBlendRow(alpha, r, bg, out, n); sink = sink + out[r % n]; }
+  });
+  double s2 = testSeconds([&] {
+    for (uint32_t r = 0; r < reps; r++) { tft.alphaBlendRow(alpha, fgRow, bg, out, n); sink = sink + out[r % n]; }
+  });
+  double s3 = testSeconds([&] {
+    for (uint32_t r = 0; r < reps; r++) { tft.alphaBlendRowDither(alpha, r, bg, out, n, r, r, 16); sink = sink + out[r % n]; }
+  });
+
+  printf("alphaBlend per pixel:     %7.1f Mpixels/s\n", px / s0 / 1e6);
+  printf("alphaBlendRow, one fg:    %7.1f Mpixels/s\n", px / s1 / 1e6);
+  printf("alphaBlendRow, fg row:    %7.1f Mpixels/s\n", px / s2 / 1e6);
+  printf("alphaBlendRowDither:      %7.1f Mpixels/s\n", px / s3 / 1e6);
+
+  return testResult();
+}
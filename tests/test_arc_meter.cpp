@@ -0,0 +1,61 @@
+// An arc meter without a hole covers every pixel of its disc once, the centre included, and updates leave
+// the same pixels as drawing the new value from scratch
+
+#include "test.h"
+
+static uint32_t count(uint16_t color) {
+  uint32_t c = 0;
+  for (int32_t i = 0; i < STUB_RAM_WIDTH * STUB_RAM_HEIGHT; i++) c += (stub.ram[i] == color);
+  return c;
+}
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  const int32_t cx = 120, cy = 160, r = 50;
+  uint32_t disc = 0;
+  for (int32_t dy = -r; dy <= r; dy++)
+    for (int32_t dx = -r; dx <= r; dx++) disc += (dx * dx + dy * dy <= r * r);
+
+  TFT_eArcMeter meter(&tft);
+  CHECK(meter.begin(cx, cy, r, 0, 0, 360, TFT_RED, TFT_BLUE));
+  meter.setRange(0, 100);
+
+  // Each pixel of the disc is sent once, and the centre is drawn
+  tft.fillScreen(TFT_BLACK);
+  meter.draw(30);
+  CHECK_EQ(meter.lastPixels(), disc);
+  CHECK_EQ(count(TFT_RED) + count(TFT_BLUE), disc);
+  CHECK_EQ(stub_pixel(cx, cy), TFT_RED);
+
+  // The centre takes the color of the start of the arc
+  tft.fillScreen(TFT_BLACK);
+  meter.draw(0);
+  CHECK_EQ(stub_pixel(cx, cy), TFT_BLUE);
+  CHECK_EQ(count(TFT_BLUE), disc);
+
+  meter.update(60);
+  CHECK_EQ(stub_pixel(cx, cy), TFT_RED);
+  meter.update(0);
+  CHECK_EQ(stub_pixel(cx, cy), TFT_BLUE);
+  CHECK_EQ(count(TFT_BLUE), disc);
+
+  // Updates through the range match a fresh draw of the final value
+  for (int32_t v = 0; v <= 100; v += 7) meter.update(v);
+  meter.update(45);
+  static uint16_t updated[STUB_RAM_WIDTH * STUB_RAM_HEIGHT];
+  memcpy(updated, stub.ram, sizeof(updated));
+  tft.fillScreen(TFT_BLACK);
+  meter.draw(45);
+  CHECK(memcmp(updated, stub.ram, sizeof(updated)) == 0);
+
+  // A ring keeps its hole
+  CHECK(meter.begin(cx, cy, r, 20, 0, 360, TFT_RED, TFT_BLUE));
+  tft.fillScreen(TFT_BLACK);
+  meter.draw(50);
+  CHECK_EQ(stub_pixel(cx, cy), TFT_BLACK);
+
+  return testResult();
+}
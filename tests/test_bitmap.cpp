@@ -0,0 +1,127 @@
+// drawBitmap(), drawXBitmap() and drawBitmapBits() against the bits read one at a time: random bitmaps at random
+// bit offsets, strides and positions over the screen edges, in both bit orders, transparent and opaque
+// A transparent bitmap must be drawn with one drawFastHLine() per run of set bits on the screen, one RAMWR each,
+// and an opaque one as a single window. Bits past the width, padding included, must never be drawn
+
+#include "test.h"
+#include <vector>
+
+// Screen size, so the panel RAM beyond the right and bottom of the screen shows anything drawn past them
+#define W 200
+#define H 280
+#define BG 0x1234
+
+static uint32_t seed = 31;
+static uint32_t rnd(uint32_t n) {
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 8) % n;
+}
+
+// Bit column c of a row, leftmost in the top bit of each byte or in the bottom bit for XBM
+static bool bit(const uint8_t *row, uint32_t c, bool lsbFirst) {
+  return (row[c >> 3] >> (lsbFirst ? (c & 7) : (7 - (c & 7)))) & 1;
+}
+
+struct Expect {
+  uint32_t runs = 0, pixels = 0;
+};
+
+// Draw the bitmap on the expected screen a bit at a time, counting the runs of set bits on the screen
+static Expect reference(uint16_t *ram, int32_t x, int32_t y, const uint8_t *bitmap, int32_t sx, uint32_t stride, int32_t w, int32_t h,
+                        bool lsbFirst, uint16_t fg, uint32_t bg) {
+  Expect e;
+  for (int32_t j = 0; j < h; j++) {
+    bool inRun = false;
+    for (int32_t i = 0; i < w; i++) {
+      int32_t px = x + i, py = y + j;
+      if ((px < 0) || (px >= W) || (py < 0) || (py >= H)) continue;
+      bool set = bit(bitmap + j * stride, sx + i, lsbFirst);
+      if (set) ram[py * STUB_RAM_WIDTH + px] = fg;
+      else if (bg != 0x00FFFFFF) ram[py * STUB_RAM_WIDTH + px] = bg;
+      e.runs += set && !inRun;
+      e.pixels += set || (bg != 0x00FFFFFF);
+      inRun = set;
+    }
+  }
+  return e;
+}
+
+int main() {
+  stub_reset();
+  tft_bus_config cfg = TFT_BUS_CONFIG_DEFAULT;
+  cfg.width  = W;
+  cfg.height = H;
+  TFT_eSPI tft(cfg);
+  tft.begin();
+
+  static uint16_t expect[STUB_RAM_WIDTH * STUB_RAM_HEIGHT];
+  uint32_t bad = 0, badRuns = 0, badWindows = 0;
+
+  for (uint32_t t = 0; t < 2000; t++) {
+    // Bitmap with set bits in runs, some long, and random padding after the width and the bit offset
+    int32_t w = rnd(140) + 1, h = rnd(40) + 1;
+    int32_t x = (int32_t)rnd(W + w + 20) - w - 10, y = (int32_t)rnd(H + h + 20) - h - 10;
+    uint8_t kind = t % 4;  // drawBitmap, drawXBitmap, and drawBitmapBits in each bit order
+    int32_t sx = (kind < 2) ? 0 : rnd(40);
+    uint32_t stride = (sx + w + 7) / 8 + ((kind < 2) ? 0 : rnd(3));
+    bool lsbFirst = (kind == 1) || (kind == 3);
+    uint32_t density = rnd(4);
+
+    std::vector<uint8_t> bitmap(stride * h + 8);
+    for (uint8_t &b : bitmap) {
+      switch (density) {
+        case 0:  b = rnd(256); break;
+        case 1:  b = rnd(2) ? 0xFF : 0x00; break;
+        case 2:  b = rnd(256) & rnd(256) & rnd(256); break;
+        default: b = rnd(256) | rnd(256) | rnd(256); break;
+      }
+    }
+
+    uint16_t fg = rnd(0x10000);
+    uint32_t bg = rnd(2) ? 0x00FFFFFF : rnd(0x10000);
+    tft.setSwapBytes(rnd(2));
+
+    for (int32_t i = 0; i < STUB_RAM_WIDTH * STUB_RAM_HEIGHT; i++) stub.ram[i] = BG;
+    memcpy(expect, stub.ram, sizeof(expect));
+    Expect e = reference(expect, x, y, bitmap.data(), sx, stride, w, h, lsbFirst, fg, bg);
+
+    stub_reset_counters();
+    bool opaque = (bg != 0x00FFFFFF);
+    switch (kind) {
+      case 0:  opaque ? tft.drawBitmap(x, y, bitmap.data(), w, h, fg, bg) : tft.drawBitmap(x, y, bitmap.data(), w, h, fg); break;
+      case 1:  opaque ? tft.drawXBitmap(x, y, bitmap.data(), w, h, fg, bg) : tft.drawXBitmap(x, y, bitmap.data(), w, h, fg); break;
+      default: tft.drawBitmapBits(x, y, bitmap.data(), sx, stride, w, h, lsbFirst, fg, bg); break;
+    }
+
+    if (memcmp(expect, stub.ram, sizeof(expect)) != 0) {
+      if (!bad) printf("kind %u at %d, %d, %d x %d, sx %d, stride %u, bg %x differs\n", kind, x, y, w, h, sx, stride, bg);
+      bad++;
+    }
+    CHECK_EQ(stub.pixelsWritten, e.pixels);
+
+    // One horizontal line per run, each its own RAMWR, or one window for the whole visible bitmap
+    if (opaque) badWindows += (stub.ramWrites != (e.pixels ? 1u : 0u));
+    else        badRuns    += (stub.ramWrites != e.runs);
+  }
+  tft.setSwapBytes(false);
+
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(badRuns, 0);
+  CHECK_EQ(badWindows, 0);
+
+  // A glyph from the middle of a strip of icons, picked out by its bit column
+  {
+    const uint8_t strip[2 * 3] = { 0x0F, 0xF0, 0x00,
+                                   0x03, 0xC0, 0x00 };
+    for (int32_t i = 0; i < STUB_RAM_WIDTH * STUB_RAM_HEIGHT; i++) stub.ram[i] = BG;
+    stub_reset_counters();
+    tft.drawBitmapBits(10, 20, strip, 4, 3, 8, 2, false, TFT_RED);
+    CHECK_EQ(stub.ramWrites, 2);
+    for (int32_t i = 0; i < 10; i++) {
+      CHECK_EQ(stub_pixel(10 + i, 20), (i < 8) ? TFT_RED : BG);
+      CHECK_EQ(stub_pixel(10 + i, 21), ((i >= 2) && (i < 6)) ? TFT_RED : BG);
+    }
+  }
+
+  return testResult();
+}
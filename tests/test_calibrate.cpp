@@ -0,0 +1,102 @@
+// calibrateSPI() on a bus that corrupts data written or read above a threshold clock
+// Each clock chosen must be one the port can make, below its threshold, and one distinct clock below the
+// fastest that passed
+
+#include "test.h"
+
+// Clocks the sweep tries, those the port can make from the requested steps, in order
+// The port is asked for each and then put back to the clock it had
+static int sweepClocks(uint32_t *clk, uint32_t minFreq, uint32_t maxFreq, uint32_t stepFreq) {
+  uint32_t baud = stub.baud;
+  int n = 0;
+  for (uint32_t f = minFreq; f <= maxFreq; f += stepFreq) {
+    uint32_t actual = spi_set_baudrate(spi0, f);
+    if (n && (actual == clk[n - 1])) continue;
+    clk[n++] = actual;
+  }
+  spi_set_baudrate(spi0, baud);
+  return n;
+}
+
+// Clock the sweep should pick: the one before the fastest that passes, or the slowest if only it passes
+static uint32_t expected(uint32_t limit, uint32_t minFreq, uint32_t maxFreq, uint32_t stepFreq) {
+  uint32_t clk[64];
+  int n = sweepClocks(clk, minFreq, maxFreq, stepFreq);
+  int pass = 0;
+  while ((pass < n) && (!limit || (clk[pass] <= limit))) pass++;
+  if (pass == 0) return 0;
+  return clk[(pass > 1) ? pass - 2 : 0];
+}
+
+// The next clock the sweep tried above f, the margin the choice keeps
+static uint32_t nextClock(uint32_t f, uint32_t minFreq, uint32_t maxFreq, uint32_t stepFreq) {
+  uint32_t clk[64];
+  int n = sweepClocks(clk, minFreq, maxFreq, stepFreq);
+  for (int i = 0; i < n; i++) if (clk[i] > f) return clk[i];
+  return 0;
+}
+
+static void checkRoundTrip(TFT_eSPI &tft) {
+  uint16_t px[16];
+  tft.fillRect(0, 0, 8, 2, 0xA55A);
+  tft.readRect(0, 0, 8, 2, px);
+  for (int i = 0; i < 16; i++) CHECK_EQ(px[i], 0xA55A);
+}
+
+int main() {
+  const uint32_t minF = 10000000, maxF = 80000000, step = 2000000;
+
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  // Writes fail above 50 MHz and reads above 30 MHz
+  stub.writeLimitHz = 50000000;
+  stub.readLimitHz  = 30000000;
+  tft_spi_clocks c = tft.calibrateSPI(minF, maxF, step);
+
+  CHECK_EQ(c.write_hz, expected(stub.writeLimitHz, minF, maxF, step));
+  CHECK_EQ(c.read_hz,  expected(stub.readLimitHz,  minF, maxF, step));
+  CHECK(c.write_hz < stub.writeLimitHz);
+  CHECK(c.read_hz  < stub.readLimitHz);
+
+  // One clock of margin: the next clock up still passes, the one above that is the first to fail
+  uint32_t w1 = nextClock(c.write_hz, minF, maxF, step), r1 = nextClock(c.read_hz, minF, maxF, step);
+  CHECK(w1 && (w1 <= stub.writeLimitHz));
+  CHECK(r1 && (r1 <= stub.readLimitHz));
+  CHECK(nextClock(w1, minF, maxF, step) > stub.writeLimitHz);
+  CHECK(nextClock(r1, minF, maxF, step) > stub.readLimitHz);
+
+  // The clocks are in use afterwards and data survives them
+  CHECK_EQ(stub.baud, c.write_hz);
+  checkRoundTrip(tft);
+
+  // Stored clocks passed to the constructor are used from begin()
+  stub_reset();
+  stub.writeLimitHz = 50000000;
+  stub.readLimitHz  = 30000000;
+  TFT_eSPI stored(c);
+  stored.begin();
+  CHECK_EQ(stub.baud, c.write_hz);
+  checkRoundTrip(stored);
+
+  // Lower thresholds move both clocks down
+  stub.writeLimitHz = 16000000;
+  stub.readLimitHz  = 13000000;
+  c = stored.calibrateSPI(minF, maxF, step);
+  CHECK_EQ(c.write_hz, expected(stub.writeLimitHz, minF, maxF, step));
+  CHECK_EQ(c.read_hz,  expected(stub.readLimitHz,  minF, maxF, step));
+  CHECK(c.write_hz < stub.writeLimitHz);
+  CHECK(c.read_hz  < stub.readLimitHz);
+  checkRoundTrip(stored);
+
+  // If the slowest clock fails the previous clocks are kept, reads are tested with slow writes so they fail too
+  tft_spi_clocks before = c;
+  stub.writeLimitHz = 1000000;
+  stub.readLimitHz  = 0;
+  c = stored.calibrateSPI(minF, maxF, step);
+  CHECK_EQ(c.write_hz, before.write_hz);
+  CHECK_EQ(c.read_hz,  before.read_hz);
+
+  return testResult();
+}
@@ -0,0 +1,137 @@
+// Streams built with the DC_stream.h encoders must decode to the bytes and DC levels the panel is meant to see:
+// commands with the DC line low, their arguments and pixels high, high bytes first
+// Also checks the hand assembled tft_dc_io instruction words against their documented fields
+
+#define PICO_NO_HARDWARE 1
+
+#include "test.h"
+#include "Extensions/DC_stream.h"
+#include "Processors/pio_SPI_dc.pio.h"
+#include <vector>
+
+static uint32_t seed = 3;
+static uint32_t rnd(uint32_t n) {
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 8) % n;
+}
+
+struct Sent {
+  uint8_t dc, byte;
+  bool operator==(const Sent &s) const { return (dc == s.dc) && (byte == s.byte); }
+};
+
+static std::vector<Sent> decode(const std::vector<uint32_t> &words, bool *complete = nullptr) {
+  std::vector<Sent> out;
+  bool ok = tft_dc_decode(words.data(), words.size(), [&](uint8_t dc, uint8_t b) { out.push_back({ dc, b }); });
+  if (complete) *complete = ok;
+  return out;
+}
+
+// Instruction encodings, side is the SCLK level
+static uint16_t pull(uint8_t side)                              { return 0x8000 | side << 12 | 0xA0; }
+static uint16_t out(uint8_t side, uint8_t dest, uint8_t bits)   { return 0x6000 | side << 12 | dest << 5 | (bits & 31); }
+static uint16_t jmp(uint8_t side, uint8_t cond, uint8_t addr)   { return 0x0000 | side << 12 | cond << 5 | addr; }
+static uint16_t set(uint8_t side, uint8_t dest, uint8_t value)  { return 0xE000 | side << 12 | dest << 5 | value; }
+
+enum { PINS = 0, X = 1, Y = 2 };
+enum { ALWAYS = 0, NOT_X = 1, Y_DEC = 4 };
+
+int main() {
+  // The program as listed in the header's source
+  {
+    const uint16_t program[] = {
+      pull(0),
+      out(0, X, 1),
+      jmp(0, NOT_X, 5),
+      set(0, PINS, 1),
+      jmp(0, ALWAYS, 6),
+      set(0, PINS, 0),
+      out(0, Y, 31),
+      out(0, PINS, 1),
+      jmp(1, Y_DEC, 7),
+    };
+    CHECK_EQ(sizeof(program), sizeof(tft_dc_io_program_instructions));
+    for (uint32_t i = 0; i < sizeof(program) / 2; i++) CHECK_EQ(tft_dc_io_program_instructions[i], program[i]);
+    CHECK_EQ(tft_dc_io_wrap_target, 0);
+    CHECK_EQ(tft_dc_io_wrap, sizeof(program) / 2 - 1);
+  }
+
+  // Commands with 0 to 16 arguments, the pad byte of an odd count is not sent
+  for (uint32_t t = 0; t < 2000; t++) {
+    uint8_t cmd = rnd(256), args[16];
+    uint32_t n = rnd(17);
+    for (uint32_t i = 0; i < n; i++) args[i] = rnd(256);
+
+    std::vector<uint32_t> words(3 + 8);
+    uint32_t len = tft_dc_command(words.data(), cmd, args, n);
+    CHECK_EQ(len, n ? 3 + (n + 1) / 2 : 2);
+    words.resize(len);
+
+    std::vector<Sent> expect = { { TFT_DC_COMMAND, cmd } };
+    for (uint32_t i = 0; i < n; i++) expect.push_back({ TFT_DC_DATA, args[i] });
+    bool complete;
+    CHECK(decode(words, &complete) == expect);
+    CHECK(complete);
+  }
+
+  // Windows followed by their pixels, several in one stream as the DMA chain sends them
+  for (uint32_t t = 0; t < 500; t++) {
+    std::vector<uint32_t> words;
+    std::vector<Sent> expect;
+
+    for (uint32_t k = rnd(3) + 1; k; k--) {
+      uint16_t x0 = rnd(0x10000), y0 = rnd(0x10000), x1 = rnd(0x10000), y1 = rnd(0x10000);
+      uint32_t len = rnd(40) + 1;
+
+      uint32_t at = words.size();
+      words.resize(at + TFT_DC_WINDOW_WORDS);
+      CHECK_EQ(tft_dc_window(words.data() + at, x0, y0, x1, y1, len), TFT_DC_WINDOW_WORDS);
+
+      const uint8_t  cmds[2] = { 0x2A, 0x2B };
+      const uint16_t pos[2][2] = { { x0, x1 }, { y0, y1 } };
+      for (uint32_t c = 0; c < 2; c++) {
+        expect.push_back({ TFT_DC_COMMAND, cmds[c] });
+        for (uint32_t i = 0; i < 2; i++) {
+          expect.push_back({ TFT_DC_DATA, (uint8_t)(pos[c][i] >> 8) });
+          expect.push_back({ TFT_DC_DATA, (uint8_t)pos[c][i] });
+        }
+      }
+      expect.push_back({ TFT_DC_COMMAND, 0x2C });
+
+      for (uint32_t i = 0; i < len; i++) {
+        uint16_t color = rnd(0x10000);
+        words.push_back(tft_dc_pixel(color));
+        expect.push_back({ TFT_DC_DATA, (uint8_t)(color >> 8) });
+        expect.push_back({ TFT_DC_DATA, (uint8_t)color });
+      }
+    }
+
+    bool complete;
+    std::vector<Sent> sent = decode(words, &complete);
+    CHECK(complete);
+    CHECK_EQ(sent.size(), expect.size());
+    CHECK(sent == expect);
+  }
+
+  // Only the high half of a data word is sent, the low half of a pixel word is its copy from the 16-bit write
+  {
+    std::vector<uint32_t> words = { tft_dc_header(TFT_DC_DATA, 2), 0x12345678 };
+    std::vector<Sent> expect = { { TFT_DC_DATA, 0x12 }, { TFT_DC_DATA, 0x34 } };
+    CHECK(decode(words) == expect);
+    CHECK_EQ(tft_dc_pixel(0xBEEF), 0xBEEFBEEF);
+    CHECK_EQ(tft_dc_header(TFT_DC_COMMAND, 1), 7);
+    CHECK_EQ(tft_dc_header(TFT_DC_DATA, 4), 0x8000001F);
+  }
+
+  // A stream cut short part way through a segment is reported
+  {
+    std::vector<uint32_t> words(TFT_DC_WINDOW_WORDS);
+    tft_dc_window(words.data(), 0, 0, 9, 9, 100);
+    words.push_back(tft_dc_pixel(TFT_RED));
+    bool complete = true;
+    CHECK_EQ(decode(words, &complete).size(), 11 + 2);
+    CHECK(!complete);
+  }
+
+  return testResult();
+}
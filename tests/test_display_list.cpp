@@ -0,0 +1,197 @@
+// Frames replayed by TFT_eDisplayList::end() and endTiled() into an in-memory display must match drawing the
+// same calls immediately, pixel for pixel, as calls change, overlap, are added and removed, and when the
+// damage needs more rectangles than a region holds and falls back to a bounding box
+
+#include "test.h"
+#include "mem_display.h"
+#include <vector>
+
+// Screen size, not a whole number of tiles so edge tiles are partly off screen
+#define W 150
+#define H 100
+#define BG 0x18E3
+
+enum { RECT, HLINE, VLINE, CIRCLE, FILL_CIRCLE, WEDGE, PIXEL, IMAGE, KINDS };
+
+struct Item {
+  uint8_t  kind;
+  int16_t  x, y, w, h;
+  uint16_t color;
+  uint8_t  image;
+};
+
+static uint16_t images[2][12 * 8];
+
+static uint32_t seed = 12345;
+static int32_t rnd(int32_t n) {
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 8) % n;
+}
+
+static Item randomItem(void) {
+  Item it;
+  it.kind  = rnd(KINDS);
+  it.x     = rnd(W + 20) - 10;
+  it.y     = rnd(H + 20) - 10;
+  it.w     = rnd(50) + 1;
+  it.h     = rnd(40) + 1;
+  it.color = rnd(0x10000);
+  it.image = rnd(2);
+  return it;
+}
+
+// Draw the items on a display list or a display, both have the same drawing calls
+template <class T> static void drawScene(T &t, const std::vector<Item> &items) {
+  for (const Item &it : items) {
+    switch (it.kind) {
+      case RECT:        t.fillRect(it.x, it.y, it.w, it.h, it.color); break;
+      case HLINE:       t.drawFastHLine(it.x, it.y, it.w, it.color); break;
+      case VLINE:       t.drawFastVLine(it.x, it.y, it.h, it.color); break;
+      case CIRCLE:      t.drawCircle(it.x, it.y, it.h / 2, it.color); break;
+      case FILL_CIRCLE: t.fillCircle(it.x, it.y, it.h / 2, it.color); break;
+      case PIXEL:       t.drawPixel(it.x, it.y, it.color); break;
+      case IMAGE:       t.pushImage(it.x, it.y, 12, 8, images[it.image]); break;
+      case WEDGE:
+        t.drawWedgeLine(it.x + 0.3f, it.y + 0.6f, it.x + it.w - 25.0f, it.y + it.h - 20.0f,
+                        (it.w % 7) * 0.75f, (it.h % 5) * 1.25f, it.color);
+        break;
+    }
+  }
+}
+
+struct Lists {
+  TFT_eDisplayList flat, tiled;
+  MemDisplay flatMem{W, H}, tiledMem{W, H};
+  uint32_t flatCalls, tiledCalls;
+
+  Lists(void) { flat.setBackground(BG); tiled.setBackground(BG); }
+
+  // Record and replay a frame through both, and check both match immediate drawing
+  void frame(const std::vector<Item> &items, int line) {
+    flat.begin();
+    drawScene(flat, items);
+    flatCalls = flat.end(flatMem);
+
+    tiled.begin();
+    drawScene(tiled, items);
+    tiledCalls = tiled.endTiled(tiledMem);
+
+    MemDisplay ref(W, H);
+    ref.fillScreen(BG);
+    drawScene(ref, items);
+
+    uint32_t bad = 0, badTiled = 0;
+    for (int32_t i = 0; i < W * H; i++) {
+      bad      += (flatMem.pixels()[i]  != ref.pixels()[i]);
+      badTiled += (tiledMem.pixels()[i] != ref.pixels()[i]);
+    }
+    if (bad || badTiled) printf("line %d: %u pixels differ from end(), %u from endTiled()\n", line, bad, badTiled);
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(badTiled, 0);
+  }
+};
+
+int main() {
+  for (int i = 0; i < 12 * 8; i++) { images[0][i] = i * 0x0421; images[1][i] = 0xF800 | i; }
+
+  // Two overlapping rectangles, moving the lower one redraws the upper one over it
+  {
+    Lists l;
+    std::vector<Item> items = { { RECT, 20, 20, 40, 30, TFT_RED, 0 }, { RECT, 40, 30, 40, 30, TFT_GREEN, 0 } };
+    l.frame(items, __LINE__);
+
+    l.frame(items, __LINE__);
+    CHECK_EQ(l.flatCalls, 0);
+    CHECK(l.flat.damage().empty());
+
+    items[0].x += 10;
+    l.frame(items, __LINE__);
+    CHECK_EQ(l.flatCalls, 2);
+
+    // Only the changed call's old and new boxes are damaged
+    const TFT_eRegion &d = l.flat.damage();
+    CHECK(d.contains(20, 20) && d.contains(69, 49));
+    CHECK(!d.contains(79, 59));
+
+    // Same for a change of color only
+    items[1].color = TFT_BLUE;
+    l.frame(items, __LINE__);
+    CHECK(!l.flat.damage().contains(20, 20));
+  }
+
+  // Calls are matched by position: removing one shifts and so redraws those after it, adding one at the end
+  // redraws only its box
+  {
+    Lists l;
+    std::vector<Item> items;
+    for (int i = 0; i < 6; i++) items.push_back({ RECT, (int16_t)(i * 24), 10, 20, 20, (uint16_t)(0x1000 * i + 31), 0 });
+    l.frame(items, __LINE__);
+
+    items.erase(items.begin() + 2);
+    l.frame(items, __LINE__);
+    CHECK_EQ(l.flatCalls, 3);
+
+    items.push_back({ FILL_CIRCLE, 75, 70, 0, 20, TFT_YELLOW, 0 });
+    l.frame(items, __LINE__);
+    CHECK_EQ(l.flatCalls, 1);
+  }
+
+  // A changed image buffer at the same address is seen by its checksum
+  {
+    Lists l;
+    std::vector<Item> items = { { IMAGE, 30, 30, 0, 0, 0, 0 } };
+    l.frame(items, __LINE__);
+    images[0][5] ^= 0xFFFF;
+    l.frame(items, __LINE__);
+    CHECK_EQ(l.flatCalls, 1);
+  }
+
+  // More changed calls than a region has rectangles, the damage falls back to their bounding box
+  {
+    Lists l;
+    std::vector<Item> items;
+    for (int i = 0; i < 40; i++) items.push_back({ PIXEL, (int16_t)(5 + i * 3), (int16_t)(5 + (i * 7) % 80), 0, 0, TFT_WHITE, 0 });
+    items.push_back({ RECT, 0, 0, 3, 3, TFT_RED, 0 });
+    items.push_back({ RECT, 140, 95, 10, 5, TFT_RED, 0 });
+    l.frame(items, __LINE__);
+
+    for (int i = 0; i < 40; i++) items[i].color = TFT_MAGENTA;
+    l.frame(items, __LINE__);
+    const TFT_eRegion &d = l.flat.damage();
+    uint32_t area = 0, held = 0;
+    for (int32_t y = 0; y < H; y++) for (int32_t x = 0; x < W; x++) area += d.contains(x, y);
+    for (int i = 0; i < 40; i++) held += d.contains(items[i].x, items[i].y);
+    CHECK_EQ(held, 40);
+    CHECK(area > 40 * 40);
+    CHECK(d.count() <= TFT_REGION_RECTS);
+    CHECK(!d.contains(0, 0) && !d.contains(145, 97));
+    CHECK_EQ(l.flatCalls, 40);
+  }
+
+  // Random scenes, each frame changes, adds or removes a few calls
+  {
+    Lists l;
+    std::vector<Item> items;
+    for (int i = 0; i < 24; i++) items.push_back(randomItem());
+    l.frame(items, __LINE__);
+
+    for (int f = 0; f < 300; f++) {
+      int changes = rnd(4) + 1;
+      for (int c = 0; c < changes; c++) {
+        uint32_t i = rnd(items.size());
+        switch (rnd(8)) {
+          case 0:  items.insert(items.begin() + i, randomItem()); break;
+          case 1:  if (items.size() > 4) items.erase(items.begin() + i); break;
+          case 2:  items[i].color = rnd(0x10000); break;
+          case 3:  items[i].w = rnd(50) + 1; items[i].h = rnd(40) + 1; break;
+          case 4:  images[rnd(2)][rnd(12 * 8)] = rnd(0x10000); break;
+          default: items[i].x += rnd(21) - 10; items[i].y += rnd(21) - 10; break;
+        }
+      }
+      if (items.size() > 40) items.resize(40);
+      l.frame(items, __LINE__);
+    }
+  }
+
+  return testResult();
+}
@@ -0,0 +1,132 @@
+// color24to16Row() on flat fields of every 8-bit value: over a period of the Bayer or blue noise pattern each
+// channel's mean level must be the exact value, v * levels / 255, within the 1/64 level the scale is rounded to,
+// every pixel must be one of the two levels either side, and TFT_DITHER_NONE must round to the nearest level
+// The three channels share a word and must not carry into each other. pushImage24() must clip at every edge
+
+#include "test.h"
+#include <math.h>
+#include <vector>
+
+// Screen size, so the panel RAM beyond the right and bottom of the screen shows anything drawn past them
+#define W 200
+#define H 280
+
+// Period of both patterns
+#define PERIOD 16
+
+static uint32_t seed = 23;
+static uint32_t rnd(uint32_t n) {
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 8) % n;
+}
+
+static uint16_t convert(TFT_eSPI &tft, uint8_t r, uint8_t g, uint8_t b, int32_t x, int32_t y, uint8_t dither) {
+  const uint8_t rgb[3] = { r, g, b };
+  uint16_t c;
+  tft.color24to16Row(rgb, &c, 1, x, y, dither);
+  return c;
+}
+
+int main() {
+  stub_reset();
+  tft_bus_config cfg = TFT_BUS_CONFIG_DEFAULT;
+  cfg.width  = W;
+  cfg.height = H;
+  TFT_eSPI tft(cfg);
+  tft.begin();
+
+  const uint32_t levels[3] = { 31, 63, 31 };
+  const uint32_t shift[3]  = { 11, 5, 0 };
+
+  // Flat fields of each value, a different one in each channel, over a period of each pattern at an offset
+  for (uint8_t dither : { TFT_DITHER_BAYER, TFT_DITHER_BLUE_NOISE }) {
+    uint32_t bad = 0, outside = 0;
+    std::vector<uint8_t> rgb(PERIOD * 3);
+    uint16_t out[PERIOD];
+
+    for (uint32_t v = 0; v < 256; v++) {
+      const uint8_t value[3] = { (uint8_t)v, (uint8_t)(255 - v), (uint8_t)(v * 7) };
+      for (uint32_t i = 0; i < PERIOD; i++)
+        for (uint32_t c = 0; c < 3; c++) rgb[i * 3 + c] = value[c];
+
+      uint32_t sum[3] = { 0, 0, 0 };
+      for (int32_t y = 5; y < 5 + PERIOD; y++) {
+        tft.color24to16Row(rgb.data(), out, PERIOD, 9, y, dither);
+        for (uint32_t i = 0; i < PERIOD; i++)
+          for (uint32_t c = 0; c < 3; c++) {
+            uint32_t level = out[i] >> shift[c] & levels[c];
+            double exact = value[c] * levels[c] / 255.0;
+            outside += (level < floor(exact)) || (level > ceil(exact));
+            sum[c] += level;
+          }
+      }
+
+      for (uint32_t c = 0; c < 3; c++) {
+        double mean = sum[c] / (double)(PERIOD * PERIOD), exact = value[c] * levels[c] / 255.0;
+        if (fabs(mean - exact) > 1.0 / 64 + 1e-9) {
+          if (!bad) printf("dither %u channel %u value %u: mean level %.4f, exact %.4f\n", dither, c, value[c], mean, exact);
+          bad++;
+        }
+      }
+    }
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(outside, 0);
+  }
+
+  // No dithering rounds each channel to the nearest level, v * levels / 255 is never half way between two
+  {
+    uint32_t bad = 0;
+    for (uint32_t v = 0; v < 256; v++)
+      for (int32_t x = 0; x < PERIOD; x++) {
+        uint16_t c = convert(tft, v, 255 - v, v ^ 0x55, x, x * 3, TFT_DITHER_NONE);
+        const uint32_t value[3] = { v, 255 - v, v ^ 0x55 };
+        for (uint32_t k = 0; k < 3; k++) bad += ((c >> shift[k] & levels[k]) != (value[k] * levels[k] * 2 + 255) / 510);
+      }
+    CHECK_EQ(bad, 0);
+  }
+
+  // Each channel of a pixel is converted as if the others were zero, the lanes do not carry into each other
+  {
+    uint32_t bad = 0;
+    for (uint32_t t = 0; t < 100000; t++) {
+      uint8_t r = rnd(256), g = rnd(256), b = rnd(256), dither = rnd(3);
+      int32_t x = rnd(1000), y = rnd(1000);
+      uint16_t c = convert(tft, r, g, b, x, y, dither);
+      bad += (c != (convert(tft, r, 0, 0, x, y, dither) | convert(tft, 0, g, 0, x, y, dither) | convert(tft, 0, 0, b, x, y, dither)));
+    }
+    CHECK_EQ(bad, 0);
+  }
+
+  // Images over each edge of the screen and wider than a converted run, with and without swapped bytes
+  {
+    uint32_t bad = 0;
+    static uint16_t expect[STUB_RAM_WIDTH * STUB_RAM_HEIGHT];
+    for (uint32_t t = 0; t < 200; t++) {
+      int32_t w = rnd(150) + 1, h = rnd(60) + 1;
+      int32_t x = (int32_t)rnd(W + w + 20) - w - 10, y = (int32_t)rnd(H + h + 20) - h - 10;
+      uint8_t dither = rnd(3);
+      std::vector<uint8_t> rgb(w * h * 3);
+      for (uint8_t &v : rgb) v = rnd(256);
+      tft.setSwapBytes(t & 1);
+
+      for (int32_t i = 0; i < STUB_RAM_WIDTH * STUB_RAM_HEIGHT; i++) stub.ram[i] = 0x1234;
+      memcpy(expect, stub.ram, sizeof(expect));
+      for (int32_t j = 0; j < h; j++)
+        for (int32_t i = 0; i < w; i++) {
+          int32_t px = x + i, py = y + j;
+          const uint8_t *p = &rgb[(j * w + i) * 3];
+          if ((px >= 0) && (px < W) && (py >= 0) && (py < H)) expect[py * STUB_RAM_WIDTH + px] = convert(tft, p[0], p[1], p[2], px, py, dither);
+        }
+
+      stub_reset_counters();
+      tft.pushImage24(x, y, w, h, rgb.data(), dither);
+      bad += (memcmp(expect, stub.ram, sizeof(expect)) != 0);
+      bad += (stub.ramWrites > 1);
+      bad += (tft.getSwapBytes() != (bool)(t & 1));
+    }
+    tft.setSwapBytes(false);
+    CHECK_EQ(bad, 0);
+  }
+
+  return testResult();
+}
@@ -0,0 +1,97 @@
+// DMA fills read one color word over and over in 16-bit transfers paced by the SPI port's TX request,
+// and buffers pushed back to back are chained so each is triggered by the one before it
+
+#include "test.h"
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  CHECK(tft.initDMA());
+  CHECK(!tft.initDMA());
+  CHECK(stub.dma[0].claimed && stub.dma[1].claimed);
+
+  // Leave the channel busy for a few polls so completion has to be waited for
+  stub.dmaBusyPolls = 3;
+  stub_reset_counters();
+  tft.fillRectAsync(20, 30, 100, 50, TFT_MAGENTA);
+
+  stub_dma_channel &d = stub.dma[0];
+  CHECK_EQ(d.config.size, DMA_SIZE_16);
+  CHECK(!d.config.read_increment);
+  CHECK(!d.config.write_increment);
+  CHECK(!d.config.bswap);
+  CHECK_EQ(d.config.dreq, DREQ_SPI0_TX);
+  CHECK_EQ(d.config.chain_to, 0);
+  CHECK(d.write_addr == &spi_get_hw(spi0)->dr);
+  CHECK_EQ(d.count, 100 * 50);
+  CHECK_EQ(d.triggers, 1);
+  CHECK_EQ(d.transfers, 100 * 50);
+  CHECK_EQ(stub.dma[1].triggers, 0);
+
+  // The read address is a single word holding the color, it is not stepped or changed by the transfer
+  const volatile uint16_t *src = (const volatile uint16_t *)d.read_addr;
+  CHECK_EQ(*src, TFT_MAGENTA);
+
+  CHECK(tft.dmaBusy());
+  CHECK_EQ(stub_pixel(20, 30), TFT_MAGENTA);
+  CHECK_EQ(stub_pixel(119, 79), TFT_MAGENTA);
+  CHECK_EQ(stub_pixel(120, 79), 0);
+  CHECK_EQ(stub.pixelsWritten, 100 * 50);
+
+  // CS is held and the frames stay 16-bit until the transfer is retired
+  CHECK_EQ(stub.frameBits, 16);
+  CHECK(!(stub.pins & (1u << STUB_PANEL_CS)));
+  tft.dmaWait();
+  CHECK(!tft.dmaBusy());
+  CHECK_EQ(stub.frameBits, 8);
+  CHECK(stub.pins & (1u << STUB_PANEL_CS));
+  CHECK(d.read_addr == src);
+  CHECK_EQ(stub.csConflicts, 0);
+  CHECK_EQ(stub.csAsserts, 1);
+
+  // Large fills go to DMA, small ones are sent by the CPU
+  stub.dmaBusyPolls = 0;
+  stub_reset_counters();
+  tft.fillScreen(TFT_YELLOW);
+  tft.dmaWait();
+  CHECK_EQ(stub.dma[0].triggers, 1);
+  CHECK_EQ(stub.dma[0].count, 240 * 320);
+  CHECK_EQ(stub.pixelsWritten, 240 * 320);
+  CHECK_EQ(stub_pixel(239, 319), TFT_YELLOW);
+
+  stub_reset_counters();
+  tft.fillRect(0, 0, 7, 9, TFT_RED);
+  CHECK_EQ(stub.dma[0].triggers, 0);
+  CHECK_EQ(stub_pixel(6, 8), TFT_RED);
+
+  // Buffers pushed while one is on the wire are chained to it and read with the read address stepping
+  static uint16_t line[2][64];
+  for (int i = 0; i < 64; i++) { line[0][i] = i; line[1][i] = 0x8000 | i; }
+
+  stub.dmaBusyPolls = 100;
+  stub_reset_counters();
+  tft.startWrite();
+  tft.setWindow(0, 0, 63, 1);
+  tft.pushColorsAsync(line[0], 64);
+  tft.pushColorsAsync(line[1], 64);
+  tft.endWrite();
+  tft.dmaWait();
+
+  CHECK_EQ(stub.dma[0].triggers + stub.dma[1].triggers, 2);
+  CHECK_EQ(stub.dma[0].transfers + stub.dma[1].transfers, 128);
+  CHECK(stub.dma[0].config.read_increment && stub.dma[1].config.read_increment);
+  CHECK_EQ(stub.dma[0].config.size, DMA_SIZE_16);
+  CHECK_EQ(stub.dma[1].config.size, DMA_SIZE_16);
+  CHECK_EQ(stub.dma[1].config.dreq, DREQ_SPI0_TX);
+  CHECK_EQ(stub_pixel(63, 0), 63);
+  CHECK_EQ(stub_pixel(0, 1), 0x8000);
+  CHECK_EQ(stub_pixel(63, 1), 0x803F);
+  CHECK_EQ(stub.csConflicts, 0);
+
+  tft.deInitDMA();
+  CHECK(!stub.dma[0].claimed && !stub.dma[1].claimed);
+
+  return testResult();
+}
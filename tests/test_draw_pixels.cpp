@@ -0,0 +1,105 @@
+// drawPixels() must leave the panel as drawing the same points in turn with drawPixel() does: the last color
+// of a duplicated point wins, and runs crossing the edges of the screen are cut at them
+// Checked sent directly, through a clip region and through the shadow buffer
+
+#include "test.h"
+#include <vector>
+
+static uint32_t seed = 7;
+static int32_t rnd(int32_t n) {
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 8) % n;
+}
+
+// Points crowded into the corners and edges so there are duplicates and runs off each side
+static std::vector<tft_pixel> randomPixels(uint32_t n) {
+  std::vector<tft_pixel> p(n);
+  for (tft_pixel &q : p) {
+    int32_t x = rnd(16) - 8, y = rnd(6) - 1;
+    if (rnd(2)) x += 240;
+    if (rnd(2)) y += 316;
+    q = { (int16_t)x, (int16_t)y, (uint16_t)(rnd(0xFFFF) + 1) };
+  }
+  return p;
+}
+
+static std::vector<uint16_t> snapshot(void) {
+  return std::vector<uint16_t>(stub.ram, stub.ram + STUB_RAM_WIDTH * STUB_RAM_HEIGHT);
+}
+
+static uint32_t differ(const std::vector<uint16_t> &a) {
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < a.size(); i++) n += (a[i] != stub.ram[i]);
+  return n;
+}
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  TFT_eRegion all(0, 0, 240, 320);
+  static uint16_t shadow[240 * 320];
+
+  for (uint32_t t = 0; t < 50; t++) {
+    std::vector<tft_pixel> p = randomPixels(300);
+
+    tft.fillScreen(TFT_BLACK);
+    for (const tft_pixel &q : p) tft.drawPixel(q.x, q.y, q.color);
+    std::vector<uint16_t> ref = snapshot();
+
+    // Sent as runs
+    std::vector<tft_pixel> q = p;
+    tft.fillScreen(TFT_BLACK);
+    stub_reset_counters();
+    tft.drawPixels(q.data(), q.size());
+    CHECK_EQ(differ(ref), 0);
+    CHECK(stub.commands < 3 * p.size());
+
+    // Through a clip region, which draws the points in turn
+    q = p;
+    tft.fillScreen(TFT_BLACK);
+    tft.setClipRegion(&all);
+    tft.drawPixels(q.data(), q.size());
+    tft.setClipRegion(nullptr);
+    CHECK_EQ(differ(ref), 0);
+
+    // Through the shadow buffer
+    q = p;
+    tft.fillScreen(TFT_BLACK);
+    CHECK(tft.shadowBegin(shadow));
+    tft.drawPixels(q.data(), q.size());
+    tft.shadowEnd();
+    CHECK_EQ(differ(ref), 0);
+
+    // One color, runs over the edges
+    std::vector<tft_point> pts;
+    for (const tft_pixel &r : p) pts.push_back({ r.x, r.y });
+    tft.fillScreen(TFT_BLACK);
+    for (const tft_point &r : pts) tft.drawPixel(r.x, r.y, TFT_GREEN);
+    ref = snapshot();
+    tft.fillScreen(TFT_BLACK);
+    tft.drawPixels(pts.data(), pts.size(), TFT_GREEN);
+    CHECK_EQ(differ(ref), 0);
+  }
+
+  // A row crossing both edges is sent as one window cut to the screen
+  std::vector<tft_point> row;
+  for (int16_t x = -10; x < 250; x++) row.push_back({ x, 5 });
+  tft.fillScreen(TFT_BLACK);
+  stub_reset_counters();
+  tft.drawPixels(row.data(), row.size(), TFT_RED);
+  CHECK_EQ(stub.pixelsWritten, 240);
+  CHECK_EQ(stub_pixel(0, 5), TFT_RED);
+  CHECK_EQ(stub_pixel(239, 5), TFT_RED);
+  CHECK_EQ(stub.xs, 0);
+  CHECK_EQ(stub.xe, 239);
+
+  // Three colors at one point, the last is drawn
+  tft_pixel dup[4] = { { 3, 3, TFT_RED }, { 4, 3, TFT_WHITE }, { 3, 3, TFT_GREEN }, { 3, 3, TFT_BLUE } };
+  tft.drawPixels(dup, 4);
+  CHECK_EQ(stub_pixel(3, 3), TFT_BLUE);
+  CHECK_EQ(stub_pixel(4, 3), TFT_WHITE);
+
+  return testResult();
+}
@@ -0,0 +1,230 @@
+// TFT_eGradient::fill() on the stub must draw what row() computes, for each of its orders: linear along x sent a
+// column of runs at a time by pushColorsAsync() with byte swapping forced off, linear along y as a solid color
+// per row, and row at a time for a general line, radial and conic, dithered or not, with and without DMA
+// row() is checked against the stops interpolated in floating point, clamped before the first stop and after the
+// last, with the conic wrapping from the last stop to the first, to within the 1/255 steps of the color line
+
+#include "test.h"
+#include "Extensions/Gradient.h"
+#include <math.h>
+#include <vector>
+
+// Screen size, so the panel RAM beyond the right and bottom of the screen shows anything drawn past them
+#define W 200
+#define H 280
+#define BG 0x1234
+
+struct Stop { double pos; uint32_t color; };
+
+// The gradient as shaped and the stops as added, sorted as addStop() keeps them
+struct Model {
+  uint8_t mode;
+  double x, y, a, b, c;
+  std::vector<Stop> stops;
+
+  void add(double pos, uint32_t color) {
+    pos = std::min(std::max(pos, 0.0), 1.0);
+    size_t i = stops.size();
+    while ((i > 0) && (stops[i - 1].pos > pos)) i--;
+    stops.insert(stops.begin() + i, { pos, color });
+  }
+
+  // Channel ch of the color at p, the first stop's color before it and the last one's after it
+  double channel(double p, uint32_t ch) const {
+    if (stops.empty()) return 0;
+    auto value = [&](const Stop &s) { return (double)(s.color >> (16 - 8 * ch) & 0xFF); };
+    if (p < stops.front().pos) return value(stops.front());
+    for (size_t k = 1; k < stops.size(); k++)
+      if (p < stops[k].pos) return value(stops[k - 1]) + (value(stops[k]) - value(stops[k - 1])) * (p - stops[k - 1].pos) / (stops[k].pos - stops[k - 1].pos);
+    return value(stops.back());
+  }
+
+  // Position of a pixel along the line. The conic's position is its fraction of a turn in 1/256ths, as an entry
+  // of the color line, so the last entry is the last 1/256th of the turn and can be past 1
+  double position(int32_t px, int32_t py) const {
+    double dx = px - x, dy = py - y;
+    if (mode == TFT_GRADIENT_LINEAR) return std::min(std::max((dx * a + dy * b) / (a * a + b * b), 0.0), 1.0);
+    if (mode == TFT_GRADIENT_RADIAL) return std::min(hypot(dx, dy) / c, 1.0);
+    double f = atan2(-dx, dy) / (2 * M_PI) - c / 360.0;
+    f -= floor(f);
+    return f * 256.0 / 255.0;
+  }
+};
+
+// Whether a 565 color is within the stops' colors over an entry and a half of the color line either side of the
+// pixel's position, each channel between the levels either side of the range, or the nearest if it is flat
+static bool matches(const Model &m, uint16_t c, int32_t px, int32_t py, bool dithered) {
+  const uint32_t levels[3] = { 31, 63, 31 }, shift[3] = { 11, 5, 0 };
+  const double d = 1.5 / 255;
+  double p = m.position(px, py);
+
+  std::vector<double> at = { p - d, p + d };
+  for (const Stop &s : m.stops)
+    if ((s.pos > p - d) && (s.pos < p + d)) at.push_back(s.pos);
+  if (m.mode == TFT_GRADIENT_CONIC) {
+    // The line wraps, the last entry meets the first
+    if (p + d > 1.0) at.push_back(0.0);
+    if (p - d < 0.0) at.push_back(1.0);
+  }
+
+  for (uint32_t ch = 0; ch < 3; ch++) {
+    double lo = 255, hi = 0;
+    for (double q : at) {
+      double v = m.channel(std::min(std::max(q, 0.0), 1.0), ch);
+      lo = std::min(lo, v);
+      hi = std::max(hi, v);
+    }
+
+    // The line is interpolated to the nearest 8-bit value
+    uint32_t level = c >> shift[ch] & levels[ch];
+    if ((hi - lo < 1e-9) && !dithered) {
+      if (level != (uint32_t)floor(lo * levels[ch] / 255 + 0.5)) return false;
+      continue;
+    }
+    if ((level < floor((lo - 1) * levels[ch] / 255)) || (level > ceil((hi + 1) * levels[ch] / 255))) return false;
+  }
+  return true;
+}
+
+static uint16_t nearest(uint32_t rgb) {
+  uint32_t r = rgb >> 16 & 0xFF, g = rgb >> 8 & 0xFF, b = rgb & 0xFF;
+  return (r * 31 * 2 + 255) / 510 << 11 | (g * 63 * 2 + 255) / 510 << 5 | (b * 31 * 2 + 255) / 510;
+}
+
+// Shape both the gradient and its model
+static void shape(TFT_eGradient &g, Model &m, uint8_t mode, double x0, double y0, double x1, double y1) {
+  m.mode = mode;
+  m.x = x0;
+  m.y = y0;
+  switch (mode) {
+    case TFT_GRADIENT_LINEAR: g.linear(x0, y0, x1, y1); m.a = x1 - x0; m.b = y1 - y0; break;
+    case TFT_GRADIENT_RADIAL: g.radial(x0, y0, x1); m.c = x1; break;
+    default:                  g.conic(x0, y0, x1); m.c = x1; break;
+  }
+}
+
+int main() {
+  stub_reset();
+  tft_bus_config cfg = TFT_BUS_CONFIG_DEFAULT;
+  cfg.width  = W;
+  cfg.height = H;
+  TFT_eSPI tft(cfg);
+  tft.begin();
+
+  TFT_eGradient g;
+  Model m;
+  const Stop stops[3] = { { 0.15, 0xFF2000 }, { 0.5, 0x20FF80 }, { 0.85, 0x0030FF } };
+  for (int i = 2; i >= 0; i--) {
+    CHECK(g.addStop(stops[i].pos, stops[i].color));
+    m.add(stops[i].pos, stops[i].color);
+  }
+
+  // Each fill order, from the shapes that pick it
+  struct Shape { const char *name; uint8_t mode; double x0, y0, x1, y1; };
+  const Shape shapes[] = {
+    { "linear along x", TFT_GRADIENT_LINEAR, 10.3, 0.0, 190.7, 0.0 },
+    { "linear along y", TFT_GRADIENT_LINEAR, 0.0, 20.5, 0.0, 250.2 },
+    { "linear",         TFT_GRADIENT_LINEAR, 30.0, 40.0, 170.0, 230.0 },
+    { "radial",         TFT_GRADIENT_RADIAL, 100.5, 120.25, 90.0, 0.0 },
+    { "conic",          TFT_GRADIENT_CONIC,  110.3, 140.6, 37.0, 0.0 },
+  };
+
+  static uint16_t expect[STUB_RAM_WIDTH * STUB_RAM_HEIGHT];
+  std::vector<uint16_t> row(W + 100);
+
+  for (const Shape &s : shapes) {
+    shape(g, m, s.mode, s.x0, s.y0, s.x1, s.y1);
+
+    for (uint8_t dither : { TFT_DITHER_NONE, TFT_DITHER_BAYER, TFT_DITHER_BLUE_NOISE }) {
+      g.setDither(dither);
+
+      // row() against the model over the whole screen and past its left edge
+      uint32_t wrong = 0;
+      for (int32_t y = 0; y < H; y++) {
+        g.row(&tft, row.data(), -20, y, W + 20);
+        for (int32_t x = -20; x < W; x++) {
+          if (!matches(m, row[x + 20], x, y, dither != TFT_DITHER_NONE)) {
+            if (!wrong) printf("%s, dither %u: pixel %d, %d is %04x\n", s.name, dither, x, y, row[x + 20]);
+            wrong++;
+          }
+        }
+      }
+      CHECK_EQ(wrong, 0);
+
+      // fill() of a rectangle over the screen edges and of one within it, with swapped bytes and DMA on and off
+      const int32_t rects[2][4] = { { -13, -7, W + 30, 150 }, { 21, 37, 150, 201 } };
+      for (uint32_t k = 0; k < 8; k++) {
+        const int32_t *r = rects[k & 1];
+        bool swap = k & 2;
+        tft.setSwapBytes(swap);
+        if (k == 4) tft.initDMA();
+
+        for (int32_t i = 0; i < STUB_RAM_WIDTH * STUB_RAM_HEIGHT; i++) stub.ram[i] = BG;
+        memcpy(expect, stub.ram, sizeof(expect));
+        int32_t x0 = std::max<int32_t>(r[0], 0), x1 = std::min<int32_t>(r[0] + r[2], W);
+        int32_t y0 = std::max<int32_t>(r[1], 0), y1 = std::min<int32_t>(r[1] + r[3], H);
+        for (int32_t y = y0; y < y1; y++) {
+          g.row(&tft, row.data(), x0, y, x1 - x0);
+          memcpy(expect + y * STUB_RAM_WIDTH + x0, row.data(), (x1 - x0) * 2);
+        }
+
+        g.fill(&tft, r[0], r[1], r[2], r[3]);
+        if (memcmp(expect, stub.ram, sizeof(expect)) != 0) {
+          printf("%s, dither %u, rectangle %u, swap %u, dma %u: fill differs from row\n", s.name, dither, k & 1, swap, k >= 4);
+          CHECK(false);
+        }
+        CHECK_EQ(tft.getSwapBytes(), swap);
+      }
+      tft.deInitDMA();
+      tft.setSwapBytes(false);
+    }
+  }
+
+  // Stops are clamped to the ends of the line, before the first and after the last the end colors are drawn as
+  // their nearest 565 colors, and the conic wraps from the last stop to the first at its start angle
+  g.setDither(TFT_DITHER_NONE);
+  {
+    shape(g, m, TFT_GRADIENT_LINEAR, 10.0, 0.0, 190.0, 0.0);
+    g.row(&tft, row.data(), 0, 0, W);
+    for (int32_t x = 0; x < 10 + 0.15 * 180 - 2; x++) CHECK_EQ(row[x], nearest(0xFF2000));
+    for (int32_t x = 10 + 0.85 * 180 + 2; x < W; x++) CHECK_EQ(row[x], nearest(0x0030FF));
+    g.row(&tft, row.data(), 100, 0, 1);
+    CHECK_EQ(row[0], nearest(0x20FF80));
+
+    // Clockwise from 6 o'clock on screen is towards -x
+    const double cx = 100.5, cy = 140.5, start = 37.0;
+    shape(g, m, TFT_GRADIENT_CONIC, cx, cy, start, 0.0);
+    for (double da : { 2.0, -2.0 }) {
+      double t = (start + da) * M_PI / 180.0;
+      int32_t px = (int32_t)floor(cx - 60.0 * sin(t) + 0.5), py = (int32_t)floor(cy + 60.0 * cos(t) + 0.5);
+      g.row(&tft, row.data(), px, py, 1);
+      CHECK_EQ(row[0], nearest((da > 0) ? 0xFF2000 : 0x0030FF));
+    }
+  }
+
+  // Two stops at one position give a hard edge in the order they were added, positions beyond the ends clamp
+  {
+    g.clearStops();
+    CHECK(g.addStop(0.5f, 0xFF0000));
+    CHECK(g.addStop(0.5f, 0x0000FF));
+    CHECK(g.addStop(-1.0f, 0x00FF00));
+    CHECK(g.addStop(2.0f, 0xFFFFFF));
+    g.linear(0.0f, 0.0f, 255.0f, 0.0f);
+    g.row(&tft, row.data(), 0, 0, W);
+    CHECK_EQ(row[0], TFT_GREEN);
+    CHECK_EQ(row[127], TFT_RED);
+    CHECK_EQ(row[128], TFT_BLUE);
+    g.row(&tft, row.data(), 255, 0, 1);
+    CHECK_EQ(row[0], TFT_WHITE);
+
+    for (int i = 4; i < TFT_GRADIENT_STOPS; i++) CHECK(g.addStop(0.9f, 0));
+    CHECK(!g.addStop(0.9f, 0));
+
+    // Without stops a gradient is black
+    g.clearStops();
+    g.row(&tft, row.data(), 0, 0, 1);
+    CHECK_EQ(row[0], TFT_BLACK);
+  }
+
+  return testResult();
+}
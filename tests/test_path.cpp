@@ -0,0 +1,287 @@
+// TFT_ePath fills and strokes against coverage found by sampling each pixel on a 32 x 32 grid: a convex fill,
+// a self-crossing star under the even-odd and non-zero rules, and polylines, open and closed, stroked with
+// each join. Pixels holding a point where a fill's edges cross are left out: the cells sum the area times the
+// winding, so where it is both 1 and 2 within a pixel the rule folds a mean and neither rule is exact there
+// The stroke reference is the union of a rectangle per line with, at each corner, a disc for round
+// joins, the triangle across the outside of the turn for bevels, and that triangle out to the miter tip for
+// miters within TFT_PATH_MITER_LIMIT half widths. Round joins also give discs at the ends of open lines
+
+#include "test.h"
+#include <math.h>
+#include <vector>
+
+#define GRID 32
+
+// Coverage tolerance in 1/256ths: the grid is good to 256 / GRID for a straight edge across a pixel, corners
+// are rounded to 1/256 pixel, and round joins are flattened to within TFT_PATH_TOLERANCE
+#define TOL       (256 / GRID + 4)
+#define TOL_ROUND (TOL + TFT_PATH_TOLERANCE)
+
+#define BG     0x18E3
+#define MARKER 0x0821
+
+struct P { double x, y; };
+typedef std::vector<P> Poly;
+
+// Polygon containment by winding number
+static int winding(const std::vector<Poly> &polys, double x, double y) {
+  int w = 0;
+  for (const Poly &p : polys) {
+    for (size_t i = 0; i < p.size(); i++) {
+      const P &a = p[i], &b = p[(i + 1) % p.size()];
+      if ((a.y <= y) == (b.y <= y)) continue;
+      double cross = (b.x - a.x) * (y - a.y) - (x - a.x) * (b.y - a.y);
+      w += (b.y > a.y) ? (cross > 0) : -(cross < 0);
+    }
+  }
+  return w;
+}
+
+// Fill of polygons by a rule
+struct Fill {
+  std::vector<Poly> polys;
+  uint8_t rule;
+
+  // Whether an edge comes within a pixel
+  bool near(int32_t x, int32_t y) const {
+    for (const Poly &p : polys)
+      for (size_t i = 0; i < p.size(); i++) {
+        const P &a = p[i], &b = p[(i + 1) % p.size()];
+        double dx = b.x - a.x, dy = b.y - a.y, len = hypot(dx, dy);
+        double s = std::min(std::max(((x - a.x) * dx + (y - a.y) * dy) / (len * len), 0.0), 1.0);
+        if (hypot(x - a.x - s * dx, y - a.y - s * dy) <= 0.75) return true;
+      }
+    return false;
+  }
+
+  bool inside(double x, double y) const {
+    int w = winding(polys, x, y);
+    return (rule == TFT_FILL_EVEN_ODD) ? (w & 1) : (w != 0);
+  }
+};
+
+// Points where the edges of a polygon cross each other
+static std::vector<P> crossings(const Poly &p) {
+  std::vector<P> out;
+  size_t n = p.size();
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = i + 2; j < n; j++) {
+      if ((i == 0) && (j == n - 1)) continue;
+      const P &a = p[i], &b = p[i + 1], &c = p[j], &d = p[(j + 1) % n];
+      double den = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
+      if (den == 0) continue;
+      double s = ((c.x - a.x) * (d.y - c.y) - (c.y - a.y) * (d.x - c.x)) / den;
+      double t = ((c.x - a.x) * (b.y - a.y) - (c.y - a.y) * (b.x - a.x)) / den;
+      if ((s > 0) && (s < 1) && (t > 0) && (t < 1)) out.push_back({ a.x + s * (b.x - a.x), a.y + s * (b.y - a.y) });
+    }
+  return out;
+}
+
+// Point in a convex polygon of either orientation
+static bool inConvex(const Poly &p, double x, double y) {
+  bool pos = false, neg = false;
+  for (size_t i = 0; i < p.size(); i++) {
+    const P &a = p[i], &b = p[(i + 1) % p.size()];
+    double c = (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+    pos |= (c > 0);
+    neg |= (c < 0);
+  }
+  return !(pos && neg);
+}
+
+// Stroke of a polyline hw pixels either side of it
+struct Stroke {
+  Poly pts;
+  bool closed;
+  double hw;
+  uint8_t join;
+  std::vector<Poly> corners;  // Bevel triangles and miter quads
+
+  Stroke(const Poly &p, bool c, double h, uint8_t j) : pts(p), closed(c), hw(h), join(j) {
+    size_t n = pts.size();
+    for (size_t i = 0; i < n; i++) {
+      if (!closed && ((i == 0) || (i == n - 1))) continue;
+      const P &a = pts[(i + n - 1) % n], &v = pts[i], &b = pts[(i + 1) % n];
+      P d1 = { v.x - a.x, v.y - a.y }, d2 = { b.x - v.x, b.y - v.y };
+      double l1 = hypot(d1.x, d1.y), l2 = hypot(d2.x, d2.y);
+      P n1 = { d1.y * hw / l1, -d1.x * hw / l1 }, n2 = { d2.y * hw / l2, -d2.x * hw / l2 };
+
+      for (int s = -1; s <= 1; s += 2) {
+        P na = { s * n1.x, s * n1.y }, nb = { s * n2.x, s * n2.y };
+        if (d2.x * na.x + d2.y * na.y >= 0) continue;  // Inside of the turn, or straight on
+
+        double k = hw * hw + na.x * nb.x + na.y * nb.y;
+        bool miter = (join == TFT_JOIN_MITER) && (k * TFT_PATH_MITER_LIMIT * TFT_PATH_MITER_LIMIT >= 2 * hw * hw);
+        if (miter) {
+          double r = hw * hw / k;
+          corners.push_back({ v, { v.x + na.x, v.y + na.y }, { v.x + (na.x + nb.x) * r, v.y + (na.y + nb.y) * r }, { v.x + nb.x, v.y + nb.y } });
+        }
+        else if (join != TFT_JOIN_ROUND) corners.push_back({ v, { v.x + na.x, v.y + na.y }, { v.x + nb.x, v.y + nb.y } });
+      }
+    }
+  }
+
+  // Whether the stroke comes within a pixel: within a pixel of a line, a round join, or a corner's edges
+  bool near(int32_t x, int32_t y) const {
+    size_t n = pts.size(), segs = closed ? n : n - 1;
+    for (size_t i = 0; i < segs; i++) {
+      const P &a = pts[i], &b = pts[(i + 1) % n];
+      double dx = b.x - a.x, dy = b.y - a.y, len = hypot(dx, dy);
+      double s = ((x - a.x) * dx + (y - a.y) * dy) / len, t = ((x - a.x) * dy - (y - a.y) * dx) / len;
+      if ((s >= -1) && (s <= len + 1) && (fabs(t) <= hw + 1)) return true;
+    }
+    if (join == TFT_JOIN_ROUND) {
+      for (const P &v : pts)
+        if (hypot(x - v.x, y - v.y) <= hw + 1) return true;
+    }
+    for (const Poly &c : corners) {
+      if (inConvex(c, x, y)) return true;
+      for (size_t i = 0; i < c.size(); i++) {
+        const P &a = c[i], &b = c[(i + 1) % c.size()];
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double s = std::min(std::max(((x - a.x) * dx + (y - a.y) * dy) / (dx * dx + dy * dy), 0.0), 1.0);
+        if (hypot(x - a.x - s * dx, y - a.y - s * dy) <= 1) return true;
+      }
+    }
+    return false;
+  }
+
+  bool inside(double x, double y) const {
+    size_t n = pts.size(), segs = closed ? n : n - 1;
+    for (size_t i = 0; i < segs; i++) {
+      const P &a = pts[i], &b = pts[(i + 1) % n];
+      double dx = b.x - a.x, dy = b.y - a.y, len = hypot(dx, dy);
+      double s = ((x - a.x) * dx + (y - a.y) * dy) / len, t = ((x - a.x) * dy - (y - a.y) * dx) / len;
+      if ((s >= 0) && (s <= len) && (fabs(t) <= hw)) return true;
+    }
+    if (join == TFT_JOIN_ROUND) {
+      for (const P &v : pts)
+        if (hypot(x - v.x, y - v.y) <= hw) return true;
+    }
+    for (const Poly &c : corners)
+      if (inConvex(c, x, y)) return true;
+    return false;
+  }
+};
+
+// Coverage of pixel x, y in 1/256ths, pixel centres are on whole numbers, one no edge comes within is all in or out
+template <class R> static double sampled(const R &ref, int32_t x, int32_t y) {
+  uint32_t n = 0;
+  if (!ref.near(x, y)) return ref.inside(x, y) ? 256 : 0;
+  for (int j = 0; j < GRID; j++)
+    for (int i = 0; i < GRID; i++) n += ref.inside(x - 0.5 + (i + 0.5) / GRID, y - 0.5 + (j + 0.5) / GRID);
+  return n * 256.0 / (GRID * GRID);
+}
+
+static int32_t alphaOf(int32_t c) {
+  return (c <= TFT_AA_LOW) ? 0 : (c >= TFT_AA_HIGH) ? 255 : c;
+}
+
+// Check every pixel of the box against the reference, the path was drawn in white over BG given as its color
+template <class R> static uint32_t compare(TFT_eSPI &tft, const R &ref, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t tol,
+                                           const char *what, const std::vector<P> &skip = {}) {
+  uint32_t bad = 0;
+  for (int32_t y = y0; y <= y1; y++)
+    for (int32_t x = x0; x <= x1; x++) {
+      bool crossed = false;
+      for (const P &s : skip) crossed = crossed || ((fabs(s.x - x) <= 0.5) && (fabs(s.y - y) <= 0.5));
+      if (crossed) continue;
+
+      double c = sampled(ref, x, y);
+      int32_t lo = alphaOf((int32_t)floor(c - tol)), hi = alphaOf((int32_t)ceil(c + tol));
+      uint16_t got = stub_pixel(x, y);
+
+      bool ok = ((lo == 0) && (got == MARKER)) || ((hi == 255) && (got == TFT_WHITE));
+      for (int32_t a = std::max<int32_t>(lo, 1); !ok && (a <= std::min<int32_t>(hi, 254)); a++) ok = (got == tft.alphaBlend(a, TFT_WHITE, BG));
+      if (!ok && (bad < 5)) printf("%s: pixel %d, %d coverage %.1f got %04x\n", what, x, y, c, got);
+      bad += !ok;
+    }
+  return bad;
+}
+
+static void path(TFT_ePath &p, const Poly &pts, bool closed) {
+  p.clear();
+  p.moveTo(pts[0].x, pts[0].y);
+  for (size_t i = 1; i < pts.size(); i++) p.lineTo(pts[i].x, pts[i].y);
+  if (closed) p.close();
+}
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+  TFT_ePath p;
+
+  // Convex fill with corners off the pixel grid
+  {
+    Poly hept;
+    for (int i = 0; i < 7; i++) hept.push_back({ 60.3 + 40.7 * cos(i * 2 * M_PI / 7 + 0.2), 70.6 + 35.2 * sin(i * 2 * M_PI / 7 + 0.2) });
+    tft.fillScreen(MARKER);
+    path(p, hept, true);
+    p.fill(&tft, TFT_WHITE, TFT_FILL_NON_ZERO, BG);
+    CHECK_EQ(compare(tft, Fill{ { hept }, TFT_FILL_NON_ZERO }, 15, 30, 105, 110, TOL, "convex"), 0);
+  }
+
+  // A five pointed star crosses itself, its centre winds twice so only the non-zero rule fills it
+  {
+    Poly star;
+    for (int i = 0; i < 5; i++) star.push_back({ 120.4 + 60.0 * sin(i * 4 * M_PI / 5), 160.7 - 60.0 * cos(i * 4 * M_PI / 5) });
+    std::vector<P> cross = crossings(star);
+    CHECK_EQ(cross.size(), 5);
+
+    tft.fillScreen(MARKER);
+    path(p, star, false);
+    p.fill(&tft, TFT_WHITE, TFT_FILL_EVEN_ODD, BG);
+    CHECK_EQ(compare(tft, Fill{ { star }, TFT_FILL_EVEN_ODD }, 55, 95, 185, 225, TOL, "even-odd", cross), 0);
+    CHECK_EQ(stub_pixel(120, 165), MARKER);
+
+    tft.fillScreen(MARKER);
+    p.fill(&tft, TFT_WHITE, TFT_FILL_NON_ZERO, BG);
+    CHECK_EQ(compare(tft, Fill{ { star }, TFT_FILL_NON_ZERO }, 55, 95, 185, 225, TOL, "non-zero", cross), 0);
+    CHECK_EQ(stub_pixel(120, 165), TFT_WHITE);
+  }
+
+  // Polylines with a gentle turn, a right angle, and turns too sharp for a miter, both ways round
+  const Poly line = { { 20.3, 40.2 }, { 110.6, 52.9 }, { 30.2, 66.4 }, { 130.8, 120.1 }, { 126.5, 60.3 }, { 200.7, 60.3 }, { 200.7, 150.4 } };
+  const Poly tri  = { { 40.5, 200.2 }, { 200.3, 215.8 }, { 70.9, 290.6 } };
+  const uint8_t joins[3] = { TFT_JOIN_MITER, TFT_JOIN_ROUND, TFT_JOIN_BEVEL };
+  const char *names[3] = { "miter", "round", "bevel" };
+
+  for (int j = 0; j < 3; j++) {
+    for (int closed = 0; closed < 2; closed++) {
+      const Poly &pts = closed ? tri : line;
+      Stroke ref(pts, closed, 4.75, joins[j]);
+      tft.fillScreen(MARKER);
+      path(p, pts, closed);
+      p.stroke(&tft, 9.5f, TFT_WHITE, joins[j], BG);
+
+      char what[32];
+      snprintf(what, sizeof(what), "%s %s", names[j], closed ? "closed" : "open");
+      int32_t tol = (joins[j] == TFT_JOIN_ROUND) ? TOL_ROUND : TOL;
+      uint32_t bad = closed ? compare(tft, ref, 0, 170, 239, 319, tol, what)
+                            : compare(tft, ref, 0, 0, 239, 170, tol, what);
+      CHECK_EQ(bad, 0);
+    }
+  }
+
+  // The sharp turn at 110.6, 52.9 is past the miter limit and bevelled, so the miter and bevel strokes match there,
+  // at the right angle at 200.7, 60.3 the miter reaches the corner of the square that the bevel cuts off
+  {
+    static uint16_t miter[STUB_RAM_WIDTH * STUB_RAM_HEIGHT];
+    path(p, line, false);
+    tft.fillScreen(MARKER);
+    p.stroke(&tft, 9.5f, TFT_WHITE, TFT_JOIN_MITER, BG);
+    memcpy(miter, stub.ram, sizeof(miter));
+    tft.fillScreen(MARKER);
+    p.stroke(&tft, 9.5f, TFT_WHITE, TFT_JOIN_BEVEL, BG);
+
+    uint32_t differ = 0;
+    for (int32_t y = 40; y < 66; y++)
+      for (int32_t x = 100; x < 118; x++) differ += (miter[y * STUB_RAM_WIDTH + x] != stub_pixel(x, y));
+    CHECK_EQ(differ, 0);
+    CHECK_EQ(miter[57 * STUB_RAM_WIDTH + 204], TFT_WHITE);
+    CHECK_EQ(stub_pixel(204, 57), MARKER);
+  }
+
+  return testResult();
+}
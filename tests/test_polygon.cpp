@@ -0,0 +1,107 @@
+// fillPolygon() scan converts the whole outline at once, compared with filling a convex polygon as a fan of
+// triangles, each drawn a line at a time in the way of the classic fillTriangle()
+// Prints the host time, the bytes sent and the commands sent for each
+
+#include "test.h"
+#include <math.h>
+#include <utility>
+
+// Triangle filled with one horizontal line per row, shared edges of the fan are drawn twice
+static void fanTriangle(TFT_eSPI &tft, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                        uint32_t color) {
+  if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+  if (y1 > y2) { std::swap(y2, y1); std::swap(x2, x1); }
+  if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+
+  if (y0 == y2) {
+    int32_t a = std::min(x0, std::min(x1, x2)), b = std::max(x0, std::max(x1, x2));
+    tft.drawFastHLine(a, y0, b - a + 1, color);
+    return;
+  }
+
+  int32_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+  int32_t sa = 0, sb = 0, y = y0;
+  int32_t last = (y1 == y2) ? y1 : y1 - 1;
+
+  for (; y <= last; y++) {
+    int32_t a = x0 + sa / dy01, b = x0 + sb / dy02;
+    sa += dx01;
+    sb += dx02;
+    if (a > b) std::swap(a, b);
+    tft.drawFastHLine(a, y, b - a + 1, color);
+  }
+
+  sa = dx12 * (y - y1);
+  sb = dx02 * (y - y0);
+  for (; y <= y2; y++) {
+    int32_t a = x1 + sa / dy12, b = x0 + sb / dy02;
+    sa += dx12;
+    sb += dx02;
+    if (a > b) std::swap(a, b);
+    tft.drawFastHLine(a, y, b - a + 1, color);
+  }
+}
+
+static void fan(TFT_eSPI &tft, const tft_point *p, uint32_t n, uint32_t color) {
+  tft.startWrite();
+  for (uint32_t i = 1; i + 1 < n; i++) fanTriangle(tft, p[0].x, p[0].y, p[i].x, p[i].y, p[i + 1].x, p[i + 1].y, color);
+  tft.endWrite();
+}
+
+static uint32_t count(uint16_t color) {
+  uint32_t c = 0;
+  for (int32_t i = 0; i < STUB_RAM_WIDTH * STUB_RAM_HEIGHT; i++) c += (stub.ram[i] == color);
+  return c;
+}
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  // Polygons of horizontal edges only draw nothing, from the stack table and from one on the heap
+  tft_point flat[64];
+  for (int i = 0; i < 64; i++) flat[i] = { (int16_t)(i * 3), 10 };
+  stub_reset_counters();
+  tft.fillPolygon(flat, 3, TFT_RED);
+  tft.fillPolygon(flat, 64, TFT_RED);
+  CHECK_EQ(stub.bytes, 0);
+  CHECK_EQ(stub.pixelsWritten, 0);
+
+  // A 24 sided polygon, the fan covers the same pixels within its rounding at the edges
+  const uint32_t n = 24;
+  tft_point p[n];
+  for (uint32_t i = 0; i < n; i++) {
+    float a = i * 6.2831853f / n;
+    p[i] = { (int16_t)lroundf(120 + 100 * cosf(a)), (int16_t)lroundf(160 + 100 * sinf(a)) };
+  }
+
+  tft.fillScreen(TFT_BLACK);
+  tft.fillPolygon(p, n, TFT_WHITE);
+  uint32_t scan = count(TFT_WHITE);
+  tft.fillScreen(TFT_BLACK);
+  fan(tft, p, n, TFT_WHITE);
+  uint32_t fanned = count(TFT_WHITE);
+  CHECK(scan > 30000);
+  CHECK(fanned >= scan);
+  CHECK(fanned - scan < 2 * 200 * 2);
+
+  const int frames = 200;
+  stub_reset_counters();
+  double s0 = testSeconds([&] { for (int i = 0; i < frames; i++) tft.fillPolygon(p, n, i); });
+  uint64_t bytes0 = stub.bytes, cmds0 = stub.commands;
+
+  stub_reset_counters();
+  double s1 = testSeconds([&] { for (int i = 0; i < frames; i++) fan(tft, p, n, i); });
+  uint64_t bytes1 = stub.bytes, cmds1 = stub.commands;
+
+  printf("fillPolygon:  %.1f us, %llu bytes, %llu commands per polygon\n", s0 * 1e6 / frames,
+         (unsigned long long)(bytes0 / frames), (unsigned long long)(cmds0 / frames));
+  printf("triangle fan: %.1f us, %llu bytes, %llu commands per polygon\n", s1 * 1e6 / frames,
+         (unsigned long long)(bytes1 / frames), (unsigned long long)(cmds1 / frames));
+
+  CHECK(bytes0 < bytes1);
+  CHECK(cmds0 < cmds1);
+
+  return testResult();
+}
@@ -0,0 +1,44 @@
+// pushBlock() sends runs as 16-bit frames with 32-bit pixel counts, fills of every size go through it
+// Prints the bytes per microsecond the driver feeds the emulated bus, in host time and in time on the wire
+
+#include "test.h"
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  // A full screen is 76800 pixels, more than a 16-bit count holds, one frame each in a single format switch
+  stub_reset_counters();
+  tft.fillScreen(TFT_CYAN);
+  CHECK_EQ(stub.pixelsWritten, 240 * 320);
+  CHECK_EQ(stub.frames16, 240 * 320);
+  CHECK_EQ(stub.formats, 2);
+  CHECK_EQ(stub.frameBits, 8);
+  CHECK_EQ(stub_pixel(0, 0), TFT_CYAN);
+  CHECK_EQ(stub_pixel(239, 319), TFT_CYAN);
+
+  // Lines use the same path
+  stub_reset_counters();
+  tft.drawFastHLine(0, 10, 240, TFT_RED);
+  tft.drawFastVLine(5, 0, 320, TFT_GREEN);
+  CHECK_EQ(stub.frames16, 240 + 320);
+  CHECK_EQ(stub_pixel(239, 10), TFT_RED);
+  CHECK_EQ(stub_pixel(5, 319), TFT_GREEN);
+
+  // Short runs are staged as bytes rather than switching the frame size
+  stub_reset_counters();
+  tft.fillRect(100, 100, 3, 3, TFT_BLUE);
+  CHECK_EQ(stub.frames16, 0);
+  CHECK_EQ(stub.formats, 0);
+  CHECK_EQ(stub.pixelsWritten, 9);
+
+  const int frames = 50;
+  stub_reset_counters();
+  double s = testSeconds([&] { for (int i = 0; i < frames; i++) tft.fillScreen(i); });
+  printf("fillScreen: %.1f bytes/us of host time, %.2f bytes/us on the wire at %u Hz, %llu bytes\n",
+         stub.bytes / (s * 1e6), stub.bytes * 1000.0 / stub.busNs, stub.baud, (unsigned long long)stub.bytes);
+  CHECK_EQ(stub.pixelsWritten, (uint64_t)frames * 240 * 320);
+
+  return testResult();
+}
@@ -0,0 +1,259 @@
+// TFT_eRegion against a set of pixels: random unions, subtractions and intersections with rectangles and with
+// regions must hold the same pixels as the set, stay in their banded form, and leave the region unchanged
+// when the result would need more than TFT_REGION_RECTS rectangles
+// Then fills, lines and pushed windows through setClipRegion() must change only pixels inside the region
+
+#include "test.h"
+#include <vector>
+
+// Pixels the model covers, random rectangles lie within them
+#define MX0 -8
+#define MY0 -8
+#define MW  80
+#define MH  64
+
+static uint32_t seed = 5;
+static int32_t rnd(int32_t n) {
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 8) % n;
+}
+
+struct Rect { int32_t x, y, w, h; };
+
+static Rect randomRect(void) {
+  int32_t w = rnd(30) + 1, h = rnd(24) + 1;
+  return { MX0 + rnd(MW - w + 1), MY0 + rnd(MH - h + 1), w, h };
+}
+
+// Set of pixels over the model area
+struct Pixels {
+  std::vector<bool> in = std::vector<bool>(MW * MH, false);
+
+  bool get(int32_t x, int32_t y) const {
+    return (x >= MX0) && (x < MX0 + MW) && (y >= MY0) && (y < MY0 + MH) && in[(y - MY0) * MW + (x - MX0)];
+  }
+
+  void rect(const Rect &r, bool v) {
+    for (int32_t y = r.y; y < r.y + r.h; y++)
+      for (int32_t x = r.x; x < r.x + r.w; x++)
+        if ((x >= MX0) && (x < MX0 + MW) && (y >= MY0) && (y < MY0 + MH)) in[(y - MY0) * MW + (x - MX0)] = v;
+  }
+};
+
+// Pixels held by a region, all of its rectangles must lie within the model area
+static Pixels pixelsOf(const TFT_eRegion &r) {
+  Pixels p;
+  for (uint16_t i = 0; i < r.count(); i++) {
+    const tft_region_rect &b = r.rects()[i];
+    p.rect({ b.x0, b.y0, b.x1 - b.x0, b.y1 - b.y0 }, true);
+  }
+  return p;
+}
+
+// The banded form: rectangles non-empty, a band's share rows and are left to right with gaps between them,
+// bands are top to bottom and a band touching the one above it differs from it
+static bool banded(const TFT_eRegion &r) {
+  const tft_region_rect *p = r.rects();
+  uint16_t n = r.count(), start = 0, prev = 0, prevLen = 0;
+  if (n > TFT_REGION_RECTS) return false;
+
+  while (start < n) {
+    uint16_t end = start;
+    while ((end < n) && (p[end].y0 == p[start].y0)) end++;
+
+    for (uint16_t i = start; i < end; i++) {
+      if ((p[i].x0 >= p[i].x1) || (p[i].y0 >= p[i].y1) || (p[i].y1 != p[start].y1)) return false;
+      if ((i > start) && (p[i].x0 <= p[i - 1].x1)) return false;
+    }
+
+    if (start > 0) {
+      if (p[start].y0 < p[prev].y1) return false;
+      bool same = (p[start].y0 == p[prev].y1) && (end - start == prevLen);
+      for (uint16_t i = 0; same && (i < prevLen); i++) same = (p[start + i].x0 == p[prev + i].x0) && (p[start + i].x1 == p[prev + i].x1);
+      if (same) return false;
+    }
+    prev = start;
+    prevLen = end - start;
+    start = end;
+  }
+  return true;
+}
+
+static bool sameRects(const TFT_eRegion &a, const TFT_eRegion &b) {
+  return (a.count() == b.count()) && (memcmp(a.rects(), b.rects(), a.count() * sizeof(tft_region_rect)) == 0);
+}
+
+// Region and pixel set of a few random rectangles
+static void randomRegion(TFT_eRegion &r, Pixels &p) {
+  r.clear();
+  p = Pixels();
+  for (int i = rnd(4) + 1; i; i--) {
+    Rect b = randomRect();
+    if (r.unite(b.x, b.y, b.w, b.h)) p.rect(b, true);
+  }
+}
+
+int main() {
+  // Random operations, in rectangle and region forms
+  {
+    uint32_t bad = 0, failed = 0, ops = 0;
+    for (uint32_t t = 0; t < 200; t++) {
+      TFT_eRegion r;
+      Pixels model;
+      for (uint32_t k = 0; k < 60; k++, ops++) {
+        uint8_t op = rnd(3);
+        bool asRegion = rnd(2);
+
+        Pixels other;
+        TFT_eRegion o;
+        Rect b = randomRect();
+        if (asRegion) randomRegion(o, other);
+        else { o.set(b.x, b.y, b.w, b.h); other.rect(b, true); }
+
+        TFT_eRegion before = r;
+        bool ok;
+        switch (op) {
+          case 0:  ok = asRegion ? r.unite(o) : r.unite(b.x, b.y, b.w, b.h); break;
+          case 1:  ok = asRegion ? r.subtract(o) : r.subtract(b.x, b.y, b.w, b.h); break;
+          default: ok = asRegion ? r.intersect(o) : r.intersect(b.x, b.y, b.w, b.h); break;
+        }
+
+        if (!ok) {
+          failed++;
+          bad += !sameRects(r, before);
+          continue;
+        }
+
+        for (uint32_t i = 0; i < MW * MH; i++) {
+          bool a = model.in[i], c = other.in[i];
+          model.in[i] = (op == 0) ? (a || c) : (op == 1) ? (a && !c) : (a && c);
+        }
+        bad += !banded(r);
+        bad += (pixelsOf(r).in != model.in);
+      }
+
+      // Queries against the final set
+      for (int32_t y = MY0 - 2; y < MY0 + MH + 2; y++) {
+        for (int32_t x = MX0 - 2; x < MX0 + MW + 2; x++) bad += (r.contains(x, y) != model.get(x, y));
+
+        const tft_region_rect *p;
+        uint16_t n = r.row(y, &p), f = r.find(y);
+        uint32_t inRow = 0;
+        for (int32_t x = MX0; x < MX0 + MW; x++) inRow += model.get(x, y);
+        uint32_t spans = 0;
+        for (uint16_t i = 0; i < n; i++) { spans += p[i].x1 - p[i].x0; bad += (y < p[i].y0) || (y >= p[i].y1); }
+        bad += (spans != inRow);
+        bad += (f < r.count()) ? (r.rects()[f].y1 <= y) || ((f > 0) && (r.rects()[f - 1].y1 > y)) : (r.count() && (r.rects()[r.count() - 1].y1 > y));
+      }
+      for (int k = 0; k < 50; k++) {
+        Rect b = randomRect();
+        bool any = false;
+        for (int32_t y = b.y; y < b.y + b.h; y++)
+          for (int32_t x = b.x; x < b.x + b.w; x++) any = any || model.get(x, y);
+        bad += (r.intersects(b.x, b.y, b.w, b.h) != any);
+      }
+    }
+    CHECK_EQ(bad, 0);
+    CHECK(failed > 0);
+    printf("%u operations, %u would have needed more than %u rectangles\n", ops, failed, TFT_REGION_RECTS);
+  }
+
+  // Overflow leaves the region as it was, for each operation and form
+  {
+    TFT_eRegion full;
+    for (int i = 0; i < TFT_REGION_RECTS; i++) CHECK(full.unite(i * 3, 0, 2, 2));
+    CHECK_EQ(full.count(), TFT_REGION_RECTS);
+    TFT_eRegion copy = full;
+
+    CHECK(!full.unite(0, 5, 2, 2));
+    CHECK(sameRects(full, copy));
+
+    TFT_eRegion bar(0, 1, 200, 4);
+    CHECK(!full.unite(bar));
+    CHECK(sameRects(full, copy));
+
+    TFT_eRegion block(0, 0, 200, 10), holes(0, 0, 200, 10);
+    for (int i = 0; i < TFT_REGION_RECTS - 3; i++) CHECK(holes.subtract(i * 6 + 1, 3, 2, 2));
+    TFT_eRegion hcopy = holes;
+    CHECK_EQ(holes.count(), TFT_REGION_RECTS);
+    CHECK(!holes.subtract(190, 3, 2, 2));
+    CHECK(sameRects(holes, hcopy));
+
+    TFT_eRegion comb;
+    for (int i = 0; i < 16; i++) CHECK(comb.unite(i * 6, 0, 3, 10));
+    TFT_eRegion ccopy = comb;
+    TFT_eRegion cut;
+    cut.set(0, 2, 200, 2);
+    CHECK(cut.unite(0, 6, 200, 2));
+    CHECK(!comb.subtract(cut));
+    CHECK(sameRects(comb, ccopy));
+    CHECK(comb.intersect(block));
+    CHECK(sameRects(comb, ccopy));
+  }
+
+  // Drawing through a clip region on the stub changes only pixels inside it
+  {
+    stub_reset();
+    TFT_eSPI tft;
+    tft.begin();
+    static uint16_t expect[STUB_RAM_WIDTH * STUB_RAM_HEIGHT], data[64 * 64];
+    const int32_t w = tft.width(), h = tft.height();
+    uint32_t bad = 0;
+
+    for (uint32_t t = 0; t < 200; t++) {
+      TFT_eRegion clip;
+      for (int i = rnd(6) + 1; i; i--) clip.unite(rnd(w + 40) - 20, rnd(h + 40) - 20, rnd(120) + 1, rnd(120) + 1);
+      if (rnd(2)) clip.subtract(rnd(w), rnd(h), rnd(80) + 1, rnd(80) + 1);
+
+      tft.fillScreen(TFT_BLACK);
+      memcpy(expect, stub.ram, sizeof(expect));
+      auto plot = [&](int32_t x, int32_t y, uint16_t c) {
+        if ((x >= 0) && (x < w) && (y >= 0) && (y < h) && clip.contains(x, y)) expect[y * STUB_RAM_WIDTH + x] = c;
+      };
+
+      tft.setClipRegion(&clip);
+      int32_t x = rnd(w + 60) - 30, y = rnd(h + 60) - 30, rw = rnd(64) + 1, rh = rnd(64) + 1;
+      uint16_t color = rnd(0xFFFF) + 1;
+      switch (t % 5) {
+        case 0:
+          tft.fillRect(x, y, rw, rh, color);
+          for (int32_t j = 0; j < rh; j++) for (int32_t i = 0; i < rw; i++) plot(x + i, y + j, color);
+          break;
+        case 1:
+          tft.drawFastHLine(x, y, rw, color);
+          tft.drawFastVLine(x, y, rh, color);
+          for (int32_t i = 0; i < rw; i++) plot(x + i, y, color);
+          for (int32_t j = 0; j < rh; j++) plot(x, y + j, color);
+          break;
+        case 2:
+          tft.setWindow(x, y, x + rw - 1, y + rh - 1);
+          tft.pushBlock(color, rw * rh);
+          for (int32_t j = 0; j < rh; j++) for (int32_t i = 0; i < rw; i++) plot(x + i, y + j, color);
+          break;
+        case 3:
+          for (int32_t i = 0; i < rw * rh; i++) data[i] = rnd(0x10000);
+          tft.setWindow(x, y, x + rw - 1, y + rh - 1);
+          tft.pushColors(data, rw * rh);
+          for (int32_t j = 0; j < rh; j++) for (int32_t i = 0; i < rw; i++) plot(x + i, y + j, data[j * rw + i]);
+          break;
+        default: {
+          // Bytes high first, pushed in two parts so the second starts part way along a row
+          for (int32_t i = 0; i < rw * rh; i++) data[i] = rnd(0x10000);
+          static uint8_t bytes[64 * 64 * 2];
+          for (int32_t i = 0; i < rw * rh; i++) { bytes[2 * i] = data[i] >> 8; bytes[2 * i + 1] = data[i]; }
+          uint32_t half = rw * rh / 2;
+          tft.setWindow(x, y, x + rw - 1, y + rh - 1);
+          tft.pushColors(bytes, 2 * half);
+          tft.pushColors(bytes + 2 * half, 2 * (rw * rh - half));
+          for (int32_t j = 0; j < rh; j++) for (int32_t i = 0; i < rw; i++) plot(x + i, y + j, data[j * rw + i]);
+          break;
+        }
+      }
+      tft.setClipRegion(nullptr);
+      bad += (memcmp(expect, stub.ram, sizeof(expect)) != 0);
+    }
+    CHECK_EQ(bad, 0);
+  }
+
+  return testResult();
+}
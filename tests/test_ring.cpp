@@ -0,0 +1,124 @@
+// TFT_eSPI_Ring stress test, a producer thread pushes millions of commands through a small ring to a consumer
+// thread that runs them with tft_cmd_run() on a recording display, as core 0 and core 1 do in TFT_eSPI_Pipeline
+// Every call must arrive once and in order with the values it was encoded with, fences in sequence after all
+// the calls before them, and image pixels as written before the push, rewritten only once a later fence is done
+// The count of commands can be given as the first argument. Build with -DTFT_TSAN=ON to run under ThreadSanitizer
+
+#define TFT_RING_SIZE 8
+
+#include "test.h"
+#include "Extensions/Ring.h"
+#include <thread>
+#include <stdlib.h>
+
+// Every 64 commands an image push and then a fence, the two image buffers are used in turn
+#define IMAGE_AT 31
+#define FENCE_AT 63
+#define IMAGE_W  8
+#define IMAGE_H  4
+
+static uint16_t images[2][IMAGE_W * IMAGE_H];
+static std::atomic<uint32_t> fenceDone(0);
+
+// Command n of the stream, every field comes from n so the consumer can check what it is given
+static tft_cmd command(uint32_t n) {
+  uint32_t h = n * 2654435761u;
+  int32_t x = (int16_t)(h >> 3), y = (int16_t)(h >> 13), w = (int16_t)(h >> 7), v = (int16_t)(h >> 17);
+  uint32_t color = h ^ n;
+
+  if (n % 64 == FENCE_AT) return tft_cmd_fence(n / 64 + 1);
+  if (n % 64 == IMAGE_AT) return tft_cmd_push_image(x, y, IMAGE_W, IMAGE_H, images[(n / 64) & 1]);
+  switch ((h >> 28) % 5) {
+    case 0:  return tft_cmd_pixel(x, y, color);
+    case 1:  return tft_cmd_fill_rect(x, y, w, v, color);
+    case 2:  return tft_cmd_hline(x, y, w, color);
+    case 3:  return tft_cmd_vline(x, y, v, color);
+    default: return tft_cmd_rotation(h & 3);
+  }
+}
+
+static uint16_t imagePixel(uint32_t n, uint32_t i) { return (n * 7 + i) & 0xFFFF; }
+
+// Display for tft_cmd_run(), each call is checked against the next command of the stream
+class Recorder
+{
+ public:
+  uint32_t n = 0, bad = 0;
+
+  void drawPixel(int32_t x, int32_t y, uint32_t color)                    { check(TFT_CMD_PIXEL, x, y, 1, 1, color); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) { check(TFT_CMD_FILL_RECT, x, y, w, h, color); }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)     { check(TFT_CMD_HLINE, x, y, w, 1, color); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)     { check(TFT_CMD_VLINE, x, y, 1, h, color); }
+  void setRotation(uint8_t r)                                             { check(TFT_CMD_ROTATION, 0, 0, 0, 0, r); }
+
+  void setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1) { _x0 = x0; _y0 = y0; _x1 = x1; _y1 = y1; }
+
+  void pushColors(uint16_t *data, uint32_t len) {
+    bad += (len != IMAGE_W * IMAGE_H);
+    for (uint32_t i = 0; i < len; i++) bad += (data[i] != imagePixel(n, i));
+    check(TFT_CMD_PUSH_IMAGE, _x0, _y0, _x1 - _x0 + 1, _y1 - _y0 + 1, 0);
+  }
+
+  // A fence is returned by tft_cmd_run() rather than called
+  void fence(uint32_t seq) { check(TFT_CMD_FENCE, 0, 0, 0, 0, seq); }
+
+ private:
+  void check(uint8_t op, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t value) {
+    tft_cmd c = command(n++);
+    if ((c.op != op) || (c.x != x) || (c.y != y) || (c.w != w) || (c.h != h) || (c.value != value)) {
+      if (bad < 10) printf("command %u: op %u (%d, %d, %d, %d) %u, expected op %u (%d, %d, %d, %d) %u\n",
+                           n - 1, op, x, y, w, h, value, c.op, c.x, c.y, c.w, c.h, c.value);
+      bad++;
+    }
+  }
+
+  int32_t _x0 = 0, _y0 = 0, _x1 = 0, _y1 = 0;
+};
+
+int main(int argc, char **argv) {
+  const uint32_t total = (argc > 1) ? strtoul(argv[1], nullptr, 0) : 4000000;
+
+  TFT_eSPI_Ring ring;
+  Recorder rec;
+  uint32_t full = 0, empty = 0, maxQueued = 0;
+
+  double s = testSeconds([&] {
+    std::thread consumer([&] {
+      tft_cmd c;
+      while (rec.n < total) {
+        if (!ring.pop(c)) { empty++; std::this_thread::yield(); continue; }
+        uint32_t seq = tft_cmd_run(rec, c);
+        if (seq) {
+          rec.fence(seq);
+          fenceDone.store(seq, std::memory_order_release);
+        }
+      }
+    });
+
+    for (uint32_t n = 0; n < total; n++) {
+      // An image buffer is rewritten once the fence after its last push is done
+      if (n % 64 == IMAGE_AT) {
+        uint32_t last = n / 64 - 1;  // Fence after the buffer's last push
+        if (n >= 128) while ((int32_t)(fenceDone.load(std::memory_order_acquire) - last) < 0) std::this_thread::yield();
+        for (uint32_t i = 0; i < IMAGE_W * IMAGE_H; i++) images[(n / 64) & 1][i] = imagePixel(n, i);
+      }
+
+      tft_cmd c = command(n);
+      while (!ring.push(c)) { full++; std::this_thread::yield(); }
+      uint32_t q = ring.size();
+      if (q > maxQueued) maxQueued = q;
+    }
+    consumer.join();
+  });
+
+  CHECK_EQ(rec.bad, 0);
+  CHECK_EQ(rec.n, total);
+  CHECK_EQ(ring.size(), 0);
+  CHECK(maxQueued <= TFT_RING_SIZE);
+  CHECK_EQ(fenceDone.load(), total / 64);
+
+  printf("%u commands through a ring of %u: %.1f Mcommands/s, ring full %u times, empty %u times\n",
+         total, TFT_RING_SIZE, total / s / 1e6, full, empty);
+
+  return testResult();
+}
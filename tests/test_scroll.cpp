@@ -0,0 +1,88 @@
+// The scrolling areas sent by setScrollArea() cover every row of controller RAM, including rows the panel
+// does not show, so a 240 row panel on a 320 row controller scrolls the rows it shows. The RAM height comes from
+// tft_bus_config::ram_height, and an area that cannot be set is refused without sending anything
+
+#include "test.h"
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  // The panel shows all the RAM rows
+  CHECK(tft.setScrollArea(16, 32));
+  CHECK_EQ(stub.tfa, 16);
+  CHECK_EQ(stub.vsa, 272);
+  CHECK_EQ(stub.bfa, 32);
+  CHECK_EQ(stub.vsp, 16);
+  tft.scroll(10);
+  CHECK_EQ(stub.vsp, 26);
+
+  // A 240x240 panel at the top of the RAM, the 80 rows below it join the bottom fixed area
+  tft_bus_config cfg = TFT_BUS_CONFIG_DEFAULT;
+  cfg.height = 240;
+  TFT_eSPI top(cfg);
+  top.begin();
+  CHECK(top.setScrollArea(0, 0));
+  CHECK_EQ(stub.tfa, 0);
+  CHECK_EQ(stub.vsa, 240);
+  CHECK_EQ(stub.bfa, 80);
+  CHECK_EQ(stub.tfa + stub.vsa + stub.bfa, TFT_RAM_HEIGHT);
+  top.scroll(239);
+  CHECK_EQ(stub.vsp, 239);
+
+  // The same panel at the bottom of the RAM, the 80 rows above it join the top fixed area
+  cfg.row_offset = 80;
+  TFT_eSPI bottom(cfg);
+  bottom.begin();
+  CHECK(bottom.setScrollArea(8, 8));
+  CHECK_EQ(stub.tfa, 88);
+  CHECK_EQ(stub.vsa, 224);
+  CHECK_EQ(stub.bfa, 8);
+  CHECK_EQ(stub.tfa + stub.vsa + stub.bfa, TFT_RAM_HEIGHT);
+  bottom.scroll(-1);
+  CHECK_EQ(stub.vsp, 88 + 223);
+
+  // No rows left to scroll, the area and the offset stay as they were
+  stub_reset_counters();
+  CHECK(!bottom.setScrollArea(120, 120));
+  CHECK(!bottom.setScrollArea(0, 240));
+  CHECK_EQ(stub.commands, 0);
+  bottom.scroll(1);
+  CHECK_EQ(stub.vsp, 88);
+
+  // A 240 row controller, as on round panels, has no rows below the panel
+  cfg.row_offset = 0;
+  cfg.ram_height = 240;
+  TFT_eSPI round(cfg);
+  round.begin();
+  CHECK(round.setScrollArea(20, 10));
+  CHECK_EQ(stub.tfa, 20);
+  CHECK_EQ(stub.vsa, 210);
+  CHECK_EQ(stub.bfa, 10);
+
+  // A panel that runs past the end of the controller RAM cannot scroll
+  cfg.row_offset = 1;
+  TFT_eSPI past(cfg);
+  past.begin();
+  stub_reset_counters();
+  CHECK(!past.setScrollArea(0, 0));
+  CHECK_EQ(stub.commands, 0);
+  CHECK_EQ(stub.tfa, 20);
+
+  // A taller controller leaves more rows below the panel, no ram_height falls back to TFT_RAM_HEIGHT
+  cfg.ram_height = 400;
+  TFT_eSPI tall(cfg);
+  tall.begin();
+  CHECK(tall.setScrollArea(0, 0));
+  CHECK_EQ(stub.tfa, 1);
+  CHECK_EQ(stub.vsa, 240);
+  CHECK_EQ(stub.bfa, 159);
+  cfg.ram_height = 0;
+  TFT_eSPI fallback(cfg);
+  fallback.begin();
+  CHECK(fallback.setScrollArea(0, 0));
+  CHECK_EQ(stub.tfa + stub.vsa + stub.bfa, TFT_RAM_HEIGHT);
+
+  return testResult();
+}
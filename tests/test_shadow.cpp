@@ -0,0 +1,134 @@
+// The shadow framebuffer sends changed tiles on flush(), and refuses screens its dirty bitmap cannot cover
+// Dirty tiles side by side, or in rows of the same columns, must go in one window, flushBytes() must be the bytes
+// the next flush() puts on the bus, and a flush limited by a budget must stop within it and leave the next flush
+// to carry on from the tile row it stopped at, before any rows above it
+
+#include "test.h"
+
+static uint32_t seed = 9;
+static uint32_t rnd(uint32_t n) {
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 8) % n;
+}
+
+// Flush, checking the bytes sent against flushBytes() and that the panel holds the shadow buffer
+static void flushed(TFT_eSPI &tft, const uint16_t *buffer, uint32_t windows, int line) {
+  uint32_t expect = tft.flushBytes();
+  stub_reset_counters();
+  CHECK(tft.flush());
+  if ((stub.bytes != expect) || (stub.ramWrites != windows)) {
+    printf("line %d: %llu bytes in %u windows, expected %u bytes in %u\n", line, (unsigned long long)stub.bytes, stub.ramWrites, expect, windows);
+    CHECK(false);
+  }
+  CHECK_EQ(tft.flushBytes(), 0);
+
+  uint32_t differ = 0;
+  for (int32_t y = 0; y < tft.height(); y++)
+    for (int32_t x = 0; x < tft.width(); x++) differ += (stub_pixel(x, y) != buffer[y * tft.width() + x]);
+  CHECK_EQ(differ, 0);
+}
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  CHECK(tft.shadowBegin());
+  stub_reset_counters();
+  tft.fillRect(100, 200, 20, 20, TFT_RED);
+  CHECK_EQ(stub.pixelsWritten, 0);
+  tft.flush();
+  CHECK_EQ(stub_pixel(100, 200), TFT_RED);
+  CHECK_EQ(stub_pixel(119, 219), TFT_RED);
+  CHECK_EQ(stub_pixel(239, 319), TFT_BLACK);
+  tft.shadowEnd();
+
+  // Tiles are merged along rows, and rows with dirty tiles in the same columns into one rectangle
+  {
+    static uint16_t buffer[240 * 320];
+    CHECK(tft.shadowBegin(buffer));
+    tft.fillScreen(TFT_BLACK);
+    flushed(tft, buffer, 1, __LINE__);
+
+    tft.fillRect(16, 32, 64, 16, TFT_RED);
+    flushed(tft, buffer, 1, __LINE__);
+    CHECK_EQ(stub.pixelsWritten, 64 * 16);
+
+    // A pixel in each of a 3 x 3 block of tiles
+    for (int32_t j = 0; j < 3; j++)
+      for (int32_t i = 0; i < 3; i++) tft.drawPixel(100 + 16 * i, 150 + 16 * j, TFT_GREEN);
+    flushed(tft, buffer, 1, __LINE__);
+    CHECK_EQ(stub.pixelsWritten, 48 * 48);
+
+    // A clean column of tiles between two blocks, and a row below one of them that is wider
+    tft.fillRect(0, 0, 32, 32, TFT_BLUE);
+    tft.fillRect(48, 0, 32, 32, TFT_BLUE);
+    tft.fillRect(0, 32, 80, 8, TFT_CYAN);
+    flushed(tft, buffer, 3, __LINE__);
+
+    // Random drawing, bytes on the bus match flushBytes() with the window ranges the panel already has left out
+    for (uint32_t t = 0; t < 200; t++) {
+      for (uint32_t k = rnd(8); k; k--) {
+        if (rnd(3)) tft.fillRect(rnd(260) - 10, rnd(340) - 10, rnd(70) + 1, rnd(70) + 1, rnd(0x10000));
+        else tft.drawPixel(rnd(240), rnd(320), rnd(0x10000));
+      }
+      uint32_t expect = tft.flushBytes();
+      stub_reset_counters();
+      CHECK(tft.flush());
+      CHECK_EQ(stub.bytes, expect);
+    }
+    flushed(tft, buffer, 0, __LINE__);
+
+    // Three tile rows fit the budget. A flush stops at the fourth, the next starts there and sends the tile
+    // dirtied at the top only when it wraps round to it, in the last flush as it fits after the bottom two rows
+    const uint32_t rowBytes = 240 * 16 * 2, budget = 3 * rowBytes + 11;
+    tft.setFlushBudget(budget);
+    tft.fillScreen(TFT_MAGENTA);
+    CHECK_EQ(tft.flushBytes(), budget);
+
+    stub_reset_counters();
+    CHECK(!tft.flush());
+    CHECK_EQ(stub.bytes, budget);
+    CHECK_EQ(stub_pixel(120, 47), TFT_MAGENTA);
+    CHECK(stub_pixel(120, 48) != TFT_MAGENTA);
+
+    tft.drawPixel(5, 5, TFT_YELLOW);
+    uint32_t flushes = 1;
+    for (int32_t top = 48; top < 320; top += 48, flushes++) {
+      uint32_t expect = tft.flushBytes();
+      stub_reset_counters();
+      bool done = tft.flush();
+      CHECK(stub.bytes <= budget);
+      CHECK_EQ(stub.bytes, expect);
+      CHECK_EQ(stub_pixel(120, top), TFT_MAGENTA);
+      CHECK_EQ(stub_pixel(120, std::min(top + 47, 319)), TFT_MAGENTA);
+      if (top + 48 < 320) CHECK(stub_pixel(120, top + 48) != TFT_MAGENTA);
+      CHECK_EQ(stub_pixel(5, 5) == TFT_YELLOW, top + 48 >= 320);
+      CHECK_EQ(done, top + 48 >= 320);
+    }
+    CHECK_EQ(flushes, 7);
+    tft.setFlushBudget(0);
+    flushed(tft, buffer, 0, __LINE__);
+    tft.shadowEnd();
+  }
+
+  // 32 tiles of 16 pixels a side fit, one pixel more in either direction does not, in any rotation
+  tft_bus_config cfg = TFT_BUS_CONFIG_DEFAULT;
+  cfg.width  = 512;
+  cfg.height = 512;
+  TFT_eSPI square(cfg);
+  CHECK(square.shadowBegin());
+  square.shadowEnd();
+
+  cfg.width  = 513;
+  cfg.height = 100;
+  TFT_eSPI wide(cfg);
+  CHECK(!wide.shadowBegin());
+
+  cfg.width  = 100;
+  cfg.height = 513;
+  TFT_eSPI tall(cfg);
+  CHECK(!tall.shadowBegin());
+
+  return testResult();
+}
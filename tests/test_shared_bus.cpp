@@ -0,0 +1,82 @@
+// Two displays on one SPI port with their own chip selects and clocks
+// A display taking the port from one inside startWrite() must not leave both chip selects low, the first
+// display's buffered bytes go out at its own clock before it lets go, and the port is not reset under DMA
+
+#include "test.h"
+
+#define OTHER_CS 9
+
+int main() {
+  stub_reset();
+  stub.csPins |= 1u << OTHER_CS;
+  stub.pins   |= 1u << OTHER_CS;
+
+  TFT_eSPI a;
+  a.begin();
+  uint32_t clockA = stub.baud;
+
+  tft_bus_config cfg = TFT_BUS_CONFIG_DEFAULT;
+  cfg.cs  = OTHER_CS;
+  cfg.dc  = 10;
+  cfg.rst = -1;
+  cfg.write_hz = 10000000;
+  TFT_eSPI b(cfg);
+  b.begin();
+  uint32_t clockB = stub.baud;
+  CHECK(clockA != clockB);
+
+  // b takes the port while a has a transaction open with bytes still buffered
+  stub_reset_counters();
+  a.startWrite();
+  a.fillRect(0, 0, 3, 3, TFT_RED);
+  CHECK(!(stub.pins & (1u << STUB_PANEL_CS)));
+
+  b.fillRect(0, 0, 3, 3, TFT_BLUE);
+  CHECK_EQ(stub_pixel(2, 2), TFT_RED);  // a's bytes reached its panel before b selected its own
+  CHECK(stub.pins & (1u << STUB_PANEL_CS));
+  CHECK_EQ(stub.baud, clockB);
+
+  // a carries on inside the same transaction, it takes the port back and selects its panel again
+  a.fillRect(3, 0, 3, 3, TFT_GREEN);
+  CHECK_EQ(stub.baud, clockA);
+  CHECK(!(stub.pins & (1u << STUB_PANEL_CS)));
+  a.endWrite();
+
+  CHECK(stub.pins & (1u << STUB_PANEL_CS));
+  CHECK(stub.pins & (1u << OTHER_CS));
+  CHECK_EQ(stub_pixel(5, 2), TFT_GREEN);
+  CHECK_EQ(stub.csAsserts, 2);
+  CHECK_EQ(stub.csConflicts, 0);
+  CHECK_EQ(stub.deselected, 0);
+
+  // b takes the port while a's DMA is still running, the transfer completes first
+  CHECK(a.initDMA());
+  stub.dmaBusyPolls = 50;
+  stub_reset_counters();
+  a.fillRectAsync(0, 0, 240, 100, TFT_YELLOW);
+  CHECK(a.dmaBusy());
+  b.fillRect(0, 0, 3, 3, TFT_BLUE);
+  CHECK(!a.dmaBusy());
+  CHECK(stub.pins & (1u << STUB_PANEL_CS));
+  CHECK_EQ(stub.frameBits, 8);
+  CHECK_EQ(stub.csConflicts, 0);
+
+  // Starting b again resets the port, a's DMA and open transaction must be finished with first
+  stub_reset_counters();
+  a.startWrite();
+  a.fillRectAsync(0, 0, 240, 100, TFT_CYAN);
+  b.begin();
+  CHECK_EQ(stub.initsBusy, 0);
+  CHECK_EQ(stub.initsSelected, 0);
+  CHECK_EQ(stub.csConflicts, 0);
+  CHECK(stub.pins & (1u << STUB_PANEL_CS));
+
+  a.fillRect(0, 200, 3, 3, TFT_MAGENTA);
+  a.endWrite();
+  CHECK_EQ(stub_pixel(0, 99), TFT_CYAN);
+  CHECK_EQ(stub_pixel(2, 202), TFT_MAGENTA);
+  CHECK_EQ(stub.csConflicts, 0);
+  CHECK(stub.pins & (1u << STUB_PANEL_CS));
+
+  return testResult();
+}
@@ -0,0 +1,169 @@
+// TFT_eDisplayList::endTiled() on a TFT_eSPI over the stub panel: each frame must leave the panel RAM as drawing
+// the same calls immediately does, with every call routed into RAM tiles, anti-aliased edges blended from the
+// tile by readRect(), and the tiles at the right and bottom of a screen that is not a whole number of tiles
+// cut at its edge. Nothing may be read back from the panel and each tile is sent as one window
+
+#include "test.h"
+#include <vector>
+
+// Screen size, not a whole number of tiles either way
+#define W 232
+#define H 300
+#define BG 0x18E3
+
+enum { RECT, HLINE, VLINE, CIRCLE, FILL_CIRCLE, WEDGE, PIXEL, IMAGE, KINDS };
+
+struct Item {
+  uint8_t  kind;
+  int16_t  x, y, w, h;
+  uint16_t color;
+  uint8_t  image;
+};
+
+static uint16_t images[2][12 * 8];
+
+static uint32_t seed = 777;
+static int32_t rnd(int32_t n) {
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 8) % n;
+}
+
+static Item randomItem(void) {
+  Item it;
+  it.kind  = rnd(KINDS);
+  it.x     = rnd(W + 40) - 20;
+  it.y     = rnd(H + 40) - 20;
+  it.w     = rnd(60) + 1;
+  it.h     = rnd(50) + 1;
+  it.color = rnd(0x10000);
+  it.image = rnd(2);
+  return it;
+}
+
+// Record on a display list or draw on the display
+template <class T> static void drawScene(T &t, const std::vector<Item> &items) {
+  for (const Item &it : items) {
+    switch (it.kind) {
+      case RECT:        t.fillRect(it.x, it.y, it.w, it.h, it.color); break;
+      case HLINE:       t.drawFastHLine(it.x, it.y, it.w, it.color); break;
+      case VLINE:       t.drawFastVLine(it.x, it.y, it.h, it.color); break;
+      case CIRCLE:      t.drawCircle(it.x, it.y, it.h / 2, it.color); break;
+      case FILL_CIRCLE: t.fillCircle(it.x, it.y, it.h / 2, it.color); break;
+      case PIXEL:       t.drawPixel(it.x, it.y, it.color); break;
+      case WEDGE:
+        t.drawWedgeLine(it.x + 0.3f, it.y + 0.6f, it.x + it.w - 30.0f, it.y + it.h - 25.0f,
+                        (it.w % 7) * 0.75f, (it.h % 5) * 1.25f, it.color);
+        break;
+    }
+  }
+}
+
+static void drawImages(TFT_eDisplayList &l, const std::vector<Item> &items) {
+  for (const Item &it : items)
+    if (it.kind == IMAGE) l.pushImage(it.x, it.y, 12, 8, images[it.image]);
+}
+
+// A window pushed immediately is not clipped, the reference draws images a pixel at a time in the byte order
+// pushColors() takes them in
+static void drawImages(TFT_eSPI &t, const std::vector<Item> &items) {
+  for (const Item &it : items) {
+    if (it.kind != IMAGE) continue;
+    for (int32_t i = 0; i < 12 * 8; i++) {
+      uint16_t c = images[it.image][i];
+      t.drawPixel(it.x + i % 12, it.y + i / 12, t.getSwapBytes() ? (uint16_t)(c >> 8 | c << 8) : c);
+    }
+  }
+}
+
+static std::vector<uint16_t> snapshot(void) {
+  return std::vector<uint16_t>(stub.ram, stub.ram + STUB_RAM_WIDTH * STUB_RAM_HEIGHT);
+}
+
+// Tiles of the screen the damage reaches
+static uint32_t damagedTiles(const TFT_eRegion &d) {
+  uint32_t n = 0;
+  for (int32_t y = 0; y < H; y += TFT_DLIST_TILE)
+    for (int32_t x = 0; x < W; x += TFT_DLIST_TILE) n += d.intersects(x, y, TFT_DLIST_TILE, TFT_DLIST_TILE);
+  return n;
+}
+
+// Draw a frame tiled over what the last one left, and check it against drawing it immediately
+static void frame(TFT_eSPI &tft, TFT_eDisplayList &list, const std::vector<Item> &items, int line) {
+  std::vector<uint16_t> last = snapshot();
+
+  tft.fillScreen(BG);
+  drawScene(tft, items);
+  drawImages(tft, items);
+  std::vector<uint16_t> ref = snapshot();
+
+  memcpy(stub.ram, last.data(), last.size() * 2);
+  list.begin();
+  drawScene(list, items);
+  drawImages(list, items);
+  stub_reset_counters();
+  list.endTiled(tft);
+
+  uint32_t bad = 0;
+  for (int32_t y = 0; y < H; y++)
+    for (int32_t x = 0; x < W; x++) {
+      uint32_t i = y * STUB_RAM_WIDTH + x;
+      if ((ref[i] != stub.ram[i]) && !bad++) printf("line %d: pixel %d, %d differs\n", line, x, y);
+    }
+  CHECK_EQ(bad, 0);
+
+  // Only a window for each tile reaches the panel
+  uint32_t tiles = damagedTiles(list.damage());
+  CHECK_EQ(stub.ramReads, 0);
+  CHECK_EQ(stub.ramWrites, tiles);
+  CHECK(stub.commands <= 3 * tiles);
+}
+
+int main() {
+  stub_reset();
+  tft_bus_config cfg = TFT_BUS_CONFIG_DEFAULT;
+  cfg.width  = W;
+  cfg.height = H;
+  TFT_eSPI tft(cfg);
+  tft.begin();
+
+  for (int i = 0; i < 12 * 8; i++) { images[0][i] = i * 0x0421; images[1][i] = 0xF800 | i; }
+
+  // The first frame redraws every tile, those on the right and bottom edges are cut to the screen
+  TFT_eDisplayList list;
+  list.setBackground(BG);
+  std::vector<Item> items = {
+    { RECT, 200, 280, 60, 40, TFT_RED, 0 },
+    { WEDGE, 220, 290, 40, 30, TFT_YELLOW, 0 },
+    { FILL_CIRCLE, 230, 150, 0, 30, TFT_GREEN, 0 },
+    { IMAGE, 226, 296, 0, 0, 0, 1 },
+    { WEDGE, 5, 5, 50, 50, TFT_CYAN, 0 },
+  };
+  frame(tft, list, items, __LINE__);
+  CHECK_EQ(damagedTiles(list.damage()), ((W + 31) / 32) * ((H + 31) / 32));
+
+  // Random scenes, each frame changes, adds or removes a few calls, with and without swapped image bytes
+  for (int i = 0; i < 30; i++) items.push_back(randomItem());
+  for (int f = 0; f < 120; f++) {
+    if (f == 60) tft.setSwapBytes(true);
+    for (int c = rnd(4) + 1; c; c--) {
+      uint32_t i = rnd(items.size());
+      switch (rnd(6)) {
+        case 0:  items.insert(items.begin() + i, randomItem()); break;
+        case 1:  if (items.size() > 4) items.erase(items.begin() + i); break;
+        case 2:  items[i].color = rnd(0x10000); break;
+        default: items[i].x += rnd(21) - 10; items[i].y += rnd(21) - 10; break;
+      }
+    }
+    if (items.size() > 48) items.resize(48);
+    frame(tft, list, items, __LINE__);
+  }
+
+  // Tiles never reach the panel RAM beyond the screen
+  uint32_t beyond = 0;
+  for (int32_t y = 0; y < STUB_RAM_HEIGHT; y++)
+    for (int32_t x = 0; x < STUB_RAM_WIDTH; x++)
+      if ((x >= W) || (y >= H)) beyond += (stub_pixel(x, y) != 0);
+  CHECK_EQ(beyond, 0);
+
+  return testResult();
+}
@@ -0,0 +1,129 @@
+// drawWedgeLine() and drawWideLine() in fixed point against coverage worked out in floating point from the
+// distance to the wedge: each pixel must be the blend of the foreground over what was under it at a coverage
+// within a tolerance of the reference, for random lines, wedges and spots on and over the screen edges
+// The background of the edge pixels must be read with one RAMRD per run of them, not one per pixel
+
+#include "test.h"
+#include <math.h>
+
+// Coverage tolerance in 1/256ths of a pixel: the ends and radii are rounded to 1/256 pixel, and the direction
+// of the axis is a unit vector with 12 fractional bits, good to about 1/16 of a 256th per pixel from a
+static float tolerance(float ax, float ay, int32_t x, int32_t y) {
+  return 2.0f + 0.0625f * sqrtf((x - ax) * (x - ax) + (y - ay) * (y - ay));
+}
+
+static uint32_t seed = 11;
+static float rnd(float lo, float hi) {
+  seed = seed * 1103515245u + 12345u;
+  return lo + (hi - lo) * ((seed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+// Radius at the nearest point of the axis less the distance to it, plus 0.5, in pixels
+static float coverage(float ax, float ay, float bx, float by, float ar, float br, int32_t x, int32_t y) {
+  float dx = bx - ax, dy = by - ay, len = sqrtf(dx * dx + dy * dy);
+  float px = x - ax, py = y - ay;
+  float s = (len > 0.0f) ? (px * dx + py * dy) / len : 0.0f;
+
+  if (s <= 0.0f) return ar + 0.5f - sqrtf(px * px + py * py);
+  if (s >= len)  return br + 0.5f - sqrtf((x - bx) * (x - bx) + (y - by) * (y - by));
+  return ar + (br - ar) * s / len + 0.5f - fabsf(py * dx - px * dy) / len;
+}
+
+// Alpha for a coverage in 1/256ths, as drawWedgeLine() limits it
+static int32_t alphaOf(int32_t c) {
+  return (c <= TFT_AA_LOW) ? 0 : (c >= TFT_AA_HIGH) ? 255 : c;
+}
+
+static uint16_t background(int32_t x, int32_t y) {
+  return (x * 0x0841 + y * 0x1003) & 0xFFFF;
+}
+
+struct Stats {
+  uint32_t bad = 0, blended = 0, rows = 0;
+};
+
+// Draw a wedge over the background pattern and check every pixel of the screen
+static Stats check(TFT_eSPI &tft, float ax, float ay, float bx, float by, float ar, float br, uint16_t fg, bool ownBg) {
+  const int32_t w = STUB_RAM_WIDTH, h = STUB_RAM_HEIGHT;
+  for (int32_t y = 0; y < h; y++)
+    for (int32_t x = 0; x < w; x++) stub.ram[y * w + x] = background(x, y);
+
+  const uint16_t bgColor = 0x000F;  // Navy
+  stub_reset_counters();
+  if (ownBg) tft.drawWedgeLine(ax, ay, bx, by, ar, br, fg, bgColor);
+  else       tft.drawWedgeLine(ax, ay, bx, by, ar, br, fg);
+
+  Stats st;
+  for (int32_t y = 0; y < h; y++) {
+    bool touched = false;
+    for (int32_t x = 0; x < w; x++) {
+      float c = coverage(ax, ay, bx, by, ar, br, x, y) * 256.0f, tol = tolerance(ax, ay, x, y);
+      int32_t lo = alphaOf((int32_t)floorf(c - tol)), hi = alphaOf((int32_t)ceilf(c + tol));
+      uint16_t under = background(x, y), got = stub.ram[y * w + x];
+
+      // Full coverage is drawn as the foreground itself
+      bool ok = ((lo == 0) && (got == under)) || ((hi == 255) && (got == fg));
+      for (int32_t a = std::max<int32_t>(lo, 1); !ok && (a <= std::min<int32_t>(hi, 254)); a++) ok = (got == tft.alphaBlend(a, fg, ownBg ? bgColor : under));
+      if (!ok && (st.bad < 5)) printf("wedge (%.2f, %.2f)-(%.2f, %.2f) r %.2f, %.2f: pixel %d, %d coverage %.1f got %04x under %04x\n",
+                                      ax, ay, bx, by, ar, br, x, y, c, got, under);
+      st.bad += !ok;
+
+      if (got != under) touched = true;
+      if ((lo > 0) && (hi < 255) && (got != fg)) st.blended++;
+    }
+    st.rows += touched;
+  }
+  return st;
+}
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  const uint16_t fg = TFT_YELLOW;
+  uint32_t bad = 0;
+
+  // Random lines, wedges and spots, some over the screen edges, with the background read and given
+  for (uint32_t t = 0; t < 300; t++) {
+    float ax = rnd(-20, 260), ay = rnd(-20, 340), ar = rnd(0, 12), br = ar;
+    float bx = ax + rnd(-120, 120), by = ay + rnd(-120, 120);
+    switch (t % 3) {
+      case 1: br = rnd(0, 12); break;  // Wedge
+      case 2: bx = ax; by = ay; break; // Spot
+    }
+    bool ownBg = (t % 5 == 4);
+    Stats st = check(tft, ax, ay, bx, by, ar, br, fg, ownBg);
+    bad += st.bad;
+
+    // Every run of edge pixels reads its background at once, at most a run either side of each of the three
+    // parts of a row, and none when the background color is given
+    if (ownBg) CHECK_EQ(stub.ramReads, 0);
+    else CHECK(stub.ramReads <= 4 * st.rows);
+  }
+  CHECK_EQ(bad, 0);
+
+  // drawWideLine() is a wedge with both radii half the width
+  {
+    Stats st = check(tft, 30.3f, 40.6f, 200.1f, 290.9f, 3.5f, 3.5f, fg, false);
+    static uint16_t wedge[STUB_RAM_WIDTH * STUB_RAM_HEIGHT];
+    memcpy(wedge, stub.ram, sizeof(wedge));
+    for (int32_t i = 0; i < STUB_RAM_WIDTH * STUB_RAM_HEIGHT; i++) stub.ram[i] = background(i % STUB_RAM_WIDTH, i / STUB_RAM_WIDTH);
+    tft.drawWideLine(30.3f, 40.6f, 200.1f, 290.9f, 7.0f, fg);
+    CHECK(memcmp(wedge, stub.ram, sizeof(wedge)) == 0);
+    CHECK_EQ(st.bad, 0);
+  }
+
+  // A thick, nearly horizontal line has long edge runs on each row, read once each rather than per pixel
+  {
+    Stats st = check(tft, 10.2f, 100.4f, 230.7f, 112.3f, 6.0f, 6.0f, fg, false);
+    CHECK_EQ(st.bad, 0);
+    CHECK(stub.ramReads <= 4 * st.rows);
+    CHECK(st.blended > 8 * stub.ramReads);
+    CHECK(stub.pixelsRead >= st.blended);
+    printf("nearly horizontal line: %u rows, %u blended pixels, %u background reads of %llu pixels\n",
+           st.rows, st.blended, stub.ramReads, (unsigned long long)stub.pixelsRead);
+  }
+
+  return testResult();
+}
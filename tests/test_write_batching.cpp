@@ -0,0 +1,54 @@
+// Write transactions keep CS low and send staged bytes in large spi_write_blocking() calls
+// Before them every byte was its own transaction, one call and one CS assertion per byte
+
+#include "test.h"
+
+int main() {
+  stub_reset();
+  TFT_eSPI tft;
+  tft.begin();
+
+  // A fill sends its window and pixels under one CS assertion
+  stub_reset_counters();
+  tft.fillRect(10, 20, 50, 40, TFT_RED);
+  CHECK_EQ(stub.csAsserts, 1);
+  CHECK_EQ(stub.pixelsWritten, 50 * 40);
+  CHECK_EQ(stub.bytes, 11 + 50 * 40 * 2);
+  CHECK(stub.sdkCalls <= 1);
+  CHECK_EQ(stub_pixel(10, 20), TFT_RED);
+  CHECK_EQ(stub_pixel(59, 59), TFT_RED);
+  CHECK_EQ(stub_pixel(60, 59), 0);
+
+  // Pixels along a row only resend the column window, 8 bytes each after the first instead of 13
+  stub_reset_counters();
+  for (int32_t x = 0; x < 100; x++) tft.drawPixel(x, 100, TFT_GREEN);
+  CHECK_EQ(stub.csAsserts, 100);
+  CHECK_EQ(stub.pixelsWritten, 100);
+  CHECK_EQ(stub.bytes, 13 + 99 * 8);
+  CHECK_EQ(stub.sdkCalls, 0);
+
+  // Inside startWrite() the whole sequence shares one CS assertion
+  stub_reset_counters();
+  tft.startWrite();
+  for (int32_t x = 0; x < 100; x++) tft.drawPixel(x, 101, TFT_BLUE);
+  for (int32_t i = 0; i < 50; i++) tft.fillRect(i * 4, 150, 3, 3, TFT_WHITE);
+  tft.drawFastHLine(0, 200, 200, TFT_YELLOW);
+  tft.endWrite();
+  CHECK_EQ(stub.csAsserts, 1);
+  CHECK_EQ(stub.pixelsWritten, 100 + 50 * 9 + 200);
+  CHECK_EQ(stub_pixel(99, 101), TFT_BLUE);
+  CHECK_EQ(stub_pixel(197, 152), TFT_WHITE);
+  CHECK_EQ(stub_pixel(199, 200), TFT_YELLOW);
+
+  // Staged bytes leave in one call per window at most, per byte writes would need stub.bytes calls
+  uint64_t perByte = 13 * 100 + 50 * (11 + 18) + 11 + 400;
+  printf("sequence: %llu bytes in %u calls and %llu FIFO writes, %llu bytes and calls per byte\n",
+         (unsigned long long)stub.bytes, stub.sdkCalls, (unsigned long long)stub.fifoWrites, (unsigned long long)perByte);
+  CHECK(stub.bytes < perByte);
+  CHECK(stub.sdkCalls <= 51);
+  CHECK(stub.sdkCalls * 10 < stub.bytes);
+  CHECK_EQ(stub.csConflicts, 0);
+  CHECK_EQ(stub.deselected, 0);
+
+  return testResult();
+}